@@ -1,10 +1,19 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <functional>
+#include <initializer_list>
+#include <limits>
 #include <map>
+#include <memory>
 #include <optional>
+#include <span>
+#include <stdexcept>
+#include <stop_token>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <variant>
 #include <vector>
 
@@ -51,6 +60,18 @@ namespace HXL {
         HXL_REQUIRED_PROPERTY_NOT_FOUND = 900,
         HXL_UNKNOWN_PROPERTY = 910,
         HXL_CANNOT_DESERIALIZE_NODE = 1000,
+        HXL_UNDECLARED_BOUND_PROPERTY = 1001,
+        HXL_AMBIGUOUS_HANDLE = 1002,
+        HXL_CANCELLED = 1100,
+        HXL_CANNOT_READ_FILE = 1200,
+        HXL_CANNOT_WATCH_FILE = 1201,
+        HXL_CANNOT_WRITE_FILE = 1202,
+        HXL_TOO_MANY_TOKENS = 1300,
+        HXL_TOO_MANY_NODES = 1301,
+        HXL_ARRAY_TOO_LONG = 1302,
+        HXL_STRING_TOO_LONG = 1303,
+        HXL_INHERITANCE_TOO_DEEP = 1304,
+        HXL_INVALID_PERFORMANCE_RESULTS = 1400,
     };
 
     /**
@@ -106,6 +127,12 @@ namespace HXL {
          * Boolean
          */
         T_BOOL,
+
+        /**
+         * The contents of a (large) array of numbers, between ``{`` and ``}``,
+         * which is tokenized as a whole, instead of a token per element.
+         */
+        T_NUMERIC_ARRAY,
     };
 
     /**
@@ -184,6 +211,8 @@ namespace HXL {
                     return "T_FLOAT";
                 case TokenType::T_BOOL:
                     return "T_BOOL";
+                case TokenType::T_NUMERIC_ARRAY:
+                    return "T_NUMERIC_ARRAY";
                 default:
                     return std::to_string(static_cast<int>(tokenType));
             }
@@ -256,6 +285,28 @@ namespace HXL {
         }
     };
 
+    /**
+     * Index of a node type in a ``CompiledSchema``.
+     */
+    typedef uint32_t TypeId;
+
+    /**
+     * Index of a property within its node type in a ``CompiledSchema``.
+     */
+    typedef uint32_t SlotId;
+
+    /**
+     * A property of a node type, resolved from a compiled schema.
+     *
+     * Keys are meant to be resolved once (with ``CompiledSchema::key``), after
+     * which properties can be looked up on ``DeserializedNodeView`` without
+     * comparing names.
+     */
+    struct PropertyKey {
+        TypeId typeId;
+        SlotId slot;
+    };
+
     /**
      * Value which contains information about inheritance (parent node)
      */
@@ -263,9 +314,224 @@ namespace HXL {
         std::string from;
     };
 
+    /**
+     * A (deserialized) reference to another node.
+     */
+    struct NodeRef {
+        /**
+         * Name of the referenced node.
+         */
+        std::string references;
+
+        /**
+         * Index of the referenced node in the document, once it has been
+         * resolved by the Transformer.
+         */
+        std::optional<size_t> index;
+
+        /**
+         * The object returned by the ``objectHandle`` of the referenced node,
+         * if it has been deserialized before the reference.
+         */
+        std::shared_ptr<void> object;
+
+        /**
+         * The bound object as ``T``, which must be the type the object
+         * was created as.
+         *
+         * @tparam T
+         * @return
+         */
+        template<typename T>
+        [[nodiscard]] std::shared_ptr<T> as() const {
+            return std::static_pointer_cast<T>(object);
+        }
+    };
+
+    /**
+     * List of values that can be deserialized to.
+     *
+     * String values are ``std::string_view`` (and ``std::vector<std::string_view>``)
+     * when deserialized with ``DeserializationOptions::stringViews``.
+     */
+    typedef std::variant<bool,
+                         int,
+                         float,
+                         std::string,
+                         NodeRef,
+                         std::vector<int>,
+                         std::vector<float>,
+                         std::vector<std::string>,
+                         std::string_view,
+                         std::vector<std::string_view>>
+            DeserializedValue;
+
+    /**
+     * Where a string value is kept, in the string storage of its document.
+     */
+    struct StringRef {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    /**
+     * A single value of a property. Which member is in use follows
+     * from the property's ``DataType``: ``string`` for both strings
+     * and references.
+     */
+    union PropertyScalar {
+        bool boolean;
+        int integer;
+        float real;
+        StringRef string;
+    };
+
+    /**
+     * The values of a property, stored by their data type.
+     *
+     * Up to ``inlineCapacity`` values are kept inline, so single values
+     * and short arrays don't allocate. Longer arrays are moved to the heap.
+     */
+    class PropertyValues {
+    public:
+        static constexpr uint32_t inlineCapacity = 2;
+
+        PropertyValues() = default;
+
+        PropertyValues(std::initializer_list<PropertyScalar> values) {
+            reserve(values.size());
+            for (const PropertyScalar &value: values) {
+                push_back(value);
+            }
+        }
+
+        PropertyValues(const PropertyValues &other) {
+            *this = other;
+        }
+
+        PropertyValues(PropertyValues &&other) noexcept {
+            *this = std::move(other);
+        }
+
+        ~PropertyValues() {
+            release();
+        }
+
+        PropertyValues &operator=(const PropertyValues &other) {
+            if (this != &other) {
+                count = 0;
+                reserve(other.count);
+                std::copy(other.begin(), other.end(), data());
+                count = other.count;
+            }
+            return *this;
+        }
+
+        PropertyValues &operator=(PropertyValues &&other) noexcept {
+            if (this != &other) {
+                release();
+                count = other.count;
+                capacity = other.capacity;
+                if (other.isInline()) {
+                    std::copy(other.local, other.local + other.count, local);
+                } else {
+                    heap = other.heap;
+                }
+                other.count = 0;
+                other.capacity = inlineCapacity;
+            }
+            return *this;
+        }
+
+        void push_back(PropertyScalar value) {
+            if (count == capacity) {
+                reserve(capacity * 2);
+            }
+            data()[count++] = value;
+        }
+
+        void reserve(size_t size) {
+            if (size <= capacity) {
+                return;
+            }
+
+            auto *grown = new PropertyScalar[size];
+            std::copy(begin(), end(), grown);
+            release();
+            heap = grown;
+            capacity = static_cast<uint32_t>(size);
+        }
+
+        [[nodiscard]] size_t size() const {
+            return count;
+        }
+
+        [[nodiscard]] bool empty() const {
+            return count == 0;
+        }
+
+        [[nodiscard]] const PropertyScalar &operator[](size_t index) const {
+            return data()[index];
+        }
+
+        PropertyScalar &operator[](size_t index) {
+            return data()[index];
+        }
+
+        [[nodiscard]] const PropertyScalar *begin() const {
+            return data();
+        }
+
+        [[nodiscard]] const PropertyScalar *end() const {
+            return data() + count;
+        }
+
+        PropertyScalar *begin() {
+            return data();
+        }
+
+        PropertyScalar *end() {
+            return data() + count;
+        }
+
+    private:
+        uint32_t count = 0;
+
+        uint32_t capacity = inlineCapacity;
+
+        union {
+            PropertyScalar local[inlineCapacity];
+            PropertyScalar *heap;
+        };
+
+        [[nodiscard]] bool isInline() const {
+            return capacity == inlineCapacity;
+        }
+
+        [[nodiscard]] const PropertyScalar *data() const {
+            return isInline() ? local : heap;
+        }
+
+        PropertyScalar *data() {
+            return isInline() ? local : heap;
+        }
+
+        void release() {
+            if (!isInline()) {
+                delete[] heap;
+                capacity = inlineCapacity;
+            }
+        }
+    };
+
     /**
      * Forward-declaration of ``NodeProperty``
      */
+    enum class ValueStructure {
+        Single,
+        Array,
+    };
+
     struct NodeProperty;
 
     /**
@@ -284,7 +550,7 @@ namespace HXL {
         std::string name;
 
         /**
-         * Node properties. As this stage still existing as strings.
+         * Node properties, with their values stored by data type.
          */
         std::vector<NodeProperty> properties;
 
@@ -292,6 +558,30 @@ namespace HXL {
          * Information about inheritance.
          */
         std::optional<Inheritance> inheritance;
+
+        /**
+         * Position of the node type in the source.
+         */
+        SourcePosition position{};
+
+        /**
+         * The node type's index in the compiled schema, once it has been
+         * resolved by schema-directed parsing or the Schema Validator.
+         */
+        std::optional<TypeId> typeId;
+
+        /**
+         * The number of nodes, which the node inherits through, once the
+         * inheritance has been resolved by the Transformer.
+         */
+        uint32_t inheritanceDepth = 0;
+
+        /**
+         * The number of properties the node declares itself, which come before
+         * the inherited ones in ``properties``. Set by the Transformer, as only
+         * these are passed on to the nodes inheriting from this one.
+         */
+        uint32_t declaredProperties = 0;
     };
 
     /**
@@ -304,22 +594,51 @@ namespace HXL {
         std::string name;
 
         /**
-         * The values (given as string).
-         * It is not validated in any shape or form, as this point.
-         * No matter the desired data type this is always a vector,
+         * The values, stored by their data type. Strings (and references)
+         * are kept in the document's ``strings``.
+         * No matter the desired data type this is always a list,
          * and in case of "single-value" types such as plain int,
          * bool and string, we simply read out the first value.
          */
-        std::vector<std::string> values;
+        PropertyValues values;
 
         /**
          * The interpreted data type (not validated). This is derived
-         * simply from analysis of the string pattern.
+         * simply from analysis of the token, and tells which member
+         * of the values is in use.
          *
-         * In case of arrays, the first value determines what the array
-         * will look like. Semantic validation will ensure matching values.
+         * Arrays mixing integers and floats are stored as floats.
          */
         DataType dataType;
+
+        /**
+         * Whether the value is an array. It's taken from the syntax (``[]``)
+         * when parsed, and from the schema once the property is validated,
+         * so an array of one value is still delivered as an array.
+         */
+        ValueStructure structure = ValueStructure::Single;
+
+        /**
+         * Position of the property key in the source.
+         */
+        SourcePosition position{};
+
+        /**
+         * The value converted to its final data type. It's populated by the
+         * Schema Validator, once the data type has been checked against
+         * the schema, which means the Deserializer doesn't have to
+         * interpret the values once more.
+         *
+         * Strings aren't converted, but stay in the document's ``strings``
+         * until the Deserializer copies them (or passes them on as views).
+         */
+        std::optional<DeserializedValue> value;
+
+        /**
+         * The property's slot in its node type of the compiled schema,
+         * once it has been resolved.
+         */
+        std::optional<SlotId> slot;
     };
 
     /**
@@ -333,6 +652,36 @@ namespace HXL {
          * List of nodes contained in the document.
          */
         std::vector<Node> nodes;
+
+        /**
+         * Storage of the string values (and references) of all properties,
+         * which are referred to by offset.
+         */
+        std::string strings;
+
+        /**
+         * Returns a string value of the document.
+         *
+         * Only the data of ``strings`` is read, not its size, so values can be
+         * read while further values are appended on another thread (as long as
+         * the storage has the capacity for them).
+         *
+         * @param ref
+         * @return
+         */
+        [[nodiscard]] std::string_view text(StringRef ref) const {
+            return {strings.data() + ref.offset, ref.length};
+        }
+    };
+
+    /**
+     * How much of the nodes and the string storage of a document is in use,
+     * when they're sized in advance, so parts can be parsed into them in place
+     * (see ``Parser::parsePart``).
+     */
+    struct DocumentExtent {
+        size_t nodes = 0;
+        size_t strings = 0;
     };
 
     /**
@@ -368,11 +717,6 @@ namespace HXL {
         std::vector<SchemaNodeProperty> properties;
     };
 
-    enum class ValueStructure {
-        Single,
-        Array,
-    };
-
     /**
      * Definition of a specific property of a specific node.
      */
@@ -399,6 +743,89 @@ namespace HXL {
         bool required = false;
     };
 
+    /**
+     * A schema prepared for fast lookups, where node types and their
+     * properties are resolved to numeric IDs (``TypeId`` and ``SlotId``)
+     * which later stages can index by, instead of comparing names.
+     *
+     * The IDs are the positions in the schema it was compiled from.
+     * Compiling is handled by ``HXL::SchemaCompiler``.
+     */
+    struct CompiledSchema {
+        /**
+         * The schema, as it was compiled.
+         */
+        Schema schema;
+
+        /**
+         * Node type name to type ID.
+         */
+        std::unordered_map<std::string, TypeId> typeIds;
+
+        /**
+         * For each type ID, property name to slot.
+         */
+        std::vector<std::unordered_map<std::string, SlotId>> slots;
+
+        /**
+         * Look up the type ID of a node type.
+         *
+         * @param name
+         * @return
+         */
+        [[nodiscard]] std::optional<TypeId> findType(const std::string &name) const {
+            auto it = typeIds.find(name);
+            if (it == typeIds.end()) {
+                return std::nullopt;
+            }
+            return it->second;
+        }
+
+        /**
+         * Look up the slot of a property on a node type.
+         *
+         * @param typeId
+         * @param name
+         * @return
+         */
+        [[nodiscard]] std::optional<SlotId> findSlot(TypeId typeId, const std::string &name) const {
+            auto it = slots[typeId].find(name);
+            if (it == slots[typeId].end()) {
+                return std::nullopt;
+            }
+            return it->second;
+        }
+
+        /**
+         * The schema declaration of a node type.
+         *
+         * @param typeId
+         * @return
+         */
+        [[nodiscard]] const SchemaNodeType &type(TypeId typeId) const {
+            return schema.types[typeId];
+        }
+
+        /**
+         * Resolve the key of a property on a node type.
+         *
+         * @param type
+         * @param property
+         * @return
+         */
+        [[nodiscard]] std::optional<PropertyKey> key(const std::string &type, const std::string &property) const {
+            std::optional<TypeId> typeId = findType(type);
+            if (!typeId.has_value()) {
+                return std::nullopt;
+            }
+            std::optional<SlotId> slot = findSlot(typeId.value(), property);
+            if (!slot.has_value()) {
+                return std::nullopt;
+            }
+            return PropertyKey{typeId.value(), slot.value()};
+        }
+    };
+
     /**
      * Forward-declaration
      */
@@ -413,66 +840,750 @@ namespace HXL {
     };
 
     /**
-     * A (deserialized) reference to another node.
+     * Lightweight alternative to ``DeserializedNode``, which refers to the
+     * values in the document instead of copying them. Values are indexed
+     * by slot, and looked up with keys resolved from the compiled schema.
+     *
+     * The view is only valid for the duration of the handle call.
      */
-    struct NodeRef {
-        std::string references;
-    };
+    struct DeserializedNodeView {
+        /**
+         * The node type's ID.
+         */
+        TypeId typeId;
 
-    /**
-     * List of values that can be deserialized to.
-     */
-    typedef std::variant<bool,
-                         int,
-                         float,
-                         std::string,
-                         NodeRef,
-                         std::vector<int>,
-                         std::vector<float>,
-                         std::vector<std::string>>
-            DeserializedValue;
+        /**
+         * The node name.
+         */
+        std::string_view name;
 
-    /**
-     * What a single deserialized node property looks like.
-     */
-    struct DeserializedNodeProperty {
-        DeserializedValue value;
-    };
+        /**
+         * The values of the node, indexed by slot.
+         * Properties that aren't present on the node are null pointers.
+         */
+        std::span<const DeserializedValue *const> values;
 
-    /**
-     * A handler for a specific node type.
-     */
-    struct DeserializationHandle {
         /**
-         * The node type, the handle targets
+         * The properties of the node as they're stored in the document, indexed
+         * by slot. Properties that aren't present on the node are null pointers.
+         *
+         * Views passed to bound handles (see ``DeserializationHandle::bindViewHandle``)
+         * only have the ``values`` which didn't need converting, the rest is read
+         * from here.
          */
-        std::string nodeType;
+        std::span<const NodeProperty *const> properties;
 
         /**
-         * The handle.
+         * The document of the node, which keeps the strings of ``properties``.
          */
-        std::function<void(const DeserializedNode &)> handle;
-    };
+        const Document *document = nullptr;
 
-    /**
-     * Definitions on how the Deserializer must handle each property.
-     */
-    struct DeserializationProtocol {
         /**
-         * List of handles.
+         * Returns true, if the property is present on the node.
+         *
+         * @param key
+         * @return
          */
-        std::vector<DeserializationHandle> handles;
-    };
+        [[nodiscard]] bool has(PropertyKey key) const {
+            return key.typeId == typeId && properties[key.slot] != nullptr;
+        }
 
-    /**
-     * Execution time reported by performance measurer
-     */
-    struct ExecutionTime {
-        PerformanceTime ms;
+        /**
+         * Returns the value of a property.
+         *
+         * @throws std::out_of_range When the property isn't present on the node,
+         * or its value hasn't been converted for the view.
+         *
+         * @param key
+         * @return
+         */
+        [[nodiscard]] const DeserializedValue &at(PropertyKey key) const {
+            if (!has(key) || values[key.slot] == nullptr) {
+                throw std::out_of_range("Property is not present on the node.");
+            }
+            return *values[key.slot];
+        }
+
+        /**
+         * Returns the value of a property as ``T``.
+         *
+         * @tparam T
+         * @param key
+         * @return
+         */
+        template<typename T>
+        [[nodiscard]] const T &get(PropertyKey key) const {
+            return std::get<T>(at(key));
+        }
+
+        /**
+         * Returns a string value, whether it's deserialized as a copy
+         * or as a view.
+         *
+         * @throws std::bad_variant_access When the value isn't a string.
+         *
+         * @param key
+         * @return
+         */
+        [[nodiscard]] std::string_view text(PropertyKey key) const {
+            const DeserializedValue &value = at(key);
+            if (const auto *view = std::get_if<std::string_view>(&value)) {
+                return *view;
+            }
+            return std::get<std::string>(value);
+        }
+    };
+
+    /**
+     * What a single deserialized node property looks like.
+     */
+    struct DeserializedNodeProperty {
+        DeserializedValue value;
     };
 
     /**
-     * Summary of performance on a per-stage basis
+     * Handle which receives a ``DeserializedNodeView``.
+     */
+    typedef std::function<void(const DeserializedNodeView &)> ViewHandle;
+
+    /**
+     * Handle which receives a ``DeserializedNodeView``, and returns the
+     * object it has created for the node.
+     */
+    typedef std::function<std::shared_ptr<void>(const DeserializedNodeView &)> ObjectHandle;
+
+    /**
+     * Handle which receives a batch of nodes (of the same type).
+     */
+    typedef std::function<void(std::span<const DeserializedNodeView>)> BatchHandle;
+
+    /**
+     * How a handle may be executed, when the Deserializer runs on a thread pool.
+     */
+    enum class HandleConcurrency {
+        /**
+         * Called on the calling thread, for one node at a time, in document order.
+         *
+         * Except for nodes which reference an object that's only created by a
+         * batch handle or a handle on the pool: Their handles are deferred until
+         * the sequential handles of all other nodes have run, and the objects
+         * exist. The deferred nodes are then handled type by type, in the order
+         * of the type dependencies, and in document order within a type.
+         */
+        Sequential,
+
+        /**
+         * Called from a single task for all nodes of the type, in document
+         * order, but concurrently with handles of other types.
+         */
+        PerType,
+
+        /**
+         * May be called concurrently for different nodes of the type.
+         */
+        ThreadSafe,
+    };
+
+    /**
+     * A handler for a specific node type.
+     *
+     * Exactly one of ``handle``, ``viewHandle``, ``bindViewHandle``, ``objectHandle``,
+     * ``bindObjectHandle`` and ``batchHandle`` must be set. Deserializing a node
+     * of a type with a handle that sets none or several of them fails with
+     * ``HXL_AMBIGUOUS_HANDLE``. Add a handle per callback instead.
+     */
+    struct DeserializationHandle {
+        /**
+         * The node type, the handle targets
+         */
+        std::string nodeType;
+
+        /**
+         * The handle.
+         */
+        std::function<void(const DeserializedNode &)> handle;
+
+        /**
+         * Alternative handle, which receives a ``DeserializedNodeView``
+         * instead of a ``DeserializedNode``, and thereby avoids allocating
+         * a map of copied values for every node.
+         *
+         * Requires a protocol compiled with a schema.
+         */
+        ViewHandle viewHandle;
+
+        /**
+         * Creates the ``viewHandle``, when the protocol is compiled with a
+         * schema. It receives the slots of the node type, so properties can
+         * be resolved by name only once. This is how ``HXL::bind`` works.
+         *
+         * The views it receives leave out the values which would need converting
+         * (like strings), which are read from ``DeserializedNodeView::properties``.
+         */
+        std::function<ViewHandle(const std::unordered_map<std::string, SlotId> &)> bindViewHandle;
+
+        /**
+         * Alternative handle, which returns the object created for the node.
+         * References to the node then arrive with ``NodeRef::object`` bound to
+         * it, so there's no need to look the object up by name.
+         *
+         * Nodes can only reference nodes declared before them, and the Deserializer
+         * handles the node types in order of their dependencies, so the referenced
+         * objects are created first. Only one handle per type should return objects.
+         *
+         * Requires a protocol compiled with a schema.
+         */
+        ObjectHandle objectHandle;
+
+        /**
+         * Creates the ``objectHandle``, when the protocol is compiled with a
+         * schema. See ``bindViewHandle``.
+         */
+        std::function<ObjectHandle(const std::unordered_map<std::string, SlotId> &)> bindObjectHandle;
+
+        /**
+         * The properties ``bindViewHandle`` and ``bindObjectHandle`` resolve.
+         * If one of them isn't declared on the type, the handle isn't bound,
+         * and deserializing a node of the type fails with
+         * ``HXL_UNDECLARED_BOUND_PROPERTY``.
+         */
+        std::vector<std::string> boundProperties;
+
+        /**
+         * Alternative handle, which receives all nodes of the type at once,
+         * as a contiguous span of views. This allows for bulk work, like
+         * reserving a container once, and costs one call per batch rather
+         * than one per node.
+         *
+         * Batch handles are called after the sequential per-node handles (except
+         * for those which are deferred, see ``HandleConcurrency::Sequential``),
+         * once the nodes have been grouped by type. Types which are referenced are
+         * handled first. Within a type, nodes are in document order.
+         *
+         * Requires a protocol compiled with a schema.
+         */
+        BatchHandle batchHandle;
+
+        /**
+         * The maximum number of nodes passed to ``batchHandle`` per call.
+         * With ``0`` all nodes of the type are passed in a single call.
+         */
+        size_t batchSize = 0;
+
+        /**
+         * How the handle may be executed, when deserializing on a thread pool.
+         */
+        HandleConcurrency concurrency = HandleConcurrency::Sequential;
+    };
+
+    /**
+     * Definitions on how the Deserializer must handle each property.
+     */
+    struct DeserializationProtocol {
+        /**
+         * List of handles.
+         */
+        std::vector<DeserializationHandle> handles;
+    };
+
+    /**
+     * A deserialization protocol prepared for dispatching nodes by their
+     * type ID, as compiled by ``HXL::Deserializer::compile``.
+     */
+    struct CompiledProtocol {
+        /**
+         * Handles per type ID. Types without any handles have an empty list.
+         */
+        std::vector<std::vector<DeserializationHandle>> handles;
+
+        /**
+         * Node type name to type ID.
+         */
+        std::unordered_map<std::string, TypeId> typeIds;
+
+        /**
+         * For each type ID, property name to slot. Only available when
+         * compiled with a schema.
+         */
+        std::vector<std::unordered_map<std::string, SlotId>> slots;
+
+        /**
+         * True, when the type IDs are shared with a compiled schema. The
+         * ``typeId`` already resolved on nodes is then used directly.
+         */
+        bool sharesSchemaIds = false;
+    };
+
+    class ThreadPool;
+
+    /**
+     * Options for the Deserializer.
+     */
+    struct DeserializationOptions {
+        /**
+         * When set, handles which aren't ``HandleConcurrency::Sequential``
+         * are executed on the pool.
+         */
+        ThreadPool *pool = nullptr;
+
+        /**
+         * The number of nodes per task for thread-safe handles.
+         */
+        size_t chunkSize = 256;
+
+        /**
+         * When true, the nodes for thread-safe handles are still prepared in
+         * parallel, but the handle calls of each type are committed one at a
+         * time, in document order. This keeps the insertion order deterministic.
+         */
+        bool orderedCommit = false;
+
+        /**
+         * When true, string values are passed to the handles as views into the
+         * document's ``strings``, rather than copies. The views are valid as long
+         * as the document is kept alive (see ``ProcessResult::document``), so
+         * handles must copy the strings they keep.
+         */
+        bool stringViews = false;
+
+        /**
+         * When a stop is requested, no further handles are called, and the
+         * deserialization ends with ``HXL_CANCELLED``. It's checked before
+         * each node, so a batch handle completes the batch it has received.
+         */
+        std::stop_token stopToken;
+    };
+
+    /**
+     * Options for the Tokenizer.
+     */
+    struct TokenizerOptions {
+        /**
+         * The (exact) number of spaces at the beginning of a line, which
+         * is read as a tab.
+         */
+        uint8_t indentSize = 4;
+
+        /**
+         * When a stop is requested, tokenizing ends with ``HXL_CANCELLED``
+         * at the end of the current line.
+         */
+        std::stop_token stopToken;
+    };
+
+    /**
+     * Limits on the size of a source, for sources which can't be trusted.
+     * Processing stops with an error, as soon as a limit is exceeded.
+     *
+     * There are no limits by default.
+     */
+    struct ResourceLimits {
+        /**
+         * The number of tokens, checked by the Tokenizer.
+         */
+        size_t maxTokens = std::numeric_limits<size_t>::max();
+
+        /**
+         * The length of a string literal (or any other value or name),
+         * checked by the Tokenizer.
+         */
+        size_t maxStringLength = std::numeric_limits<size_t>::max();
+
+        /**
+         * The number of nodes, checked by the Parser.
+         */
+        size_t maxNodes = std::numeric_limits<size_t>::max();
+
+        /**
+         * The number of values of a property, checked by the Parser.
+         */
+        size_t maxArrayLength = std::numeric_limits<size_t>::max();
+
+        /**
+         * The number of nodes a node inherits through, checked by the Transformer.
+         */
+        size_t maxInheritanceDepth = std::numeric_limits<size_t>::max();
+    };
+
+    /**
+     * How thoroughly the ``Processor`` validates sources.
+     *
+     * The checks which the deserialization relies on are made at every
+     * level: The syntax, node types and property keys (by which values are
+     * dispatched and stored), the data types of the values, and that nodes
+     * only inherit nodes of the same type.
+     */
+    enum class ValidationLevel {
+        /**
+         * All rules of the language and the schema.
+         */
+        Full,
+
+        /**
+         * The syntax and the schema, including required properties, but not
+         * the semantic analysis: Node names and property keys aren't checked
+         * for uniqueness, and inherited or referenced nodes, which don't exist
+         * (or are declared later on), are left unresolved.
+         */
+        Structural,
+
+        /**
+         * For sources, which have already been validated (for instance, at
+         * build time). Like ``Structural``, but required properties aren't
+         * checked either.
+         */
+        Trusted,
+    };
+
+    /**
+     * Options for a ``Processor``.
+     */
+    struct ProcessorOptions {
+        ValidationLevel validation = ValidationLevel::Full;
+
+        TokenizerOptions tokenizer;
+
+        ResourceLimits limits;
+
+        /**
+         * Count the allocations of each stage, which requires the allocation
+         * hooks (``hxl-lang/utilities/allocation-hooks.h``) to be included in
+         * the program. Only the thread running a stage is counted, so work
+         * handed to a ``ThreadPool`` isn't.
+         */
+        bool trackAllocations = false;
+
+        /**
+         * Count the cycles, instructions, cache misses and branch misses of
+         * each stage with the performance counters of the CPU. They're only
+         * available on Linux, where the kernel allows it (see
+         * ``perf_event_paranoid``), and are left out silently otherwise.
+         */
+        bool countHardwareEvents = false;
+    };
+
+    /**
+     * Options for processing a source in a pipeline (``Processor::processPipelined``).
+     */
+    struct PipelineOptions {
+        /**
+         * The number of nodes per batch, which is passed between the stages.
+         */
+        size_t batchSize = 64;
+
+        /**
+         * The number of batches, which can wait between two stages.
+         */
+        size_t queueDepth = 4;
+    };
+
+    /**
+     * Progress of processing a source, see ``AsyncOptions::progress``.
+     */
+    struct ProcessProgress {
+        size_t totalBytes = 0;
+
+        size_t bytesTokenized = 0;
+
+        size_t nodesParsed = 0;
+
+        size_t nodesDeserialized = 0;
+    };
+
+    /**
+     * Options for processing a source asynchronously (``Processor::processAsync``).
+     */
+    struct AsyncOptions {
+        /**
+         * Runs the processing, for instance by submitting it to a thread pool.
+         * When not set, the processing runs on a thread of its own.
+         */
+        std::function<void(std::function<void()>)> executor;
+
+        /**
+         * Called with the progress, after each batch of nodes, on the thread
+         * which runs the processing.
+         */
+        std::function<void(const ProcessProgress &)> progress;
+
+        /**
+         * When a stop is requested, the processing ends with ``HXL_CANCELLED``,
+         * and no further handles are called. It's checked at each line while
+         * tokenizing, and at each node while parsing and deserializing, so a
+         * large source is cancelled partway through a stage.
+         */
+        std::stop_token stopToken;
+
+        /**
+         * The number of nodes per batch, after which the progress is reported.
+         */
+        size_t batchSize = 64;
+
+        DeserializationOptions deserialization;
+    };
+
+    /**
+     * The amount of work a stage has handled, so its time can be told apart
+     * from the shape of the input: A slow stage on a source with twice the
+     * references is a different finding than a slow stage on the same source.
+     */
+    struct StageCounters {
+        /**
+         * The size of the source, which the stage has handled.
+         */
+        size_t bytes = 0;
+
+        size_t tokens = 0;
+        size_t nodes = 0;
+        size_t properties = 0;
+
+        /**
+         * The number of values of the properties, which are arrays.
+         */
+        size_t arrayElements = 0;
+
+        size_t references = 0;
+
+        /**
+         * The number of nodes, which inherit another.
+         */
+        size_t inheritanceLinks = 0;
+
+        StageCounters &operator+=(const StageCounters &other) {
+            bytes += other.bytes;
+            tokens += other.tokens;
+            nodes += other.nodes;
+            properties += other.properties;
+            arrayElements += other.arrayElements;
+            references += other.references;
+            inheritanceLinks += other.inheritanceLinks;
+            return *this;
+        }
+    };
+
+    /**
+     * The memory allocated by a stage, as counted by the ``AllocationTracker``
+     * on the thread running the stage.
+     */
+    struct AllocationCounters {
+        size_t allocations = 0;
+
+        size_t bytesAllocated = 0;
+
+        /**
+         * The bytes allocated, less the bytes freed. It's negative, when the
+         * stage has freed more than it has allocated.
+         */
+        int64_t bytesRetained = 0;
+
+        /**
+         * The most bytes in use at any time during the stage, beyond those in
+         * use when it started.
+         */
+        size_t peakBytes = 0;
+
+        /**
+         * The growth of the peak resident set size of the process, where it's
+         * available. It's process-wide, so it includes other threads.
+         */
+        size_t peakRssDelta = 0;
+
+        /**
+         * Add the counters of another part of the same stage. The peak is
+         * the highest of either, as the parts ran one after another.
+         *
+         * @param other
+         * @return
+         */
+        AllocationCounters &operator+=(const AllocationCounters &other) {
+            allocations += other.allocations;
+            bytesAllocated += other.bytesAllocated;
+            bytesRetained += other.bytesRetained;
+            peakBytes = std::max(peakBytes, other.peakBytes);
+            peakRssDelta += other.peakRssDelta;
+            return *this;
+        }
+    };
+
+    /**
+     * The hardware events of a stage, as counted by the CPU for the thread
+     * running the stage (in user space only), see ``HardwareCounterReader``.
+     *
+     * Few instructions per cycle with many cache misses point to a stage,
+     * which waits for memory, while many branch misses point to one, which
+     * is bound by its branches.
+     */
+    struct HardwareCounters {
+        uint64_t cycles = 0;
+        uint64_t instructions = 0;
+
+        /**
+         * Misses of the last level cache.
+         */
+        uint64_t cacheMisses = 0;
+
+        uint64_t branchMisses = 0;
+
+        /**
+         * The instructions per cycle, or zero if no cycles were counted.
+         *
+         * @return
+         */
+        [[nodiscard]] double instructionsPerCycle() const {
+            return cycles > 0 ? static_cast<double>(instructions) / static_cast<double>(cycles) : 0.0;
+        }
+
+        HardwareCounters &operator+=(const HardwareCounters &other) {
+            cycles += other.cycles;
+            instructions += other.instructions;
+            cacheMisses += other.cacheMisses;
+            branchMisses += other.branchMisses;
+            return *this;
+        }
+    };
+
+    /**
+     * Counts taken inside the loops of the tokenizer and the parser, which
+     * show where their work goes. They're only taken by a processor with
+     * ``FullInstrumentation`` (see ``hxl-lang/utilities/instrumentation.h``).
+     *
+     * The tokenizer counts the bytes it takes in bulk. The rest of the
+     * source goes through its loop character by character.
+     */
+    struct StageProbes {
+        /**
+         * Bytes of string literals, which are taken straight from the source.
+         */
+        size_t literalBytes = 0;
+
+        /**
+         * Bytes of comments, which are skipped.
+         */
+        size_t commentBytes = 0;
+
+        /**
+         * Bytes of numeric arrays, which are scanned in blocks.
+         */
+        size_t numericArrayBytes = 0;
+
+        /**
+         * Node types the parser has looked up in the schema, by name.
+         */
+        size_t typeLookups = 0;
+
+        /**
+         * Properties the parser has looked up in the schema, by name.
+         */
+        size_t slotLookups = 0;
+
+        /**
+         * Nodes the parser has looked up by name, to inherit them.
+         */
+        size_t nodeLookups = 0;
+
+        /**
+         * Numbers the parser has converted from their text.
+         */
+        size_t numberConversions = 0;
+
+        /**
+         * Bytes of strings, which the parser has copied into the document.
+         */
+        size_t stringBytes = 0;
+
+        void record(size_t StageProbes::*probe, size_t amount = 1) {
+            this->*probe += amount;
+        }
+
+        StageProbes &operator+=(const StageProbes &other) {
+            literalBytes += other.literalBytes;
+            commentBytes += other.commentBytes;
+            numericArrayBytes += other.numericArrayBytes;
+            typeLookups += other.typeLookups;
+            slotLookups += other.slotLookups;
+            nodeLookups += other.nodeLookups;
+            numberConversions += other.numberConversions;
+            stringBytes += other.stringBytes;
+            return *this;
+        }
+    };
+
+    /**
+     * Execution time reported by performance measurer, measured with a
+     * steady clock, and the work done in that time.
+     */
+    struct ExecutionTime {
+        /**
+         * The time in microseconds.
+         */
+        PerformanceTime ms;
+
+        /**
+         * The time in nanoseconds.
+         */
+        PerformanceTime ns = 0;
+
+        StageCounters counters = {};
+
+        /**
+         * The memory allocated by the stage, when tracked
+         * (see ``ProcessorOptions::trackAllocations``).
+         */
+        std::optional<AllocationCounters> allocations;
+
+        /**
+         * The hardware events of the stage, when counted
+         * (see ``ProcessorOptions::countHardwareEvents``), and available.
+         */
+        std::optional<HardwareCounters> hardware;
+
+        /**
+         * The probes of the tokenizer or the parser, when taken.
+         */
+        std::optional<StageProbes> probes;
+
+        /**
+         * The throughput of the source (in megabytes of 10^6 bytes), or zero
+         * if no time was measured.
+         *
+         * @return
+         */
+        [[nodiscard]] double megabytesPerSecond() const {
+            return ns > 0 ? static_cast<double>(counters.bytes) * 1e3 / static_cast<double>(ns) : 0.0;
+        }
+
+        /**
+         * The throughput of nodes, or zero if no time was measured.
+         *
+         * @return
+         */
+        [[nodiscard]] double nodesPerSecond() const {
+            return ns > 0 ? static_cast<double>(counters.nodes) * 1e9 / static_cast<double>(ns) : 0.0;
+        }
+
+        ExecutionTime &operator+=(const ExecutionTime &other) {
+            ms += other.ms;
+            ns += other.ns;
+            counters += other.counters;
+            if (other.allocations.has_value()) {
+                allocations = allocations.value_or(AllocationCounters{});
+                allocations.value() += other.allocations.value();
+            }
+            if (other.hardware.has_value()) {
+                hardware = hardware.value_or(HardwareCounters{});
+                hardware.value() += other.hardware.value();
+            }
+            if (other.probes.has_value()) {
+                probes = probes.value_or(StageProbes{});
+                probes.value() += other.probes.value();
+            }
+            return *this;
+        }
+    };
+
+    /**
+     * Summary of performance on a per-stage basis. The schema is validated
+     * while parsing, so its time is part of ``parsing``.
      */
     struct PerformanceResults {
         typedef std::optional<ExecutionTime> StageResult;
@@ -480,25 +1591,101 @@ namespace HXL {
         StageResult tokenization,
                 parsing,
                 semanticAnalysis,
-                transformer,
-                schemaValidation,
-                deserialization;
+                transformer;
 
+        /**
+         * Deprecated, and always empty. The schema is validated while parsing,
+         * so its time is part of ``parsing``. The stage is kept, so code and
+         * exported results which refer to it still work.
+         */
+        StageResult schemaValidation;
+
+        StageResult deserialization;
+
+        /**
+         * A stage, by the name it's exported under.
+         */
+        struct Stage {
+            std::string_view name;
+            StageResult PerformanceResults::*result;
+        };
+
+        /**
+         * All stages, in the order they run.
+         *
+         * @return
+         */
+        static std::span<const Stage> stages() {
+            static const Stage list[] = {
+                    {"tokenization", &PerformanceResults::tokenization},
+                    {"parsing", &PerformanceResults::parsing},
+                    {"semanticAnalysis", &PerformanceResults::semanticAnalysis},
+                    {"transformer", &PerformanceResults::transformer},
+                    {"schemaValidation", &PerformanceResults::schemaValidation},
+                    {"deserialization", &PerformanceResults::deserialization},
+            };
+            return list;
+        }
+
+        /**
+         * The time of all stages. As every stage handles the same source,
+         * the counters are the largest of any stage (rather than the sum),
+         * so the throughput is that of the whole processing. Hardware events
+         * are summed up, like the time.
+         *
+         * @return
+         */
         [[nodiscard]] ExecutionTime getTotal() const {
-            PerformanceTime total = 0;
+            ExecutionTime total{};
+            for (const Stage &stage: stages()) {
+                const StageResult &result = this->*stage.result;
+                if (!result.has_value()) {
+                    continue;
+                }
 
-            std::function<PerformanceTime(StageResult)> extract = [](StageResult time) {
-                return time.has_value() ? time.value().ms : 0;
+                const ExecutionTime &time = result.value();
+                total.ms += time.ms;
+                total.ns += time.ns;
+
+                StageCounters &counters = total.counters;
+                counters.bytes = std::max(counters.bytes, time.counters.bytes);
+                counters.tokens = std::max(counters.tokens, time.counters.tokens);
+                counters.nodes = std::max(counters.nodes, time.counters.nodes);
+                counters.properties = std::max(counters.properties, time.counters.properties);
+                counters.arrayElements = std::max(counters.arrayElements, time.counters.arrayElements);
+                counters.references = std::max(counters.references, time.counters.references);
+                counters.inheritanceLinks = std::max(counters.inheritanceLinks, time.counters.inheritanceLinks);
+
+                // Unlike the work, the events of the stages add up
+                if (time.hardware.has_value()) {
+                    total.hardware = total.hardware.value_or(HardwareCounters{});
+                    total.hardware.value() += time.hardware.value();
+                }
+            }
+
+            return total;
+        }
+
+        /**
+         * Add the times and counters of ``other`` to these, stage by stage.
+         * Stages which weren't measured in either are left unmeasured.
+         *
+         * @param other
+         * @return
+         */
+        PerformanceResults &operator+=(const PerformanceResults &other) {
+            auto add = [](StageResult &time, const StageResult &addition) {
+                if (addition.has_value()) {
+                    time = time.value_or(ExecutionTime{});
+                    time.value() += addition.value();
+                }
             };
 
-            total += extract(tokenization);
-            total += extract(parsing);
-            total += extract(semanticAnalysis);
-            total += extract(transformer);
-            total += extract(schemaValidation);
-            total += extract(deserialization);
+            for (const Stage &stage: stages()) {
+                add(this->*stage.result, other.*stage.result);
+            }
 
-            return {total};
+            return *this;
         }
     };
 }
@@ -14,7 +14,10 @@
 #include "services/deserializer.h"
 #include "services/parser.h"
 #include "services/processor.h"
+#include "services/project.h"
+#include "services/schema-compiler.h"
 #include "services/schema-validator.h"
 #include "services/semantic-analyzer.h"
 #include "services/tokenizer.h"
 #include "services/transformer.h"
+#include "services/watcher.h"
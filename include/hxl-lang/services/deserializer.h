@@ -3,8 +3,38 @@
 #include "hxl-lang/core.h"
 
 #include <memory>
+#include <span>
+#include <string_view>
 
 namespace HXL {
+    class TaskGroup;
+
+    /**
+     * Buffers used while deserializing a document. They can be kept
+     * between calls, so deserializing document after document doesn't
+     * allocate them again.
+     */
+    struct DeserializationBuffers {
+        std::vector<bool> checked;
+        std::vector<const DeserializedValue *> slotValues;
+        std::vector<const NodeProperty *> slotProperties;
+        std::vector<DeserializedValue> converted;
+        std::vector<std::shared_ptr<void>> objects;
+
+        /**
+         * Set when handles have been left for ``Deserializer::deserializeDeferred``.
+         */
+        bool deferred = false;
+
+        /**
+         * Indexed like the nodes. The nodes whose objects are only created by
+         * the deferred handles, and the nodes whose sequential handles were
+         * deferred, as they reference such objects.
+         */
+        std::vector<bool> pendingObjects;
+        std::vector<bool> deferredNodes;
+    };
+
     /**
      * The Deserializer is the last stage of translating a HXL source into
      * C++ structures. The deserializer will, based on a protocol that you
@@ -19,11 +49,318 @@ namespace HXL {
          * @param document
          */
         static ErrorList deserialize(const DeserializationProtocol &protocol,
-                                const std::shared_ptr<Document> &document);
+                                     const std::shared_ptr<Document> &document);
+
+        /**
+         * Perform deserialization on the document based on a compiled protocol.
+         *
+         * If the protocol is compiled with a schema, the document must be
+         * parsed or validated with the same compiled schema.
+         *
+         * @param protocol
+         * @param document
+         */
+        static ErrorList deserialize(const CompiledProtocol &protocol,
+                                     const std::shared_ptr<Document> &document);
+
+        /**
+         * Perform deserialization with options, for instance on a thread pool.
+         *
+         * With a pool, the handles which are ``HandleConcurrency::Sequential``
+         * still run on the calling thread, while the rest run on the pool.
+         * The function returns when all handles have completed. If a handle
+         * throws, the exception is re-thrown here.
+         *
+         * @param protocol
+         * @param document
+         * @param options
+         */
+        static ErrorList deserialize(const CompiledProtocol &protocol,
+                                     const std::shared_ptr<Document> &document,
+                                     const DeserializationOptions &options);
+
+        /**
+         * Perform deserialization with options, re-using ``buffers``.
+         *
+         * @param protocol
+         * @param document
+         * @param options
+         * @param buffers
+         */
+        static ErrorList deserialize(const CompiledProtocol &protocol,
+                                     const std::shared_ptr<Document> &document,
+                                     const DeserializationOptions &options,
+                                     DeserializationBuffers &buffers);
+
+        /**
+         * Deserialize the nodes from ``begin`` to ``end``, which can be done as
+         * soon as they're transformed, while the rest of the document is still
+         * being processed. Starting from the first node starts a new document.
+         *
+         * The handles which are called in document order, one node at a time,
+         * are called right away. The batch handles and handles which run on the
+         * pool need all nodes of their type, so they're left for the deferred
+         * phase, ``deserializeDeferred``, which runs once all nodes are through.
+         * So are the sequential handles of nodes which reference objects only
+         * created by the deferred handles.
+         *
+         * The nodes are checked for handles part by part, so when an error is
+         * returned, the handles of the nodes before ``begin`` have already run.
+         *
+         * @param protocol
+         * @param document
+         * @param strings The string storage of the document
+         * @param begin
+         * @param end
+         * @param options
+         * @param buffers
+         * @return
+         */
+        static ErrorList deserializeNodes(const CompiledProtocol &protocol,
+                                          const Document &document,
+                                          std::string_view strings,
+                                          size_t begin,
+                                          size_t end,
+                                          const DeserializationOptions &options,
+                                          DeserializationBuffers &buffers);
+
+        /**
+         * Check that the nodes from ``begin`` to ``end`` have handles, without
+         * calling any. ``deserializeNodes`` does the same for its nodes, but
+         * this can check a whole document, before it's deserialized in parts.
+         *
+         * @param protocol
+         * @param document
+         * @param begin
+         * @param end
+         * @param buffers
+         * @return
+         */
+        static ErrorList checkHandles(const CompiledProtocol &protocol,
+                                      const Document &document,
+                                      size_t begin,
+                                      size_t end,
+                                      DeserializationBuffers &buffers);
+
+        /**
+         * Run the handles left by ``deserializeNodes``, when all nodes of the
+         * document have been passed to it, and complete the deserialization.
+         *
+         * @param protocol
+         * @param document
+         * @param options
+         * @param buffers
+         * @return ``HXL_CANCELLED``, when a stop has been requested
+         */
+        static ErrorList deserializeDeferred(const CompiledProtocol &protocol,
+                                             const std::shared_ptr<Document> &document,
+                                             const DeserializationOptions &options,
+                                             DeserializationBuffers &buffers);
+
+        /**
+         * Deserialize a single node of a validated document, without calling
+         * any handle. References aren't bound to objects.
+         *
+         * @param document
+         * @param index
+         * @return
+         */
+        static DeserializedNode deserializeNode(const Document &document, size_t index);
+
+        /**
+         * Compile the protocol, so nodes can be dispatched to their handles
+         * by type ID, rather than by comparing the type names.
+         *
+         * Type IDs are assigned in the order the node types first appear.
+         *
+         * @param protocol
+         * @return
+         */
+        static CompiledProtocol compile(const DeserializationProtocol &protocol);
+
+        /**
+         * Compile the protocol with the type IDs of a compiled schema.
+         *
+         * Handles for node types which aren't in the schema are left out,
+         * since such nodes can't pass the schema validation anyway.
+         *
+         * @param protocol
+         * @param schema
+         * @return
+         */
+        static CompiledProtocol compile(const DeserializationProtocol &protocol,
+                                        const CompiledSchema &schema);
 
     private:
-        static DeserializedNode generateNode(const Node &node);
+        static std::optional<TypeId> resolveType(const CompiledProtocol &protocol, const Node &node);
+
+        static DeserializedNode generateNode(const Node &node,
+                                             std::string_view strings,
+                                             bool stringViews,
+                                             const std::vector<std::shared_ptr<void>> &objects);
+
+        /**
+         * If the value is a resolved reference, and its node has an
+         * object, a copy of the reference bound to the object is returned.
+         *
+         * @param value
+         * @param objects
+         * @return
+         */
+        static std::optional<NodeRef> bindReference(const DeserializedValue &value,
+                                                    const std::vector<std::shared_ptr<void>> &objects);
+
+        /**
+         * Assemble a view of the node, where the values are referenced
+         * from the document (or the ``converted`` buffer) by slot.
+         *
+         * @param protocol
+         * @param typeId
+         * @param document
+         * @param node
+         * @param strings
+         * @param stringViews
+         * @param bound Leave out the values, which would need converting
+         * @param slotValues
+         * @param slotProperties
+         * @param converted
+         * @param objects
+         * @return
+         */
+        static DeserializedNodeView generateView(const CompiledProtocol &protocol,
+                                                 TypeId typeId,
+                                                 const Document &document,
+                                                 const Node &node,
+                                                 std::string_view strings,
+                                                 bool stringViews,
+                                                 bool bound,
+                                                 std::span<const DeserializedValue *> slotValues,
+                                                 std::span<const NodeProperty *> slotProperties,
+                                                 std::span<DeserializedValue> converted,
+                                                 const std::vector<std::shared_ptr<void>> &objects);
+
+        /**
+         * The nodes grouped by type, and the types grouped in levels by their
+         * dependencies: A type only references types of lower levels. Within a
+         * level, types are in the order they first appear.
+         */
+        struct TypeGroups {
+            std::vector<size_t> nodes;
+            std::vector<size_t> offsets;
+            std::vector<bool> referencesOwnType;
+            std::vector<std::vector<TypeId>> levels;
+
+            [[nodiscard]] std::span<const size_t> of(TypeId typeId) const {
+                return std::span<const size_t>(nodes).subspan(offsets[typeId], offsets[typeId + 1] - offsets[typeId]);
+            }
+        };
+
+        /**
+         * What a chunk of nodes is prepared into, before it's passed to a handle.
+         */
+        struct ChunkBuffers {
+            std::vector<DeserializedNodeView> views;
+            std::vector<const DeserializedValue *> slotValues;
+            std::vector<const NodeProperty *> slotProperties;
+            std::vector<DeserializedValue> converted;
+            std::vector<DeserializedNode> nodes;
+        };
+
+        static TypeGroups groupByType(const CompiledProtocol &protocol,
+                                      const std::shared_ptr<Document> &document);
+
+        /**
+         * Schedule the handles of a level, which aren't sequential, on the pool.
+         *
+         * @param protocol
+         * @param document
+         * @param groups
+         * @param level
+         * @param options
+         * @param objects
+         * @param tasks
+         */
+        static void schedule(const CompiledProtocol &protocol,
+                             const std::shared_ptr<Document> &document,
+                             const TypeGroups &groups,
+                             const std::vector<TypeId> &level,
+                             const DeserializationOptions &options,
+                             std::vector<std::shared_ptr<void>> &objects,
+                             TaskGroup &tasks);
+
+        /**
+         * Pass the nodes to the handle, chunk by chunk, in document order.
+         * Object handles of a type which references itself are passed the
+         * nodes one by one.
+         */
+        static void runInOrder(const CompiledProtocol &protocol,
+                               const DeserializationHandle &handle,
+                               TypeId typeId,
+                               const Document &document,
+                               std::span<const size_t> indices,
+                               const DeserializationOptions &options,
+                               std::vector<std::shared_ptr<void>> &objects,
+                               ChunkBuffers &buffers,
+                               bool referencesOwnType);
+
+        /**
+         * The number of callbacks the handle sets.
+         *
+         * @param handle
+         * @return
+         */
+        static size_t countCallbacks(const DeserializationHandle &handle);
+
+        /**
+         * Whether the handle was bound, when the protocol was compiled. Bound
+         * handles read their values from the properties of the view.
+         *
+         * @param handle
+         * @return
+         */
+        static bool isBound(const DeserializationHandle &handle);
+
+        static size_t chunkSizeOf(const DeserializationHandle &handle,
+                                  const DeserializationOptions &options,
+                                  size_t count);
+
+        static void prepareChunk(const CompiledProtocol &protocol,
+                                 const DeserializationHandle &handle,
+                                 TypeId typeId,
+                                 const Document &document,
+                                 std::span<const size_t> indices,
+                                 const DeserializationOptions &options,
+                                 const std::vector<std::shared_ptr<void>> &objects,
+                                 ChunkBuffers &buffers);
 
-        inline static DeserializedValue toValue(const NodeProperty &nodeProperty);
+        /**
+         * Call the handle with a prepared chunk. No further nodes are passed
+         * to it, once a stop is requested through ``stopToken``.
+         *
+         * @param handle
+         * @param buffers
+         * @param indices
+         * @param objects
+         * @param stopToken
+         */
+        static void commitChunk(const DeserializationHandle &handle,
+                                const ChunkBuffers &buffers,
+                                std::span<const size_t> indices,
+                                std::vector<std::shared_ptr<void>> &objects,
+                                const std::stop_token &stopToken);
+
+        /**
+         * Convert the values of a property, which haven't been converted
+         * by the schema validation. Strings are copied from ``strings``,
+         * or referenced as views into it, if ``stringViews`` is set.
+         *
+         * @param nodeProperty
+         * @param strings
+         * @param stringViews
+         * @return
+         */
+        inline static DeserializedValue toValue(const NodeProperty &nodeProperty,
+                                                std::string_view strings,
+                                                bool stringViews);
     };
 }
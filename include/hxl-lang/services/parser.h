@@ -1,9 +1,13 @@
 #pragma once
 
 #include "hxl-lang/traits/traits.h"
+#include "hxl-lang/utilities/instrumentation.h"
+#include "hxl-lang/utilities/node-index.h"
 
 #include <cassert>
 #include <memory>
+#include <optional>
+#include <stop_token>
 
 using T = HXL::TokenType;
 
@@ -23,7 +27,244 @@ namespace HXL {
          */
         static Result<Document> parse(const std::vector<Token> &tokens);
 
+        /**
+         * Parse the set of ordered tokens, directed by a compiled schema.
+         *
+         * Node types and property keys are resolved against the schema as
+         * soon as they're encountered, so unknown ones are rejected at the
+         * token where they appear. Property values are type-checked and
+         * converted right away, and every node and property is assigned
+         * its ``typeId`` and ``slot``.
+         *
+         * This covers all the checks of the Schema Validator, which
+         * therefore doesn't need to run on the resulting document.
+         *
+         * @param tokens
+         * @param schema
+         * @return
+         */
+        static Result<Document> parse(const std::vector<Token> &tokens,
+                                      const CompiledSchema &schema);
+
+        /**
+         * Parse directed by a compiled schema, into an existing document.
+         *
+         * The nodes already in the document are re-used, and so is the memory
+         * of ``nodeIndex``, so parsing source after source into the same
+         * document avoids most allocations. The document is only valid, if
+         * no error is returned.
+         *
+         * Required properties are skipped without ``requireProperties``, for
+         * sources which have already been validated.
+         *
+         * @param tokens
+         * @param schema
+         * @param document
+         * @param nodeIndex
+         * @param requireProperties
+         * @param limits
+         * @return
+         */
+        static std::optional<Error> parse(const std::vector<Token> &tokens,
+                                          const CompiledSchema &schema,
+                                          Document &document,
+                                          NodeIndex &nodeIndex,
+                                          bool requireProperties = true,
+                                          const ResourceLimits &limits = {});
+
+        /**
+         * Parse into an existing document, and record the lookups, conversions
+         * and copied strings in ``probes`` (see ``StageProbes``). It's available
+         * for ``NoProbes``, with which it's the same as the above, and ``StageProbes``.
+         *
+         * @param tokens
+         * @param schema
+         * @param document
+         * @param nodeIndex
+         * @param requireProperties
+         * @param limits
+         * @param probes
+         * @return
+         */
+        template<typename Probes>
+        static std::optional<Error> parse(const std::vector<Token> &tokens,
+                                          const CompiledSchema &schema,
+                                          Document &document,
+                                          NodeIndex &nodeIndex,
+                                          bool requireProperties,
+                                          const ResourceLimits &limits,
+                                          Probes &probes);
+
+        /**
+         * Parse a part of a source, directed by a compiled schema, and append
+         * its nodes to ``document``.
+         *
+         * A source can be tokenized and parsed part by part, when it's split
+         * at the start of a node (see ``Tokenizer::tokenize``). Before the
+         * first part, the document and ``nodeIndex`` must be empty, and the
+         * parts must be passed in order, with ``last`` set for the last one.
+         * The nodes parsed before a part are left untouched, but appending to
+         * the document modifies its vectors, so to let other threads use them
+         * in the meantime, parse into storage sized in advance with ``extent``.
+         *
+         * Required properties are only checked with ``requireProperties``,
+         * which reads the nodes a node inherits from. When other threads may
+         * be resolving the inheritance of those in the meantime, check them
+         * with ``checkRequired`` once the inheritance is resolved instead.
+         *
+         * @param tokens
+         * @param schema
+         * @param document
+         * @param nodeIndex
+         * @param last
+         * @param requireProperties
+         * @param limits
+         * @return
+         */
+        static std::optional<Error> parsePart(const std::vector<Token> &tokens,
+                                              const CompiledSchema &schema,
+                                              Document &document,
+                                              NodeIndex &nodeIndex,
+                                              bool last,
+                                              bool requireProperties,
+                                              const ResourceLimits &limits = {});
+
+        /**
+         * Parse a part of a source, and record the probes of the parser in
+         * ``probes``, see ``parse``. When a stop is requested through
+         * ``stopToken``, parsing ends with ``HXL_CANCELLED`` at the end of
+         * the current line.
+         *
+         * @param tokens
+         * @param schema
+         * @param document
+         * @param nodeIndex
+         * @param last
+         * @param requireProperties
+         * @param limits
+         * @param probes
+         * @param stopToken
+         * @return
+         */
+        template<typename Probes>
+        static std::optional<Error> parsePart(const std::vector<Token> &tokens,
+                                              const CompiledSchema &schema,
+                                              Document &document,
+                                              NodeIndex &nodeIndex,
+                                              bool last,
+                                              bool requireProperties,
+                                              const ResourceLimits &limits,
+                                              Probes &probes,
+                                              const std::stop_token &stopToken = {});
+
+        /**
+         * Parse a part of a source into the nodes and string storage of the
+         * document, which are sized in advance. The part is written in place
+         * from ``extent`` on, and ``extent`` is advanced past it. As long as
+         * the storage is large enough, neither vector is modified itself, only
+         * the elements after ``extent``, so other threads can read the ones
+         * before it in the meantime.
+         *
+         * If the storage is too small, the part is appended, see ``parsePart``.
+         *
+         * @param tokens
+         * @param schema
+         * @param document
+         * @param extent
+         * @param nodeIndex
+         * @param last
+         * @param requireProperties
+         * @param limits
+         * @param probes
+         * @param stopToken
+         * @return
+         */
+        template<typename Probes>
+        static std::optional<Error> parsePart(const std::vector<Token> &tokens,
+                                              const CompiledSchema &schema,
+                                              Document &document,
+                                              DocumentExtent &extent,
+                                              NodeIndex &nodeIndex,
+                                              bool last,
+                                              bool requireProperties,
+                                              const ResourceLimits &limits,
+                                              Probes &probes,
+                                              const std::stop_token &stopToken = {});
+
+        /**
+         * Check that a node (parsed with a schema) has all the required
+         * properties. Properties which aren't present on the node itself
+         * are looked up through its chain of inheritance.
+         *
+         * @param schema
+         * @param nodes
+         * @param nodeIndex
+         * @param node
+         * @return
+         */
+        static std::optional<Error> checkRequired(const CompiledSchema &schema,
+                                                  const std::vector<Node> &nodes,
+                                                  const NodeIndex &nodeIndex,
+                                                  const Node &node);
+
     private:
+        /**
+         * Shared implementation of the ``parse`` methods.
+         * ``schema`` is a null pointer, when parsing without schema.
+         *
+         * @param tokens
+         * @param schema
+         * @param document
+         * @param nodeIndex
+         * @param requireProperties
+         * @param limits
+         * @param probes
+         * @return
+         */
+        template<typename Probes>
+        static std::optional<Error> parseDocument(const std::vector<Token> &tokens,
+                                                  const CompiledSchema *schema,
+                                                  Document &document,
+                                                  NodeIndex &nodeIndex,
+                                                  bool requireProperties,
+                                                  const ResourceLimits &limits,
+                                                  Probes &probes);
+
+        /**
+         * Parse the tokens into nodes and strings, which are written from
+         * ``extent`` on. ``extent`` is advanced past them. The required
+         * properties of each node are checked, if ``requireProperties`` is set.
+         *
+         * @param tokens
+         * @param schema
+         * @param document
+         * @param nodeIndex
+         * @param extent
+         * @param requireProperties
+         * @param limits
+         * @param probes
+         * @param stopToken
+         * @return
+         */
+        template<typename Probes>
+        static std::optional<Error> parseNodes(const std::vector<Token> &tokens,
+                                               const CompiledSchema *schema,
+                                               Document &document,
+                                               NodeIndex &nodeIndex,
+                                               DocumentExtent &extent,
+                                               bool requireProperties,
+                                               const ResourceLimits &limits,
+                                               Probes &probes,
+                                               const std::stop_token &stopToken);
+
+        /**
+         * Check that the source isn't empty, and ends with a new line.
+         *
+         * @param tokens The tokens of the source, or of its last part
+         * @return
+         */
+        static std::optional<Error> checkEnd(const std::vector<Token> &tokens);
+
         /**
          * The RuleMismatch is in place to help us locate where
          * unexpected tokens occur. When a rule is tested, and it can
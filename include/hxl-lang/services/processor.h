@@ -1,9 +1,17 @@
 #pragma once
 
 #include "hxl-lang/core.h"
+#include "hxl-lang/services/deserializer.h"
 #include "hxl-lang/traits/traits.h"
+#include "hxl-lang/utilities/instrumentation.h"
+#include "hxl-lang/utilities/node-index.h"
+#include "hxl-lang/utilities/tracer.h"
 
+#include <future>
 #include <iostream>
+#include <memory>
+#include <span>
+#include <string>
 
 namespace HXL {
     /**
@@ -12,15 +20,188 @@ namespace HXL {
     typedef struct {
         PerformanceResults performanceResults;
         std::vector<Error> errors;
+
+        /**
+         * The processed document. String values deserialized as views
+         * (``DeserializationOptions::stringViews``) point into it, so
+         * keep it for as long as the views are in use.
+         */
+        std::shared_ptr<const Document> document;
     } ProcessResult;
 
+    /**
+     * Results of processing a batch of sources.
+     */
+    struct BatchProcessResult {
+        /**
+         * One result per source, in the order of the sources.
+         */
+        std::vector<ProcessResult> results;
+
+        /**
+         * The time spent in each stage, summed up over all sources. As the
+         * sources are processed in parallel, the total exceeds ``wallTime``.
+         */
+        PerformanceResults performanceResults;
+
+        /**
+         * The time it took to process the whole batch.
+         */
+        ExecutionTime wallTime;
+
+        /**
+         * The number of sources which failed to process.
+         */
+        size_t failed = 0;
+    };
+
+    class ThreadPool;
+
     /**
      * The role of the ``Processor`` is to work as a "full-featured
      * factory" that handles all the necessary steps from tokenizing
      * a source, and up until it has been deserialized.
+     *
+     * Sources can be processed in one go with the static ``process``, or
+     * with an instance, which is meant for processing many sources of the
+     * same schema. The instance compiles the schema and protocol once, and
+     * keeps its buffers (tokens, nodes, string storage, etc.) between calls,
+     * so processing a source of a similar size to the previous one hardly
+     * allocates any memory.
+     *
+     * An instance must not be used by more than one thread at a time.
+     *
+     * What is measured is chosen at compile time by the ``Instrumentation``
+     * policy (see ``hxl-lang/utilities/instrumentation.h``). ``Processor``
+     * measures the stages. ``BasicProcessor<NoInstrumentation>`` measures
+     * nothing, and leaves the ``PerformanceResults`` empty.
+     * ``BasicProcessor<FullInstrumentation>`` takes probes from inside the
+     * loops of the tokenizer and the parser as well.
      */
-    class Processor : protected Traits::MeasuresExecutionTime {
+    template<typename Instrumentation = StageInstrumentation>
+    class BasicProcessor : protected Traits::MeasuresExecutionTime {
     public:
+        /**
+         * Create a processor for sources of ``schema``, which are deserialized
+         * with ``protocol``.
+         *
+         * @param schema
+         * @param protocol
+         * @param options
+         */
+        BasicProcessor(const Schema &schema, const DeserializationProtocol &protocol, const ProcessorOptions &options = {});
+
+        /**
+         * Create a processor, which shares an already compiled schema and
+         * protocol.
+         *
+         * @param schema
+         * @param protocol
+         * @param options
+         */
+        BasicProcessor(std::shared_ptr<const CompiledSchema> schema,
+                       std::shared_ptr<const CompiledProtocol> protocol,
+                       const ProcessorOptions &options = {});
+
+        /**
+         * Translate the input source, and validate it through all stages,
+         * re-using the buffers of the previous call.
+         *
+         * The document is only re-used if the previous ``ProcessResult::document``
+         * has been released. Otherwise, a new document is allocated.
+         *
+         * @param source
+         * @return
+         */
+        ProcessResult process(const std::string &source);
+
+        /**
+         * Process the source with options for the deserialization.
+         *
+         * @param source
+         * @param options
+         * @return
+         */
+        ProcessResult process(const std::string &source, const DeserializationOptions &options);
+
+        /**
+         * Process many independent sources in parallel on ``pool``.
+         *
+         * Every worker gets its own processor, which shares the compiled
+         * schema and protocol with this one, and takes the next unprocessed
+         * source until none are left. The buffers of this instance aren't
+         * used, so it may be used for other sources in the meantime.
+         *
+         * The handles of the protocol are called from several threads at
+         * once, so they must be thread-safe. ``options.pool`` may be the same
+         * pool, which then also runs the handles of each document.
+         *
+         * @param sources
+         * @param pool
+         * @param options
+         * @return
+         */
+        BatchProcessResult processBatch(std::span<const std::string> sources,
+                                        ThreadPool &pool,
+                                        const DeserializationOptions &options = {}) const;
+
+        /**
+         * Process a source in a pipeline, where the stages work on batches of
+         * nodes at the same time, rather than one after the other.
+         *
+         * The source is split at the start of a node into parts of about
+         * ``pipeline.batchSize`` nodes. Each stage runs on its own thread, and
+         * passes batches to the next through bounded queues:
+         *
+         * 1. Tokenization, part by part
+         * 2. Parsing (which covers the schema validation)
+         * 3. Semantic analysis, inheritance and references, and required properties
+         * 4. Deserialization, on the calling thread
+         *
+         * Nodes can only inherit and reference nodes declared before them, so
+         * stage 3 resolves them as the nodes arrive. The batch handles and the
+         * handles which run on ``options.pool`` need all nodes of their type,
+         * so they run in a deferred phase, once all nodes are through.
+         *
+         * At most ``pipeline.queueDepth`` batches wait between two stages, which
+         * limits how far the stages run ahead of each other, but not the memory
+         * used: The document is built in full, as any node may be referenced later
+         * on. Its storage is even sized up front, for a node per ``<`` in the source
+         * and for strings as long as the source, so a ``<`` in a string or comment
+         * allocates a node which is never used.
+         *
+         * Unlike ``process``, the handles of the first nodes may already have
+         * run, when an error is found further down the source. Processing stops
+         * at the first error of any stage.
+         *
+         * @param source
+         * @param options
+         * @param pipeline
+         * @return
+         */
+        ProcessResult processPipelined(const std::string &source,
+                                       const DeserializationOptions &options = {},
+                                       const PipelineOptions &pipeline = {});
+
+        /**
+         * Process a source asynchronously, on ``options.executor``.
+         *
+         * The stages run one after the other, as with ``process``, but each
+         * works through the source in batches of ``options.batchSize`` nodes.
+         * After each batch, the progress is reported, and if a stop has been
+         * requested through ``options.stopToken``, the processing ends with
+         * ``HXL_CANCELLED``. As with ``process``, no handles are called, if
+         * any errors are found in the source.
+         *
+         * The instance is used for the processing, so it must be kept alive,
+         * and not used otherwise, until the result is ready.
+         *
+         * @param source
+         * @param options
+         * @return
+         */
+        std::future<ProcessResult> processAsync(std::string source, AsyncOptions options = {});
+
         /**
          * Translate the input source, and validate it through all stages.
          *
@@ -36,5 +217,131 @@ namespace HXL {
                                      const Schema &schema,
                                      const DeserializationProtocol &protocol);
 
+        /**
+         * Process the source with options for the deserialization, for instance
+         * to run it on a thread pool, or to receive string values as views.
+         *
+         * @param source
+         * @param schema
+         * @param protocol
+         * @param options
+         * @return
+         */
+        static ProcessResult process(const std::string &source,
+                                     const Schema &schema,
+                                     const DeserializationProtocol &protocol,
+                                     const DeserializationOptions &options);
+
+        /**
+         * Process the source with options for the processor, for instance to
+         * skip the validation of sources, which have already been validated.
+         *
+         * @param source
+         * @param schema
+         * @param protocol
+         * @param options
+         * @param processorOptions
+         * @return
+         */
+        static ProcessResult process(const std::string &source,
+                                     const Schema &schema,
+                                     const DeserializationProtocol &protocol,
+                                     const DeserializationOptions &options,
+                                     const ProcessorOptions &processorOptions);
+
+        /**
+         * Process many independent sources in parallel on ``pool``, see
+         * the member ``processBatch``.
+         *
+         * @param sources
+         * @param schema
+         * @param protocol
+         * @param pool
+         * @param options
+         * @return
+         */
+        static BatchProcessResult processBatch(std::span<const std::string> sources,
+                                               const Schema &schema,
+                                               const DeserializationProtocol &protocol,
+                                               ThreadPool &pool,
+                                               const DeserializationOptions &options = {});
+
+    private:
+        /**
+         * Implementation of ``processAsync``, on the executing thread.
+         *
+         * @param source
+         * @param options
+         * @return
+         */
+        ProcessResult processInSteps(const std::string &source, const AsyncOptions &options);
+
+        /**
+         * Analyze the nodes from ``begin`` to ``end``, and add them to ``index``,
+         * by which the transformer resolves them. Below ``ValidationLevel::Full``,
+         * the nodes are only indexed.
+         *
+         * @param index
+         * @param begin
+         * @param end
+         * @return
+         */
+        ErrorList analyze(NodeIndex &index, size_t begin, size_t end) const;
+
+        /**
+         * Measure a stage, with its allocations and hardware events, if
+         * they're counted, and trace it as a span. The span is recorded after
+         * the measurement, so it isn't counted as an allocation of the stage.
+         *
+         * Without instrumentation, the stage is only run.
+         *
+         * @param stage
+         * @param subject
+         * @return
+         */
+        template<typename F>
+        ExecutionTime measureStage([[maybe_unused]] std::string_view stage, F &&subject) const {
+            if constexpr (!Instrumentation::measuresStages) {
+                subject();
+                return {};
+            } else {
+                HXL_TRACE_SPAN(stage, "stage");
+                return measure(subject, processorOptions.trackAllocations, processorOptions.countHardwareEvents);
+            }
+        }
+
+        ProcessorOptions processorOptions;
+
+        /**
+         * Shared between the processors of a batch.
+         */
+        std::shared_ptr<const CompiledSchema> compiledSchema;
+
+        std::shared_ptr<const CompiledProtocol> compiledProtocol;
+
+        std::vector<Token> tokens;
+
+        std::shared_ptr<Document> document;
+
+        NodeIndex nodeIndex;
+
+        /**
+         * Index of the resolution stage of the pipeline, while ``nodeIndex``
+         * is used by the parsing stage.
+         */
+        NodeIndex resolutionIndex;
+
+        /**
+         * Parts of the source, which are passed between the stages of the
+         * pipeline, tokenized.
+         */
+        std::vector<std::vector<Token>> tokenBatches;
+
+        DeserializationBuffers deserializationBuffers;
     };
+
+    /**
+     * A processor, which measures its stages.
+     */
+    typedef BasicProcessor<StageInstrumentation> Processor;
 }
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "hxl-lang/core.h"
+#include "hxl-lang/services/deserializer.h"
+#include "hxl-lang/services/processor.h"
+#include "hxl-lang/traits/traits.h"
+#include "hxl-lang/utilities/tracer.h"
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace HXL {
+    class ThreadPool;
+
+    /**
+     * A document, which is split across several files (or sources).
+     *
+     * Every file is tokenized and parsed on its own, and the nodes of all
+     * files are then linked into a single document, in which nodes can
+     * reference and inherit nodes of any file, through one symbol table
+     * of node names.
+     *
+     * Parsed files are cached along with their content, so processing the
+     * project again only parses the files whose content has changed since.
+     *
+     * Within a project, nodes don't have to be declared before the nodes
+     * they reference or inherit. The linked document is ordered so they are
+     * (keeping the order of the files and of the nodes within them, where
+     * possible), so nodes can't reference each other in a cycle.
+     */
+    class Project : protected Traits::MeasuresExecutionTime {
+    public:
+        Project(const Schema &schema, const DeserializationProtocol &protocol);
+
+        /**
+         * Set the source of a file, which is added to the project, if it
+         * isn't already. Files are linked in the order they're added.
+         *
+         * @param name
+         * @param source
+         */
+        void setFile(const std::string &name, std::string source);
+
+        /**
+         * Read a file from disk, and set it as the source of the file named
+         * by its path.
+         *
+         * @param path
+         * @return An error, if the file can't be read
+         */
+        std::optional<Error> loadFile(const std::filesystem::path &path);
+
+        /**
+         * Remove a file from the project.
+         *
+         * @param name
+         */
+        void removeFile(const std::string &name);
+
+        /**
+         * Process the project: Parse the files which have changed (in parallel
+         * on ``pool``, if given), link all files, and deserialize the result.
+         *
+         * Errors found in a file are prefixed with its name.
+         *
+         * @param pool
+         * @param options
+         * @return
+         */
+        ProcessResult process(ThreadPool *pool = nullptr, const DeserializationOptions &options = {});
+
+        /**
+         * Parse the files which have changed, and link all files into a
+         * validated and transformed document, without deserializing it.
+         *
+         * @param pool
+         * @return
+         */
+        ProcessResult resolve(ThreadPool *pool = nullptr);
+
+        /**
+         * The number of times a file has been parsed, which only happens
+         * when it's new or changed.
+         *
+         * @return
+         */
+        [[nodiscard]] size_t parseCount() const;
+
+    private:
+        /**
+         * A file, and the result of parsing it.
+         */
+        struct File {
+            std::string name;
+
+            /**
+             * Kept after the file is parsed, so new content can be compared
+             * with it.
+             */
+            std::string source;
+
+            /**
+             * Set, when the source is new or has changed since it was parsed.
+             */
+            bool changed = true;
+
+            std::shared_ptr<const Document> document;
+            std::optional<Error> error;
+        };
+
+        std::shared_ptr<const CompiledSchema> compiledSchema;
+
+        std::shared_ptr<const CompiledProtocol> compiledProtocol;
+
+        std::vector<File> files;
+
+        size_t parses = 0;
+
+        DeserializationBuffers deserializationBuffers;
+
+        /**
+         * Measure a stage, traced as a span around the measurement, so the
+         * span isn't part of the measured time.
+         *
+         * @param stage
+         * @param subject
+         * @return
+         */
+        template<typename F>
+        static ExecutionTime measureStage([[maybe_unused]] std::string_view stage, F &&subject) {
+            HXL_TRACE_SPAN(stage, "stage");
+            return measure(subject);
+        }
+
+        /**
+         * Tokenize and parse a file. Required properties and the type of
+         * inherited nodes can only be checked once the files are linked.
+         *
+         * @param file
+         * @param performanceResults
+         */
+        void parse(File &file, PerformanceResults &performanceResults) const;
+
+        /**
+         * Link the parsed files into one document, ordered so nodes come after
+         * the nodes they reference and inherit.
+         *
+         * @param errors
+         * @return
+         */
+        std::shared_ptr<Document> link(ErrorList &errors) const;
+    };
+}
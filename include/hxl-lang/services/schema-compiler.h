@@ -0,0 +1,24 @@
+#pragma once
+
+#include "hxl-lang/core.h"
+
+namespace HXL {
+    /**
+     * Compiles a schema into a ``CompiledSchema``, where node types and
+     * properties are resolved to numeric IDs.
+     *
+     * A compiled schema can be re-used for any number of documents, so
+     * when processing many sources against the same schema, it's
+     * worth compiling it only once.
+     */
+    class SchemaCompiler {
+    public:
+        /**
+         * Compile the schema.
+         *
+         * @param schema
+         * @return
+         */
+        static CompiledSchema compile(const Schema &schema);
+    };
+}
@@ -4,6 +4,7 @@
 
 #include <format>
 #include <memory>
+#include <string_view>
 #include <vector>
 
 namespace HXL {
@@ -15,11 +16,44 @@ namespace HXL {
         /**
          * Validate a document against a schema.
          *
+         * Besides checking node types and properties, the data type of every
+         * property is checked against the schema. Properties which pass are
+         * converted to their final value (``NodeProperty::value``) in the same
+         * pass, so the Deserializer doesn't need to interpret them again.
+         *
          * @param schema
          * @param document
          * @return
          */
         static ErrorList validate(const Schema &schema,
                                   const std::shared_ptr<Document> &document);
+
+        /**
+         * Validate a document against a compiled schema.
+         *
+         * Apart from what's described above, nodes and properties are
+         * assigned their ``typeId`` and ``slot``.
+         *
+         * @param schema
+         * @param document
+         * @return
+         */
+        static ErrorList validate(const CompiledSchema &schema,
+                                  const std::shared_ptr<Document> &document);
+
+        /**
+         * Check a single property against its declaration in the schema,
+         * and convert its value if it passes.
+         *
+         * @param schemaNodeProperty
+         * @param node
+         * @param nodeProperty
+         * @param strings The ``Document::strings`` of the node's document
+         * @return
+         */
+        static std::optional<Error> checkProperty(const SchemaNodeProperty &schemaNodeProperty,
+                                                  const Node &node,
+                                                  NodeProperty &nodeProperty,
+                                                  std::string_view strings);
     };
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "hxl-lang/core.h"
+#include "hxl-lang/utilities/node-index.h"
 
 #include <memory>
 #include <vector>
@@ -23,5 +24,31 @@ namespace HXL {
          * @return
          */
         static ErrorList analyze(const std::shared_ptr<Document> &document);
+
+        /**
+         * Analyze a document, using (and clearing) ``seenNames``, so its
+         * memory can be kept between documents.
+         *
+         * @param document
+         * @param seenNames
+         * @return
+         */
+        static ErrorList analyze(const std::shared_ptr<Document> &document, NodeIndex &seenNames);
+
+        /**
+         * Analyze the nodes from ``begin`` to ``end``, continuing the analysis
+         * of the nodes before them, which must already be in ``seenNames``.
+         * The nodes are added to ``seenNames`` as they're analyzed.
+         *
+         * Only the nodes up to ``end`` are read, so nodes may be appended to
+         * the document in the meantime (without re-allocating the vector).
+         *
+         * @param document
+         * @param seenNames
+         * @param begin
+         * @param end
+         * @return
+         */
+        static ErrorList analyze(const Document &document, NodeIndex &seenNames, size_t begin, size_t end);
     };
 }
@@ -1,7 +1,10 @@
 #pragma once
 
 #include "hxl-lang/core.h"
+#include "hxl-lang/utilities/instrumentation.h"
+#include <optional>
 #include <regex>
+#include <string_view>
 #include <vector>
 #include <format>
 
@@ -28,9 +31,72 @@ namespace HXL {
          * for later stages to work with the document.
          *
          * @param source
+         * @param options
+         * @param limits
          * @return
          */
-        static TokenizerResult tokenize(const std::string &source);
+        static TokenizerResult tokenize(const std::string &source,
+                                        const TokenizerOptions &options = {},
+                                        const ResourceLimits &limits = {});
+
+        /**
+         * Tokenize the source into ``tokens``, replacing its contents.
+         *
+         * The tokens in ``tokens`` are overwritten rather than freed, so
+         * tokenizing source after source into the same vector re-uses
+         * the memory of the vector and of the token values.
+         *
+         * @param source
+         * @param tokens
+         * @param options
+         * @param limits
+         * @return
+         */
+        static std::optional<Error> tokenize(const std::string &source,
+                                             std::vector<Token> &tokens,
+                                             const TokenizerOptions &options = {},
+                                             const ResourceLimits &limits = {});
+
+        /**
+         * Tokenize a part of a source into ``tokens``, replacing its contents.
+         *
+         * The part must begin at the start of a line, which is line ``firstLine``
+         * of the source, so a source can be tokenized part by part, with the
+         * same positions as when it's tokenized in one go.
+         *
+         * @param source
+         * @param tokens
+         * @param firstLine
+         * @param options
+         * @param limits
+         * @return
+         */
+        static std::optional<Error> tokenize(std::string_view source,
+                                             std::vector<Token> &tokens,
+                                             uint16_t firstLine,
+                                             const TokenizerOptions &options = {},
+                                             const ResourceLimits &limits = {});
+
+        /**
+         * Tokenize a part of a source, and record in ``probes`` how much of it
+         * is taken in bulk (see ``StageProbes``). It's available for
+         * ``NoProbes``, with which it's the same as the above, and ``StageProbes``.
+         *
+         * @param source
+         * @param tokens
+         * @param firstLine
+         * @param options
+         * @param limits
+         * @param probes
+         * @return
+         */
+        template<typename Probes>
+        static std::optional<Error> tokenize(std::string_view source,
+                                             std::vector<Token> &tokens,
+                                             uint16_t firstLine,
+                                             const TokenizerOptions &options,
+                                             const ResourceLimits &limits,
+                                             Probes &probes);
 
     private:
         enum class BufferLooksLike {
@@ -43,13 +109,57 @@ namespace HXL {
         };
 
         /**
-         * The (exact) size of whitespace indentation that can be
-         * converted to tabs, when given at the beginning of a line.
+         * Arrays of numbers, which are at least this long (in characters),
+         * are tokenized as a single ``T_NUMERIC_ARRAY`` token. Below it,
+         * there's nothing to gain from doing so.
+         */
+        static constexpr size_t numericArrayMinLength = 64;
+
+        /**
+         * Scan from ``begin`` for the end of an array, which only holds
+         * numbers, commas and whitespace.
+         *
+         * @param source
+         * @param begin
+         * @return Position of the closing ``}``, or ``std::string::npos``
+         */
+        static size_t scanNumericArray(std::string_view source, size_t begin);
+
+        /**
+         * Check that the contents of an array are numbers separated by commas,
+         * with optional whitespace around them, and that none of the numbers is
+         * longer than ``maxLength``. Only then is it taken in one go. Anything
+         * else is tokenized value by value, so it's reported the same way,
+         * however long the array is.
+         *
+         * @param contents
+         * @param maxLength
+         * @return
          */
-        static uint8_t indentSize;
+        static bool isWellFormedNumericArray(std::string_view contents, size_t maxLength);
+
+        /**
+         * Writes tokens into a vector. The tokens already in the vector (from
+         * a previous source) are overwritten, so the memory of their values
+         * is re-used. ``finish`` drops the tokens which weren't overwritten.
+         *
+         * Tokens beyond ``limit`` are dropped, and flagged with ``exceeded``.
+         */
+        struct TokenWriter {
+            std::vector<Token> &tokens;
+            size_t limit;
+            size_t count = 0;
+            bool exceeded = false;
+
+            void operator()(TokenType tokenType,
+                            std::optional<std::string_view> value,
+                            const SourcePosition &position);
+
+            void finish();
+        };
 
         inline static void handleBuffer(std::string &buffer,
-                                        std::vector<Token> &tokenList,
+                                        TokenWriter &emit,
                                         BufferLooksLike &bufferLooksLike,
                                         const SourcePosition &pos);
 
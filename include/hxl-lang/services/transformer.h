@@ -1,6 +1,7 @@
 #pragma once
 
 #include "hxl-lang/core.h"
+#include "hxl-lang/utilities/node-index.h"
 
 #include <memory>
 
@@ -16,11 +17,46 @@ namespace HXL {
          *
          * The document will be scanned for inheritance. Found inheritances
          * will be resolved, and properties to be inherited will be populated.
+         * Afterwards, references are resolved to the nodes they point to.
          *
          * @param document
          */
         static void transform(const std::shared_ptr<Document> &document);
 
+        /**
+         * Perform transformations, using (and clearing) ``nodeIndex``, so
+         * its memory can be kept between documents.
+         *
+         * @param document
+         * @param nodeIndex
+         * @param limits
+         * @return An error, if a node inherits through more nodes than allowed
+         */
+        static std::optional<Error> transform(const std::shared_ptr<Document> &document,
+                                              NodeIndex &nodeIndex,
+                                              const ResourceLimits &limits = {});
+
+        /**
+         * Transform the nodes from ``begin`` to ``end``, when the nodes before
+         * them are already transformed. ``nodeIndex`` must index the nodes up
+         * to ``end``, as it does after ``SemanticAnalyzer::analyze``.
+         *
+         * As nodes can only inherit and reference nodes declared before them,
+         * a document can be transformed part by part, while it's being parsed.
+         *
+         * @param document
+         * @param nodeIndex
+         * @param begin
+         * @param end
+         * @param limits
+         * @return An error, if a node inherits through more nodes than allowed
+         */
+        static std::optional<Error> transform(Document &document,
+                                              const NodeIndex &nodeIndex,
+                                              size_t begin,
+                                              size_t end,
+                                              const ResourceLimits &limits = {});
+
     private:
         /**
          * Handle the inheritance resolution, which is the process of
@@ -28,10 +64,30 @@ namespace HXL {
          * which aren't present on the child, but on the parent.
          *
          * Properties which already exist on a child node are not to be modified.
+         * The parent is resolved before the child, so a child also inherits
+         * the properties its parent has inherited.
+         *
+         * @param document
+         * @param nodeIndex
+         * @param index The node to resolve
+         * @param limits
+         * @return
+         */
+        inline static std::optional<Error> inheritanceResolution(Document &document,
+                                                                 const NodeIndex &nodeIndex,
+                                                                 size_t index,
+                                                                 const ResourceLimits &limits);
+
+        /**
+         * Resolve references to the index of the referenced node in the
+         * document (``NodeRef::index``), so they can be followed without
+         * looking up the node by name.
          *
          * @param document
+         * @param nodeIndex
+         * @param index The node to resolve
          */
-        inline static void inheritanceResolution(const std::shared_ptr<Document> &document);
+        inline static void referenceResolution(Document &document, const NodeIndex &nodeIndex, size_t index);
 
     };
 }
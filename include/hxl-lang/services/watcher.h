@@ -0,0 +1,126 @@
+#pragma once
+
+#include "hxl-lang/core.h"
+#include "hxl-lang/services/project.h"
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace HXL {
+    class ThreadPool;
+
+    /**
+     * The callbacks of a ``Watcher``, which are only called for the nodes
+     * affected by a change.
+     */
+    struct NodeChangeHandles {
+        /**
+         * A node, which wasn't in the previous document.
+         */
+        std::function<void(const DeserializedNode &)> added;
+
+        /**
+         * A node whose content has changed, or which inherits or references
+         * (directly or through other nodes) a node which was added or changed.
+         */
+        std::function<void(const DeserializedNode &)> changed;
+
+        /**
+         * The name of a node, which is no longer in the document.
+         */
+        std::function<void(const std::string &)> removed;
+    };
+
+    /**
+     * Watches the files of a project, and reloads them as they change.
+     *
+     * Instead of deserializing the whole project again, the new document
+     * is compared with the previous one by a hash of the content of each
+     * node, and only the affected nodes are passed to the handles.
+     *
+     * Files are watched with inotify, so watching is only supported on
+     * Linux. Elsewhere, ``update`` can still be called after changing the
+     * files of the project by hand.
+     */
+    class Watcher {
+    public:
+        Watcher(Project &project, NodeChangeHandles handles);
+
+        ~Watcher();
+
+        Watcher(const Watcher &) = delete;
+
+        Watcher &operator=(const Watcher &) = delete;
+
+        /**
+         * Load a file into the project, and watch it for changes.
+         *
+         * The directory of the file is watched, rather than the file itself,
+         * so files replaced by editors which save to a temporary file, and
+         * rename it, are picked up as well.
+         *
+         * @param path
+         * @return An error, if the file can't be read or watched
+         */
+        std::optional<Error> watch(const std::filesystem::path &path);
+
+        /**
+         * Resolve the project, and call the handles for the nodes which have
+         * changed since the previous update. On the first update, all nodes
+         * are added.
+         *
+         * If the project has errors, no handles are called, and the next
+         * update is compared with the last document which had none.
+         *
+         * @param pool
+         * @return
+         */
+        ErrorList update(ThreadPool *pool = nullptr);
+
+        /**
+         * Wait up to ``timeout`` for the watched files to change, then reload
+         * the changed files, and ``update``.
+         *
+         * @param timeout
+         * @param pool
+         * @return
+         */
+        ErrorList poll(std::chrono::milliseconds timeout, ThreadPool *pool = nullptr);
+
+    private:
+        Project &project;
+
+        NodeChangeHandles handles;
+
+        /**
+         * The inotify instance.
+         */
+        int descriptor = -1;
+
+        /**
+         * The watched directories by their watch descriptor.
+         */
+        std::unordered_map<int, std::filesystem::path> directories;
+
+        std::unordered_set<std::string> files;
+
+        /**
+         * The content hash of each node of the previous document, by name.
+         */
+        std::unordered_map<std::string, size_t> hashes;
+
+        /**
+         * Hash the content of a node: Its type, inheritance, and properties.
+         * Inherited properties are included, once the document is transformed.
+         *
+         * @param document
+         * @param node
+         * @return
+         */
+        static size_t hashNode(const Document &document, const Node &node);
+    };
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "hxl-lang/core.h"
+#include "hxl-lang/utilities/allocation-tracker.h"
+#include "hxl-lang/utilities/hardware-counters.h"
 
 #include <chrono>
 #include <format>
@@ -26,13 +28,93 @@ namespace HXL::Traits {
     class MeasuresExecutionTime {
     protected:
         /**
-         * Measure the time it takes to execute ``subject``.
+         * Measure the time it takes to execute ``subject``, with a steady
+         * clock, so changes to the system time don't distort it.
          * The result is returned in the ``ExecutionTime`` struct.
          *
+         * The subject is taken as-is, rather than as ``std::function``,
+         * so measuring it never allocates.
+         *
+         * @param subject
+         * @return
+         */
+        template<typename F>
+        static ExecutionTime measure(F &&subject) {
+            auto start = std::chrono::steady_clock::now();
+
+            subject();
+
+            auto end = std::chrono::steady_clock::now();
+
+            PerformanceTime ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+            return {
+                    .ms = ns / 1000,
+                    .ns = ns,
+            };
+        }
+
+        /**
+         * Measure ``subject``, and when ``trackAllocations`` is set, count
+         * the allocations it makes on the current thread as well.
+         *
+         * @param subject
+         * @param trackAllocations
+         * @return
+         */
+        template<typename F>
+        static ExecutionTime measure(F &&subject, bool trackAllocations) {
+            if (!trackAllocations) {
+                return measure(subject);
+            }
+
+            AllocationTracker::Snapshot snapshot = AllocationTracker::start();
+            ExecutionTime time = measure(subject);
+            time.allocations = AllocationTracker::stop(snapshot);
+            return time;
+        }
+
+        /**
+         * Measure ``subject`` with its allocations, if ``trackAllocations`` is
+         * set, and the hardware events on the current thread, if
+         * ``countHardwareEvents`` is set, and the counters are available.
+         *
+         * The counters are read outside the tracked allocations, as the
+         * counters of a thread are opened the first time they're read.
+         *
          * @param subject
+         * @param trackAllocations
+         * @param countHardwareEvents
          * @return
          */
-        static ExecutionTime measure(const std::function<void()>& subject);
+        template<typename F>
+        static ExecutionTime measure(F &&subject, bool trackAllocations, bool countHardwareEvents) {
+            if (!countHardwareEvents) {
+                return measure(subject, trackAllocations);
+            }
 
+            HardwareCounterReader::Snapshot snapshot = HardwareCounterReader::start();
+            ExecutionTime time = measure(subject, trackAllocations);
+            time.hardware = HardwareCounterReader::stop(snapshot);
+            return time;
+        }
+
+        /**
+         * Count the nodes from ``begin`` to ``end``, their properties, array
+         * elements, references and inheritance links, to be reported with
+         * the time of a stage. The bytes and tokens are left to the caller.
+         *
+         * Array properties are told by the schema, so the nodes must have been
+         * parsed with it.
+         *
+         * @param schema
+         * @param nodes
+         * @param begin
+         * @param end
+         * @return
+         */
+        static StageCounters count(const CompiledSchema &schema,
+                                   const std::vector<Node> &nodes,
+                                   size_t begin,
+                                   size_t end);
     };
 }
@@ -0,0 +1,85 @@
+#pragma once
+
+/**
+ * Replacements of the global ``operator new`` and ``operator delete``, which
+ * report to the ``AllocationTracker``. Include this header in exactly one
+ * translation unit of the program.
+ *
+ * Every block is preceded by its size, so it can be counted when it's freed.
+ * Over-aligned allocations keep the default operators, and aren't counted.
+ */
+
+#include "hxl-lang/utilities/allocation-tracker.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace HXL::AllocationHooks {
+    constexpr size_t headerSize = alignof(std::max_align_t);
+
+    inline void *allocate(std::size_t size) noexcept {
+        auto *block = static_cast<unsigned char *>(std::malloc(headerSize + size));
+        if (!block) {
+            return nullptr;
+        }
+        *reinterpret_cast<std::size_t *>(block) = size;
+        AllocationTracker::recordAllocation(size);
+        return block + headerSize;
+    }
+
+    inline void deallocate(void *memory) noexcept {
+        if (!memory) {
+            return;
+        }
+        unsigned char *block = static_cast<unsigned char *>(memory) - headerSize;
+        AllocationTracker::recordDeallocation(*reinterpret_cast<std::size_t *>(block));
+        std::free(block);
+    }
+}
+
+void *operator new(std::size_t size) {
+    if (void *memory = HXL::AllocationHooks::allocate(size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) {
+    if (void *memory = HXL::AllocationHooks::allocate(size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    return HXL::AllocationHooks::allocate(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    return HXL::AllocationHooks::allocate(size);
+}
+
+void operator delete(void *memory) noexcept {
+    HXL::AllocationHooks::deallocate(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+    HXL::AllocationHooks::deallocate(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept {
+    HXL::AllocationHooks::deallocate(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept {
+    HXL::AllocationHooks::deallocate(memory);
+}
+
+void operator delete(void *memory, const std::nothrow_t &) noexcept {
+    HXL::AllocationHooks::deallocate(memory);
+}
+
+void operator delete[](void *memory, const std::nothrow_t &) noexcept {
+    HXL::AllocationHooks::deallocate(memory);
+}
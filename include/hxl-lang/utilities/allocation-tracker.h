@@ -0,0 +1,74 @@
+#pragma once
+
+#include "hxl-lang/core.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace HXL {
+    /**
+     * Counts the allocations made on each thread, so the memory used by a
+     * stage can be told apart from the memory used by the rest of the program.
+     *
+     * Allocations are only counted, when the allocation hooks are included
+     * in the program, which replace the global ``operator new`` and
+     * ``operator delete``:
+     *
+     * ````c++
+     * #include <hxl-lang/utilities/allocation-hooks.h>
+     * ````
+     *
+     * Without them, the tracker reports no allocations.
+     */
+    class AllocationTracker {
+    public:
+        /**
+         * The counters of the current thread, when tracking started.
+         */
+        struct Snapshot {
+            size_t allocations;
+            size_t bytesAllocated;
+            size_t bytesFreed;
+            int64_t bytesInUse;
+            size_t peakRss;
+        };
+
+        /**
+         * Called by the allocation hooks.
+         *
+         * @param size
+         */
+        static void recordAllocation(size_t size) noexcept;
+
+        /**
+         * Called by the allocation hooks.
+         *
+         * @param size
+         */
+        static void recordDeallocation(size_t size) noexcept;
+
+        /**
+         * Start tracking the allocations on the current thread. The peak
+         * is reset, so tracking can't be nested.
+         *
+         * @return
+         */
+        static Snapshot start() noexcept;
+
+        /**
+         * The allocations on the current thread since ``snapshot``.
+         *
+         * @param snapshot
+         * @return
+         */
+        static AllocationCounters stop(const Snapshot &snapshot) noexcept;
+
+        /**
+         * The peak resident set size of the process in bytes, or zero where
+         * it isn't available.
+         *
+         * @return
+         */
+        static size_t peakRss() noexcept;
+    };
+}
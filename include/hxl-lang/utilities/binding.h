@@ -0,0 +1,296 @@
+#pragma once
+
+#include "hxl-lang/core.h"
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace HXL {
+    /**
+     * Binds a property (by name) to a member of ``T``.
+     *
+     * @tparam T
+     * @tparam M
+     */
+    template<typename T, typename M>
+    struct FieldBinding {
+        std::string property;
+        M T::*member;
+    };
+
+    /**
+     * Whether ``M`` is a ``std::vector``.
+     */
+    template<typename M>
+    struct IsVector : std::false_type {};
+
+    template<typename V>
+    struct IsVector<std::vector<V>> : std::true_type {};
+
+    /**
+     * A set of bindings between properties and members of ``T``, which
+     * can be turned into a deserialization handle that writes the values
+     * of every node straight into objects of ``T``.
+     *
+     * The member types are known at compile time, so each write is a
+     * plain (inlinable) assignment, straight from the values in the document.
+     *
+     * Bindings are created with ``HXL::bind``.
+     *
+     * @tparam T
+     * @tparam Members
+     */
+    template<typename T, typename... Members>
+    class Binding {
+    public:
+        explicit Binding(std::tuple<FieldBinding<T, Members>...> fields) : fields(std::move(fields)) {}
+
+        /**
+         * Also write the node name into ``member``.
+         *
+         * @param member
+         * @return
+         */
+        Binding &name(std::string T::*member) {
+            nameMember = member;
+            return *this;
+        }
+
+        /**
+         * Create a handle, which appends an object to ``target`` for every
+         * node of the type. Reserve the vector in advance, to avoid re-allocations.
+         *
+         * @param nodeType
+         * @param target
+         * @return
+         */
+        DeserializationHandle into(const std::string &nodeType, std::vector<T> &target) const {
+            return into(nodeType, [&target](const DeserializedNodeView &) -> T & {
+                return target.emplace_back();
+            });
+        }
+
+        /**
+         * Create a handle, which writes every node of the type into the object
+         * returned by ``locate``. This can be used to write into objects which
+         * are allocated in advance, or owned by other structures.
+         *
+         * @param nodeType
+         * @param locate
+         * @return
+         */
+        DeserializationHandle into(const std::string &nodeType,
+                                   const std::function<T &(const DeserializedNodeView &)> &locate) const {
+            DeserializationHandle handle{nodeType};
+            handle.boundProperties = properties(std::index_sequence_for<Members...>{});
+            handle.bindViewHandle = [binding = *this, locate](const std::unordered_map<std::string, SlotId> &slots) {
+                std::array<SlotId, sizeof...(Members)> resolved = binding.resolve(slots, std::index_sequence_for<Members...>{});
+                return ViewHandle([binding, locate, resolved](const DeserializedNodeView &node) {
+                    T &object = locate(node);
+                    if (binding.nameMember) {
+                        object.*binding.nameMember = node.name;
+                    }
+                    binding.write(object, node, resolved, std::index_sequence_for<Members...>{});
+                });
+            };
+            return handle;
+        }
+
+        /**
+         * Create a handle, which writes every node of the type into the object
+         * returned by ``create``. The object is also returned from the handle,
+         * so references to the node arrive bound to it (``NodeRef::as<T>``).
+         *
+         * @param nodeType
+         * @param create
+         * @return
+         */
+        DeserializationHandle into(const std::string &nodeType,
+                                   const std::function<std::shared_ptr<T>(const DeserializedNodeView &)> &create) const {
+            DeserializationHandle handle{nodeType};
+            handle.boundProperties = properties(std::index_sequence_for<Members...>{});
+            handle.bindObjectHandle = [binding = *this, create](const std::unordered_map<std::string, SlotId> &slots) {
+                std::array<SlotId, sizeof...(Members)> resolved = binding.resolve(slots, std::index_sequence_for<Members...>{});
+                return ObjectHandle([binding, create, resolved](const DeserializedNodeView &node) -> std::shared_ptr<void> {
+                    std::shared_ptr<T> object = create(node);
+                    if (binding.nameMember) {
+                        (*object).*binding.nameMember = node.name;
+                    }
+                    binding.write(*object, node, resolved, std::index_sequence_for<Members...>{});
+                    return object;
+                });
+            };
+            return handle;
+        }
+
+    private:
+        std::tuple<FieldBinding<T, Members>...> fields;
+
+        std::string T::*nameMember = nullptr;
+
+        template<size_t... I>
+        std::vector<std::string> properties(std::index_sequence<I...>) const {
+            return {std::get<I>(fields).property...};
+        }
+
+        /**
+         * Resolve the bound properties to their slots. The protocol is only
+         * bound, once all of them are known to be declared.
+         */
+        template<size_t... I>
+        std::array<SlotId, sizeof...(Members)> resolve(const std::unordered_map<std::string, SlotId> &slots,
+                                                       std::index_sequence<I...>) const {
+            return {slots.at(std::get<I>(fields).property)...};
+        }
+
+        template<size_t... I>
+        void write(T &object,
+                   const DeserializedNodeView &node,
+                   const std::array<SlotId, sizeof...(Members)> &slots,
+                   std::index_sequence<I...>) const {
+            (assignIfPresent(object.*(std::get<I>(fields).member), node, slots[I]), ...);
+        }
+
+        /**
+         * Values converted by the schema validation (and bound references) are
+         * in the view. The rest, like strings, is read straight from the document.
+         */
+        template<typename M>
+        static void assignIfPresent(M &target, const DeserializedNodeView &node, SlotId slot) {
+            const NodeProperty *property = node.properties[slot];
+            if (!property) {
+                return;
+            }
+
+            if (const DeserializedValue *value = node.values[slot]) {
+                assign(target, *value);
+            } else {
+                assign(target, *property, *node.document);
+            }
+        }
+
+        /**
+         * Write a converted value to a member of type ``M``.
+         *
+         * Members can be of any of the types in ``DeserializedValue``, any arithmetic
+         * type (for single numeric values), or ``std::array`` (for arrays).
+         */
+        template<typename M>
+        static void assign(M &target, const DeserializedValue &value) {
+            if constexpr (std::is_constructible_v<DeserializedValue, M> && !std::is_arithmetic_v<M>) {
+                target = std::get<M>(value);
+            } else if constexpr (std::is_arithmetic_v<M>) {
+                std::visit([&](const auto &item) {
+                    using V = std::decay_t<decltype(item)>;
+                    if constexpr (std::is_arithmetic_v<V>) {
+                        target = static_cast<M>(item);
+                    } else {
+                        throw std::bad_variant_access();
+                    }
+                },
+                           value);
+            } else if constexpr (requires { std::tuple_size<M>::value; typename M::value_type; }) {
+                const auto &items = std::get<std::vector<typename M::value_type>>(value);
+                std::copy_n(items.begin(), std::min(items.size(), target.size()), target.begin());
+            } else {
+                static_assert(sizeof(M) == 0, "Member type cannot be bound to a HXL property.");
+            }
+        }
+
+        /**
+         * Write the values of a property, which haven't been converted, to
+         * a member of type ``M``. Strings are copied from the document into
+         * the member, without any intermediate copy.
+         */
+        template<typename M>
+        static void assign(M &target, const NodeProperty &property, const Document &document) {
+            if constexpr (IsVector<M>::value) {
+                target.resize(property.values.size());
+                for (size_t i = 0; i < target.size(); ++i) {
+                    assignScalar(target[i], property, property.values[i], document);
+                }
+            } else if constexpr (requires { std::tuple_size<M>::value; typename M::value_type; }) {
+                size_t count = std::min(property.values.size(), target.size());
+                for (size_t i = 0; i < count; ++i) {
+                    assignScalar(target[i], property, property.values[i], document);
+                }
+            } else {
+                assignScalar(target, property, property.values[0], document);
+            }
+        }
+
+        template<typename M>
+        static void assignScalar(M &target,
+                                 const NodeProperty &property,
+                                 const PropertyScalar &scalar,
+                                 const Document &document) {
+            if constexpr (std::is_same_v<M, std::string>) {
+                target.assign(document.text(scalar.string));
+            } else if constexpr (std::is_same_v<M, NodeRef>) {
+                target = NodeRef{std::string(document.text(scalar.string))};
+            } else if constexpr (std::is_arithmetic_v<M>) {
+                switch (property.dataType) {
+                    case DataType::Bool:
+                        target = static_cast<M>(scalar.boolean);
+                        break;
+                    case DataType::Int:
+                        target = static_cast<M>(scalar.integer);
+                        break;
+                    case DataType::Float:
+                        target = static_cast<M>(scalar.real);
+                        break;
+                    default:
+                        throw std::bad_variant_access();
+                }
+            } else {
+                static_assert(sizeof(M) == 0, "Member type cannot be bound to a HXL property.");
+            }
+        }
+    };
+
+    /**
+     * The type of the member, a member pointer points to.
+     */
+    template<typename P>
+    struct MemberOf;
+
+    template<typename M, typename C>
+    struct MemberOf<M C::*> {
+        typedef M type;
+    };
+
+    /**
+     * Create a binding between properties and members of ``T``, given as
+     * pairs of property names and member pointers.
+     *
+     * Call it qualified (``HXL::bind``), as it could otherwise be confused
+     * with ``std::bind``.
+     *
+     * @code
+     * HXL::bind<Material>("albedo_texture", &Material::albedoTexture,
+     *                     "texture_uv", &Material::textureUV)
+     *         .into("Material", materials);
+     * @endcode
+     *
+     * @tparam T
+     * @tparam Args
+     * @param args
+     * @return
+     */
+    template<typename T, typename... Args>
+    auto bind(Args... args) {
+        static_assert(sizeof...(Args) % 2 == 0, "Bindings must be given as pairs of property names and members.");
+        auto pairs = std::make_tuple(args...);
+        return [&]<size_t... I>(std::index_sequence<I...>) {
+            return Binding<T, typename MemberOf<std::tuple_element_t<I * 2 + 1, decltype(pairs)>>::type...>(
+                    std::make_tuple(FieldBinding<T, typename MemberOf<std::tuple_element_t<I * 2 + 1, decltype(pairs)>>::type>{
+                            std::string(std::get<I * 2>(pairs)),
+                            std::get<I * 2 + 1>(pairs),
+                    }...));
+        }(std::make_index_sequence<sizeof...(Args) / 2>{});
+    }
+}
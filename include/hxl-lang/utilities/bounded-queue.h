@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace HXL {
+    /**
+     * A bounded queue between one producer and one consumer.
+     *
+     * Items are kept in a ring buffer, and handed over through the atomic
+     * head and tail, so neither side takes a lock. When the queue is full
+     * (or empty), the producer (or consumer) sleeps on an atomic wait, until
+     * the other side has made progress.
+     *
+     * Either side can close the queue: The producer, when it has no more
+     * items, and the consumer, when it stops early. Items which were pushed
+     * before the queue was closed can still be popped.
+     *
+     * @tparam T
+     */
+    template<typename T>
+    class BoundedQueue {
+    public:
+        /**
+         * Create a queue for at least ``capacity`` items. The capacity is
+         * rounded up to a power of two.
+         *
+         * @param capacity
+         */
+        explicit BoundedQueue(size_t capacity) : slots(std::bit_ceil(std::max<size_t>(capacity, 1))) {}
+
+        BoundedQueue(const BoundedQueue &) = delete;
+
+        BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+        /**
+         * Push an item, waiting while the queue is full.
+         *
+         * @param item
+         * @return False, if the queue was closed (and the item dropped)
+         */
+        bool push(T item) {
+            size_t position = tail.load(std::memory_order_relaxed);
+            while (true) {
+                uint32_t seen = signal.load();
+                if (closed.load()) {
+                    return false;
+                }
+                if (position - head.load() < slots.size()) {
+                    break;
+                }
+                signal.wait(seen);
+            }
+
+            slots[position & (slots.size() - 1)] = std::move(item);
+            tail.store(position + 1);
+            notify();
+            return true;
+        }
+
+        /**
+         * Pop an item, waiting while the queue is empty.
+         *
+         * @return ``std::nullopt``, if the queue is closed and empty
+         */
+        std::optional<T> pop() {
+            size_t position = head.load(std::memory_order_relaxed);
+            while (true) {
+                uint32_t seen = signal.load();
+                if (position != tail.load()) {
+                    break;
+                }
+                if (closed.load()) {
+                    return std::nullopt;
+                }
+                signal.wait(seen);
+            }
+
+            std::optional<T> item = std::move(slots[position & (slots.size() - 1)]);
+            head.store(position + 1);
+            notify();
+            return item;
+        }
+
+        /**
+         * Close the queue, and wake up the other side.
+         */
+        void close() {
+            closed.store(true);
+            notify();
+        }
+
+    private:
+        std::vector<T> slots;
+
+        std::atomic<size_t> head = 0;
+
+        std::atomic<size_t> tail = 0;
+
+        std::atomic<bool> closed = false;
+
+        /**
+         * Changed whenever either side makes progress, which is what
+         * a waiting side waits for.
+         */
+        std::atomic<uint32_t> signal = 0;
+
+        void notify() {
+            signal.fetch_add(1);
+            signal.notify_all();
+        }
+    };
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "hxl-lang/core.h"
+
+#include <cstdint>
+#include <optional>
+
+namespace HXL {
+    /**
+     * Reads the performance counters of the CPU for the current thread,
+     * through ``perf_event_open`` on Linux.
+     *
+     * The counters of a thread are opened the first time it reads them,
+     * and stay open until it exits, so reading them costs a system call.
+     * When they can't be opened (on other systems, in virtual machines
+     * without a PMU, or where ``perf_event_paranoid`` doesn't allow it), every
+     * read returns nothing, and they aren't tried again on that thread.
+     */
+    class HardwareCounterReader {
+    public:
+        /**
+         * The counters of the current thread, when counting started.
+         */
+        struct Snapshot {
+            bool available;
+            HardwareCounters counters;
+        };
+
+        /**
+         * Start counting the events on the current thread. The counters keep
+         * running, so counting can be nested.
+         *
+         * @return
+         */
+        static Snapshot start() noexcept;
+
+        /**
+         * The events on the current thread since ``snapshot``, or nothing
+         * if the counters aren't available.
+         *
+         * @param snapshot
+         * @return
+         */
+        static std::optional<HardwareCounters> stop(const Snapshot &snapshot) noexcept;
+
+        /**
+         * Whether the counters can be read on the current thread.
+         *
+         * @return
+         */
+        static bool available() noexcept;
+    };
+}
@@ -1,6 +1,11 @@
 #pragma once
 
+#include "hxl-lang/core.h"
+
+#include <charconv>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace HXL {
@@ -26,6 +31,7 @@ namespace HXL {
         template<typename T>
         static std::vector<T> toArray(const std::vector<std::string> &values) {
             std::vector<T> result;
+            result.reserve(values.size());
             for (const std::string &str: values) {
                 if constexpr (std::is_same_v<T, int>) {
                     result.push_back(std::stoi(str));
@@ -37,5 +43,69 @@ namespace HXL {
             }
             return result;
         }
+
+        /**
+         * Parse a numeric string to ``T`` (``int`` or ``float``).
+         *
+         * Contrary to ``std::stoi`` and ``std::stof`` this never throws. If the
+         * string isn't entirely numeric, or the value can't be represented
+         * by ``T``, ``std::nullopt`` is returned.
+         *
+         * @tparam T
+         * @param str
+         * @return
+         */
+        template<typename T>
+        static std::optional<T> toNumber(const std::string &str) {
+            T result;
+            auto [end, ec] = std::from_chars(str.data(), str.data() + str.size(), result);
+            if (ec != std::errc() || end != str.data() + str.size()) {
+                return std::nullopt;
+            }
+            return result;
+        }
+
+        /**
+         * Parse the contents of a numeric array (as in ``{ 1, 2, 3 }`` without
+         * the braces) straight into a typed buffer. If any of the numbers has
+         * a decimal point, it's ``std::vector<float>``, otherwise ``std::vector<int>``.
+         * The numbers before the first one with a decimal point are converted
+         * as integers, like the values of an array parsed token by token.
+         *
+         * Returns ``std::nullopt``, if the contents are malformed, or a number
+         * can't be represented as ``dataType``.
+         *
+         * @param contents
+         * @param dataType The data type of the array, or of the number which failed
+         * @return
+         */
+        static std::optional<DeserializedValue> parseNumericArray(std::string_view contents, DataType &dataType);
+
+        /**
+         * Convert the values of a node property to the data type and value
+         * structure declared in the schema.
+         *
+         * The data type of the property must already be verified as compatible
+         * with ``dataType``. String values are looked up in ``strings``
+         * (the ``Document::strings`` of the property's document).
+         *
+         * @param nodeProperty
+         * @param dataType
+         * @param structure
+         * @param strings
+         * @return
+         */
+        static Result<DeserializedValue> toValue(const NodeProperty &nodeProperty,
+                                                 DataType dataType,
+                                                 ValueStructure structure,
+                                                 std::string_view strings);
+
+        /**
+         * Human-readable name of a data type.
+         *
+         * @param dataType
+         * @return
+         */
+        static std::string toString(DataType dataType);
     };
 }
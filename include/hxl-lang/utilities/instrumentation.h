@@ -0,0 +1,55 @@
+#pragma once
+
+#include "hxl-lang/core.h"
+
+#include <cstddef>
+
+namespace HXL {
+    /**
+     * Probes, which record nothing. Loops taking them compile as if they
+     * weren't there.
+     */
+    struct NoProbes {
+        void record(size_t StageProbes::*, size_t = 1) {
+        }
+    };
+
+    /**
+     * Instrumentation policies of a ``BasicProcessor``, which choose at compile
+     * time what is measured:
+     *
+     * - ``measuresStages``: Whether the stages are timed, counted and traced,
+     *   and reported in ``PerformanceResults``
+     * - ``Probes``: What the tokenizer and parser record from inside their
+     *   loops, either ``NoProbes`` or ``StageProbes``
+     */
+
+    /**
+     * Nothing is measured, so the ``PerformanceResults`` are left empty,
+     * and none of the measuring is compiled in.
+     */
+    struct NoInstrumentation {
+        static constexpr bool measuresStages = false;
+
+        typedef NoProbes Probes;
+    };
+
+    /**
+     * The stages are measured, which is the default of ``Processor``.
+     */
+    struct StageInstrumentation {
+        static constexpr bool measuresStages = true;
+
+        typedef NoProbes Probes;
+    };
+
+    /**
+     * The stages are measured, and the tokenizer and parser take probes
+     * from inside their loops (``ExecutionTime::probes``).
+     */
+    struct FullInstrumentation {
+        static constexpr bool measuresStages = true;
+
+        typedef StageProbes Probes;
+    };
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "hxl-lang/core.h"
+
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace HXL {
+    /**
+     * Index of the nodes of a document by name.
+     *
+     * The names aren't copied. Entries refer to the nodes by position, so the
+     * index is only valid for the vector of nodes it was built from. Clearing
+     * the index keeps its memory, so it can be re-used for the next document
+     * without allocating.
+     */
+    class NodeIndex {
+    public:
+        /**
+         * Forget all nodes, but keep the memory for the next document.
+         */
+        void clear();
+
+        /**
+         * Add the node at ``index`` by its name.
+         *
+         * @param nodes
+         * @param index
+         * @return False, if a node of the same name is already present (which is kept)
+         */
+        bool insert(const std::vector<Node> &nodes, size_t index);
+
+        /**
+         * Find a node by name.
+         *
+         * @param nodes
+         * @param name
+         * @return
+         */
+        [[nodiscard]] std::optional<size_t> find(const std::vector<Node> &nodes, std::string_view name) const;
+
+    private:
+        static constexpr size_t empty = static_cast<size_t>(-1);
+
+        struct Entry {
+            size_t hash;
+            size_t index = empty;
+        };
+
+        /**
+         * Open addressing with linear probing. The size is always a power
+         * of two, and kept at least twice the number of nodes.
+         */
+        std::vector<Entry> entries;
+
+        size_t count = 0;
+
+        void grow();
+    };
+}
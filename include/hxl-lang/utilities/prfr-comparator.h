@@ -0,0 +1,133 @@
+#pragma once
+
+#include "hxl-lang/core.h"
+
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace HXL::Utilities {
+    /**
+     * When a difference from the baseline is reported.
+     *
+     * A stage has to differ by more than the largest of the three thresholds,
+     * so short stages, and stages which vary a lot from run to run, aren't
+     * reported for their noise.
+     */
+    struct ComparisonOptions {
+        /**
+         * The difference relative to the baseline, e.g. 0.05 for 5%.
+         */
+        double tolerance = 0.05;
+
+        /**
+         * The number of median absolute deviations of the runs.
+         */
+        double noiseFactor = 3.0;
+
+        /**
+         * The smallest difference in nanoseconds.
+         */
+        PerformanceTime minimumDelta = 1000;
+    };
+
+    /**
+     * The comparison of a stage with its baseline.
+     */
+    struct StageComparison {
+        std::string_view stage;
+
+        PerformanceTime baselineNs;
+
+        /**
+         * The median of the runs.
+         */
+        PerformanceTime medianNs;
+
+        /**
+         * The median absolute deviation of the runs.
+         */
+        PerformanceTime noiseNs;
+
+        /**
+         * The difference, beyond which the stage has changed.
+         */
+        PerformanceTime thresholdNs;
+
+        /**
+         * The difference relative to the baseline, positive when slower.
+         */
+        double delta;
+
+        bool regressed = false;
+
+        bool improved = false;
+    };
+
+    struct PerformanceComparison {
+        /**
+         * The stages, which were measured in both the baseline and the runs.
+         */
+        std::vector<StageComparison> stages;
+
+        [[nodiscard]] bool regressed() const {
+            return std::any_of(stages.begin(), stages.end(), [](const StageComparison &stage) {
+                return stage.regressed;
+            });
+        }
+    };
+
+    /**
+     * Compares performance results with a baseline, such as the results of
+     * a previous version, exported by ``PerformanceResultsExporter::toJson``.
+     *
+     * A single run is too noisy to compare, so each stage is compared by its
+     * median over several runs.
+     */
+    class PerformanceResultsComparator {
+    public:
+        /**
+         * The median of each stage over the runs, which is what a baseline
+         * should be made from. Counters and allocations are those of the
+         * run with the median time.
+         *
+         * @param runs
+         * @return
+         */
+        static PerformanceResults median(std::span<const PerformanceResults> runs);
+
+        /**
+         * Compare the runs with the baseline, stage by stage.
+         *
+         * @param baseline
+         * @param runs
+         * @param options
+         * @return
+         */
+        static PerformanceComparison compare(const PerformanceResults &baseline,
+                                             std::span<const PerformanceResults> runs,
+                                             const ComparisonOptions &options = {});
+
+        /**
+         * Compare the runs with a baseline file.
+         *
+         * @param baseline
+         * @param runs
+         * @param options
+         * @return An error, if the baseline can't be read
+         */
+        static Result<PerformanceComparison> compare(const std::filesystem::path &baseline,
+                                                     std::span<const PerformanceResults> runs,
+                                                     const ComparisonOptions &options = {});
+
+        /**
+         * Describe the comparison, a line per stage, for logs.
+         *
+         * @param comparison
+         * @return
+         */
+        static std::string describe(const PerformanceComparison &comparison);
+    };
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "hxl-lang/core.h"
+
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace HXL::Utilities {
+    /**
+     * Exports performance results in machine-readable formats, so they can
+     * be kept (as a baseline), and compared across runs and versions.
+     */
+    class PerformanceResultsExporter {
+    public:
+        /**
+         * Export the results as a JSON object, with an object per stage (or
+         * ``null``, if it wasn't measured), holding its time in nanoseconds
+         * and microseconds, the counters, the rates, the allocations, the
+         * hardware events and the probes.
+         *
+         * @param results
+         * @return
+         */
+        static std::string toJson(const PerformanceResults &results);
+
+        /**
+         * Read results exported by ``toJson``. The rates are derived, so
+         * they're ignored, as are keys which aren't known.
+         *
+         * @param json
+         * @return
+         */
+        static Result<PerformanceResults> fromJson(std::string_view json);
+
+        /**
+         * Read results exported by ``toJson`` from a file.
+         *
+         * @param path
+         * @return
+         */
+        static Result<PerformanceResults> load(const std::filesystem::path &path);
+
+        /**
+         * Export the results of one or more runs as CSV, with a header, and a
+         * row per run and measured stage.
+         *
+         * @param runs
+         * @return
+         */
+        static std::string toCsv(std::span<const PerformanceResults> runs);
+
+        /**
+         * Export the results of a single run as CSV.
+         *
+         * @param results
+         * @return
+         */
+        static std::string toCsv(const PerformanceResults &results);
+    };
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace HXL {
+    /**
+     * A work-stealing thread pool.
+     *
+     * Every worker has its own queue. Tasks submitted from a worker are
+     * pushed to (and popped from) the back of its own queue, while idle
+     * workers steal from the front of the others' queues. This keeps
+     * related work on the same thread, and spreads it out when needed.
+     *
+     * Tasks are grouped with ``TaskGroup``, which can be waited upon.
+     */
+    class ThreadPool {
+    public:
+        /**
+         * Start the pool with ``threadCount`` workers (at least one).
+         *
+         * @param threadCount
+         */
+        explicit ThreadPool(size_t threadCount = std::thread::hardware_concurrency());
+
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        /**
+         * Submit a task to the pool.
+         *
+         * @param task
+         */
+        void submit(std::function<void()> task);
+
+        /**
+         * Take a pending task, and run it on the calling thread.
+         *
+         * @return False, if there were no pending tasks
+         */
+        bool runPending();
+
+        /**
+         * The number of workers.
+         *
+         * @return
+         */
+        [[nodiscard]] size_t size() const;
+
+    private:
+        struct Queue {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        std::vector<std::unique_ptr<Queue>> queues;
+
+        std::vector<std::thread> threads;
+
+        /**
+         * The tasks submitted, but not taken yet. A task is counted before
+         * it's queued, so the count is never below the number of queued tasks.
+         */
+        std::atomic<size_t> pending = 0;
+
+        std::atomic<size_t> nextQueue = 0;
+
+        std::mutex sleepMutex;
+
+        std::condition_variable wake;
+
+        bool stopping = false;
+
+        void work(size_t index);
+
+        bool take(size_t index, std::function<void()> &task);
+    };
+
+    /**
+     * A group of tasks running on a ``ThreadPool``.
+     */
+    class TaskGroup {
+    public:
+        explicit TaskGroup(ThreadPool &pool);
+
+        /**
+         * Waits for the remaining tasks, but doesn't throw.
+         */
+        ~TaskGroup();
+
+        /**
+         * Run a task as part of the group.
+         *
+         * @param task
+         */
+        void run(std::function<void()> task);
+
+        /**
+         * Wait for all tasks in the group to complete. Meanwhile, the calling
+         * thread helps out by running pending tasks.
+         *
+         * If a task threw an exception, the first one is re-thrown here.
+         */
+        void wait();
+
+    private:
+        ThreadPool &pool;
+
+        std::atomic<size_t> remaining = 0;
+
+        std::mutex mutex;
+
+        std::condition_variable done;
+
+        std::exception_ptr exception;
+
+        void finish();
+    };
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "hxl-lang/core.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace HXL {
+    /**
+     * A span of time, recorded by a ``Tracer``.
+     */
+    struct TraceEvent {
+        std::string name;
+
+        /**
+         * What the span covers: ``stage``, ``source``, ``file``, ``prepare``
+         * (a chunk of nodes prepared for a handle) or ``handle``.
+         */
+        std::string category;
+
+        /**
+         * The start, in nanoseconds since the tracer was created.
+         */
+        int64_t startNs;
+
+        int64_t durationNs;
+
+        /**
+         * A small number per thread, in the order the threads were first traced.
+         */
+        uint32_t threadId;
+    };
+
+    /**
+     * Records spans of the processing (of each stage, each part of a source,
+     * and each chunk of nodes passed to a handle) on every thread, and writes
+     * them as Chrome trace events, which can be opened in Perfetto
+     * (ui.perfetto.dev) or ``chrome://tracing``.
+     *
+     * Spans are only recorded, when the library is compiled with
+     * ``HXL_TRACING`` defined (``HXL_ENABLE_TRACING`` in CMake). Otherwise,
+     * ``HXL_TRACE_SPAN`` expands to nothing, and tracing costs nothing.
+     *
+     * One tracer is active at a time. It must outlive the processing it traces.
+     */
+    class Tracer {
+    public:
+        Tracer();
+
+        ~Tracer();
+
+        Tracer(const Tracer &) = delete;
+
+        Tracer &operator=(const Tracer &) = delete;
+
+        /**
+         * Make this the active tracer, which the spans are recorded by.
+         */
+        void begin();
+
+        /**
+         * Stop recording spans, if this is the active tracer.
+         */
+        void end();
+
+        /**
+         * The active tracer, if any.
+         *
+         * @return
+         */
+        static Tracer *active() noexcept;
+
+        /**
+         * Record a span on the current thread.
+         *
+         * @param name
+         * @param category
+         * @param start
+         * @param end
+         */
+        void record(std::string_view name,
+                    std::string_view category,
+                    std::chrono::steady_clock::time_point start,
+                    std::chrono::steady_clock::time_point end);
+
+        /**
+         * The recorded spans, in the order they ended.
+         *
+         * @return
+         */
+        [[nodiscard]] std::vector<TraceEvent> events() const;
+
+        /**
+         * The spans as Chrome trace-event JSON (complete events, in microseconds).
+         *
+         * @return
+         */
+        [[nodiscard]] std::string toJson() const;
+
+        /**
+         * Write the spans as Chrome trace-event JSON to a file.
+         *
+         * @param path
+         * @return An error, if the file can't be written
+         */
+        [[nodiscard]] std::optional<Error> write(const std::filesystem::path &path) const;
+
+        /**
+         * The number of the current thread, as it's traced.
+         *
+         * @return
+         */
+        static uint32_t threadId() noexcept;
+
+    private:
+        std::chrono::steady_clock::time_point origin;
+
+        mutable std::mutex mutex;
+
+        std::vector<TraceEvent> recorded;
+
+        static std::atomic<Tracer *> current;
+    };
+
+    /**
+     * Records a span from its construction to its destruction with the
+     * tracer, which is active when it's constructed. The name and category
+     * must outlive the span.
+     *
+     * Use ``HXL_TRACE_SPAN``, so the span is compiled out with tracing.
+     */
+    class TraceSpan {
+    public:
+        TraceSpan(std::string_view name, std::string_view category) noexcept;
+
+        ~TraceSpan();
+
+        TraceSpan(const TraceSpan &) = delete;
+
+        TraceSpan &operator=(const TraceSpan &) = delete;
+
+    private:
+        Tracer *tracer;
+
+        std::string_view name;
+
+        std::string_view category;
+
+        std::chrono::steady_clock::time_point start;
+    };
+}
+
+#if defined(HXL_TRACING)
+#define HXL_TRACE_CONCAT_(a, b) a##b
+#define HXL_TRACE_CONCAT(a, b) HXL_TRACE_CONCAT_(a, b)
+#define HXL_TRACE_SPAN(name, category) const HXL::TraceSpan HXL_TRACE_CONCAT(hxlTraceSpan, __LINE__)(name, category)
+#else
+#define HXL_TRACE_SPAN(name, category) static_cast<void>(0)
+#endif
@@ -31,28 +31,21 @@ DeserializationProtocol WatchGrassGrowSimulator::HXLSetup::createDeserialization
     DeserializationProtocol protocol;
 
     // Material
-    DeserializationHandle material{"Material"};
-    material.handle = [&](const DeserializedNode &node) {
-        auto albedoTexture = node.properties.at("albedo_texture").value;
-        auto uv = std::get<std::vector<float>>(node.properties.at("texture_uv").value);
-        materials.push_back(std::make_shared<Material>(Material{
-                .name = node.name,
-                .albedoTexture = std::get<std::string>(albedoTexture),
-                .textureUV = {uv[0], uv[1]},
-        }));
-    };
-    protocol.handles.push_back(material);
+    // The properties are bound directly to the members of Material,
+    // and the material is returned, so references to it arrive bound
+    protocol.handles.push_back(HXL::bind<Material>("albedo_texture", &Material::albedoTexture,
+                                                   "texture_uv", &Material::textureUV)
+                                       .name(&Material::name)
+                                       .into("Material", [&](const DeserializedNodeView &node) {
+                                           return materials.emplace_back(std::make_shared<Material>());
+                                       }));
 
     // Surface3D
     DeserializationHandle surface3d{"Surface3D"};
     surface3d.handle = [&](const DeserializedNode &node) {
         Surface3D surface = Surface3D{};
         if (node.properties.contains("material")) {
-            NodeRef materialName = std::get<NodeRef>(node.properties.at("material").value);
-            auto foundMaterial = materials.get(materialName.references);
-            if (foundMaterial.has_value()) {
-                surface.material = foundMaterial.value();
-            }
+            surface.material = std::get<NodeRef>(node.properties.at("material").value).as<Material>();
         }
         renderables.push_back(std::make_shared<Surface3D>(surface));
     };
@@ -68,15 +61,10 @@ DeserializationProtocol WatchGrassGrowSimulator::HXLSetup::createDeserialization
     protocol.handles.push_back(mesh3d);
 
     // Bird flock
-    DeserializationHandle birdFlock{"BirdFlock"};
-    birdFlock.handle = [&](const DeserializedNode &node) {
-        birdFlocks.push_back({
-                .count = std::get<int>(node.properties.at("count").value),
-                .type = std::get<std::string>(node.properties.at("type").value),
-                .attacksPlayer = std::get<bool>(node.properties.at("attacks_player").value),
-        });
-    };
-    protocol.handles.push_back(birdFlock);
+    protocol.handles.push_back(HXL::bind<BirdFlock>("count", &BirdFlock::count,
+                                                    "type", &BirdFlock::type,
+                                                    "attacks_player", &BirdFlock::attacksPlayer)
+                                       .into("BirdFlock", birdFlocks));
 
     return protocol;
 }
@@ -2,6 +2,7 @@
 
 #include <engine.h>
 #include <hxl-lang/hxl-lang.h>
+#include <hxl-lang/utilities/binding.h>
 
 using namespace HXL;
 using namespace TinyButEpic;
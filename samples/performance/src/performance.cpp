@@ -1,6 +1,13 @@
 #include "hxl-lang/hxl-lang.h"
+#include "hxl-lang/utilities/allocation-hooks.h"
+#include "hxl-lang/utilities/prfr-comparator.h"
+#include "hxl-lang/utilities/prfr-exporter.h"
 #include "hxl-lang/utilities/prfr-printer.h"
 
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
 // Since debug mode is a lot slower, we will not be processing
 // as many there.
 
@@ -10,6 +17,9 @@
 #define SAMPLE_NODES (10 * 1000)
 #endif
 
+// The number of runs, of which the median is compared with a baseline
+#define SAMPLE_RUNS 5
+
 using namespace HXL;
 
 /**
@@ -43,14 +53,14 @@ std::string generateSource(uint32_t nodes) {
             case 2:
                 s += "<B> Node" + std::to_string(i) + "\n";
                 s += "\tname: \"Hello, World!\"\n";
-                s += "\tref&: A";
+                s += "\tref&: Node0";
                 s += "\n";
                 break;
 
             // Inheritance
             case 3:
                 s += "<B> Node" + std::to_string(i) + " <= Node1\n";
-                s += "\tref&: A";
+                s += "\tref&: Node0";
                 s += "\n";
                 break;
 
@@ -69,7 +79,7 @@ std::string generateSource(uint32_t nodes) {
     return s;
 }
 
-int main() {
+int main(int argc, char **argv) {
     Schema schema;
     schema.types.push_back({"A", {{"x", DataType::Int}}});
     schema.types.push_back({"B", {
@@ -84,8 +94,12 @@ int main() {
     protocol.handles.push_back({"C", [&](const DeserializedNode &node) {}});
 
     try {
-        // Run the source through the entire translation process
-        ProcessResult result = Processor::process(generateSource(SAMPLE_NODES), schema, protocol);
+        // Run the source through the entire translation process, and
+        // count the memory allocated by each stage, its hardware events,
+        // and the probes of the tokenizer and the parser
+        BasicProcessor<FullInstrumentation> processor(schema, protocol, {.trackAllocations = true, .countHardwareEvents = true});
+        std::string source = generateSource(SAMPLE_NODES);
+        ProcessResult result = processor.process(source);
 
         // Check for errors...
         if (!result.errors.empty()) {
@@ -96,7 +110,83 @@ int main() {
         Utilities::PerformanceResultsPrinter::print(result.performanceResults);
 
         std::cout << "\nNodes generated: " << SAMPLE_NODES << std::endl;
+
+        // The memory kept by each stage. The document is built by the parser,
+        // and extended with the inherited properties by the transformer.
+        const PerformanceResults &performance = result.performanceResults;
+        std::cout << "\nAllocations:\n";
+        for (const auto &[name, stage]: {std::pair{"Tokenization", performance.tokenization},
+                                         std::pair{"Parsing", performance.parsing},
+                                         std::pair{"Semantic analysis", performance.semanticAnalysis},
+                                         std::pair{"Transformation", performance.transformer},
+                                         std::pair{"Deserialization", performance.deserialization}}) {
+            const AllocationCounters &allocations = stage->allocations.value();
+            std::cout << name << ": "
+                      << allocations.allocations << " allocations, "
+                      << allocations.bytesAllocated << " bytes allocated, "
+                      << allocations.bytesRetained << " bytes retained\n";
+        }
+
+        int64_t documentBytes = performance.parsing->allocations->bytesRetained +
+                                performance.transformer->allocations->bytesRetained;
+        std::cout << "\nDocument: " << documentBytes / SAMPLE_NODES << " bytes per node" << std::endl;
+
+        // Where the work of the tokenizer and the parser goes
+        const StageProbes &tokenizer = performance.tokenization->probes.value();
+        const StageProbes &parser = performance.parsing->probes.value();
+        std::cout << "\nProbes:\n"
+                  << "Tokenization: " << tokenizer.literalBytes + tokenizer.commentBytes + tokenizer.numericArrayBytes
+                  << " of " << performance.tokenization->counters.bytes << " bytes taken in bulk\n"
+                  << "Parsing: " << parser.typeLookups + parser.slotLookups + parser.nodeLookups << " lookups, "
+                  << parser.numberConversions << " number conversions, "
+                  << parser.stringBytes << " string bytes copied" << std::endl;
+
+        // Tells whether a stage is bound by its branches, or waits for memory.
+        // The counters aren't available everywhere, so they're left out then.
+        if (performance.tokenization->hardware.has_value()) {
+            std::cout << "\nHardware events (per 1000 instructions):\n";
+            for (const auto &[name, stage]: {std::pair{"Tokenization", performance.tokenization},
+                                             std::pair{"Parsing", performance.parsing},
+                                             std::pair{"Semantic analysis", performance.semanticAnalysis},
+                                             std::pair{"Transformation", performance.transformer},
+                                             std::pair{"Deserialization", performance.deserialization}}) {
+                const HardwareCounters &hardware = stage->hardware.value();
+                double thousands = std::max<double>(static_cast<double>(hardware.instructions) / 1000.0, 1.0);
+                std::cout << name << ": "
+                          << hardware.instructionsPerCycle() << " instructions per cycle, "
+                          << static_cast<double>(hardware.cacheMisses) / thousands << " cache misses, "
+                          << static_cast<double>(hardware.branchMisses) / thousands << " branch misses\n";
+            }
+        }
+
+        // With a baseline file given, the median of several runs is compared
+        // with it, or saved as the baseline, if there's none yet
+        if (argc < 2) {
+            return 0;
+        }
+
+        std::vector<PerformanceResults> runs = {result.performanceResults};
+        for (int i = 1; i < SAMPLE_RUNS; ++i) {
+            runs.push_back(processor.process(source).performanceResults);
+        }
+
+        std::filesystem::path baseline = argv[1];
+        if (!std::filesystem::exists(baseline)) {
+            std::ofstream(baseline) << Utilities::PerformanceResultsExporter::toJson(Utilities::PerformanceResultsComparator::median(runs));
+            std::cout << "\nBaseline saved to " << baseline.string() << std::endl;
+            return 0;
+        }
+
+        Result<Utilities::PerformanceComparison> comparison = Utilities::PerformanceResultsComparator::compare(baseline, runs);
+        if (comparison.isErr()) {
+            throw std::runtime_error(comparison.error().message);
+        }
+
+        std::cout << "\nCompared with " << baseline.string() << ":\n"
+                  << Utilities::PerformanceResultsComparator::describe(comparison.get());
+        return comparison.get().regressed() ? 1 : 0;
     } catch (std::exception &e) {
         std::cerr << e.what() << std::endl;
+        return 1;
     }
 }
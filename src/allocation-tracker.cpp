@@ -0,0 +1,80 @@
+#include "hxl-lang/utilities/allocation-tracker.h"
+
+#include <algorithm>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace {
+    /**
+     * The counters of the current thread. They're trivial, so they can be
+     * used from ``operator new`` without initializing anything first.
+     */
+    struct ThreadCounters {
+        size_t allocations;
+        size_t bytesAllocated;
+        size_t bytesFreed;
+
+        /**
+         * Signed, as a thread can free memory allocated by another.
+         */
+        int64_t bytesInUse;
+        int64_t peakBytesInUse;
+    };
+
+    constinit thread_local ThreadCounters counters{};
+}
+
+void HXL::AllocationTracker::recordAllocation(size_t size) noexcept {
+    ++counters.allocations;
+    counters.bytesAllocated += size;
+    counters.bytesInUse += static_cast<int64_t>(size);
+    counters.peakBytesInUse = std::max(counters.peakBytesInUse, counters.bytesInUse);
+}
+
+void HXL::AllocationTracker::recordDeallocation(size_t size) noexcept {
+    counters.bytesFreed += size;
+    counters.bytesInUse -= static_cast<int64_t>(size);
+}
+
+HXL::AllocationTracker::Snapshot HXL::AllocationTracker::start() noexcept {
+    counters.peakBytesInUse = counters.bytesInUse;
+    return {
+            .allocations = counters.allocations,
+            .bytesAllocated = counters.bytesAllocated,
+            .bytesFreed = counters.bytesFreed,
+            .bytesInUse = counters.bytesInUse,
+            .peakRss = peakRss(),
+    };
+}
+
+HXL::AllocationCounters HXL::AllocationTracker::stop(const HXL::AllocationTracker::Snapshot &snapshot) noexcept {
+    size_t bytesAllocated = counters.bytesAllocated - snapshot.bytesAllocated;
+    size_t bytesFreed = counters.bytesFreed - snapshot.bytesFreed;
+    size_t rss = peakRss();
+    return {
+            .allocations = counters.allocations - snapshot.allocations,
+            .bytesAllocated = bytesAllocated,
+            .bytesRetained = static_cast<int64_t>(bytesAllocated) - static_cast<int64_t>(bytesFreed),
+            .peakBytes = static_cast<size_t>(std::max<int64_t>(counters.peakBytesInUse - snapshot.bytesInUse, 0)),
+            .peakRssDelta = rss > snapshot.peakRss ? rss - snapshot.peakRss : 0,
+    };
+}
+
+size_t HXL::AllocationTracker::peakRss() noexcept {
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#if defined(__APPLE__)
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    // In kilobytes
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#else
+    return 0;
+#endif
+}
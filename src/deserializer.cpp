@@ -1,81 +1,808 @@
 #include "hxl-lang/services/deserializer.h"
 #include "hxl-lang/utilities/helpers.h"
+#include "hxl-lang/utilities/thread-pool.h"
+#include "hxl-lang/utilities/tracer.h"
+#include <algorithm>
+#include <array>
 #include <format>
+#include <mutex>
+#include <unordered_set>
 
 HXL::ErrorList HXL::Deserializer::deserialize(const HXL::DeserializationProtocol &protocol,
                                               const std::shared_ptr<Document> &document) {
+    return deserialize(compile(protocol), document);
+}
+
+HXL::ErrorList HXL::Deserializer::deserialize(const HXL::CompiledProtocol &protocol,
+                                              const std::shared_ptr<Document> &document) {
+    return deserialize(protocol, document, {});
+}
+
+HXL::ErrorList HXL::Deserializer::deserialize(const HXL::CompiledProtocol &protocol,
+                                              const std::shared_ptr<Document> &document,
+                                              const HXL::DeserializationOptions &options) {
+    DeserializationBuffers buffers;
+    return deserialize(protocol, document, options, buffers);
+}
+
+HXL::ErrorList HXL::Deserializer::deserialize(const HXL::CompiledProtocol &protocol,
+                                              const std::shared_ptr<Document> &document,
+                                              const HXL::DeserializationOptions &options,
+                                              HXL::DeserializationBuffers &buffers) {
+    ErrorList errors = deserializeNodes(protocol, *document, document->strings, 0, document->nodes.size(), options, buffers);
+    if (!errors.empty()) {
+        return errors;
+    }
+
+    return deserializeDeferred(protocol, document, options, buffers);
+}
+
+HXL::ErrorList HXL::Deserializer::deserializeNodes(const HXL::CompiledProtocol &protocol,
+                                                   const HXL::Document &document,
+                                                   std::string_view strings,
+                                                   size_t begin,
+                                                   size_t end,
+                                                   const HXL::DeserializationOptions &options,
+                                                   HXL::DeserializationBuffers &buffers) {
+    const std::vector<Node> &nodes = document.nodes;
+
+    // The first nodes start a new document
+    if (begin == 0) {
+        buffers.objects.clear();
+        buffers.deferred = false;
+        buffers.pendingObjects.clear();
+        buffers.deferredNodes.clear();
+    }
+
+    ErrorList errors = checkHandles(protocol, document, begin, end, buffers);
+    if (!errors.empty()) {
+        return errors;
+    }
+
+    // Objects returned by the handles, indexed like the nodes. They're bound
+    // to the references, which point to their nodes. They're released when
+    // the deserialization is done, but the buffer is kept.
+    std::vector<std::shared_ptr<void>> &objects = buffers.objects;
+    if (std::any_of(protocol.handles.begin(),
+                    protocol.handles.end(),
+                    [](const std::vector<DeserializationHandle> &handles) {
+                        return std::any_of(handles.begin(), handles.end(), [](const DeserializationHandle &handle) {
+                            return handle.objectHandle || handle.bindObjectHandle;
+                        });
+                    })) {
+        objects.resize(std::max(objects.size(), end));
+    }
+    std::vector<bool> &pendingObjects = buffers.pendingObjects;
+    std::vector<bool> &deferredNodes = buffers.deferredNodes;
+    pendingObjects.resize(std::max(pendingObjects.size(), end), false);
+    deferredNodes.resize(std::max(deferredNodes.size(), end), false);
+
+    // Buffers which node views are assembled in. They're shared by all nodes,
+    // so views can be handed out without allocating anything per node.
+    size_t maxSlots = 0;
+    for (const auto &slots: protocol.slots) {
+        maxSlots = std::max(maxSlots, slots.size());
+    }
+    std::vector<const DeserializedValue *> &slotValues = buffers.slotValues;
+    std::vector<const NodeProperty *> &slotProperties = buffers.slotProperties;
+    std::vector<DeserializedValue> &converted = buffers.converted;
+    slotValues.resize(std::max(slotValues.size(), maxSlots));
+    slotProperties.resize(std::max(slotProperties.size(), maxSlots));
+    converted.resize(std::max(converted.size(), maxSlots));
+
+    // ... And now for the execution of the handles. First, the sequential ones in
+    // document order. As nodes can only reference nodes declared before them,
+    // that's also the order of their dependencies. Unless a node references an
+    // object which a deferred handle creates, then its sequential handles are
+    // deferred as well, to run after that handle.
+    auto referencesPending = [&](const NodeProperty &nodeProperty) {
+        const NodeRef *ref = nodeProperty.value.has_value() ? std::get_if<NodeRef>(&nodeProperty.value.value()) : nullptr;
+        return ref && ref->index.has_value() && ref->index.value() < pendingObjects.size() && pendingObjects[ref->index.value()];
+    };
+    for (size_t i = begin; i < end; ++i) {
+        if (options.stopToken.stop_requested()) {
+            return {{ErrorCode::HXL_CANCELLED, "Processing was cancelled."}};
+        }
+
+        const Node &node = nodes[i];
+        TypeId typeId = resolveType(protocol, node).value();
+        bool dependsOnDeferred = buffers.deferred && !objects.empty() &&
+                                 std::any_of(node.properties.begin(), node.properties.end(), referencesPending);
+
+        for (const DeserializationHandle &handle: protocol.handles[typeId]) {
+            if (handle.batchHandle || (options.pool && handle.concurrency != HandleConcurrency::Sequential)) {
+                buffers.deferred = true;
+                if (handle.objectHandle) {
+                    pendingObjects[i] = true;
+                }
+            } else if (dependsOnDeferred) {
+                buffers.deferred = true;
+                deferredNodes[i] = true;
+                if (handle.objectHandle) {
+                    pendingObjects[i] = true;
+                }
+            } else if (handle.objectHandle || handle.viewHandle) {
+                size_t slotCount = protocol.slots[typeId].size();
+                DeserializedNodeView view = generateView(protocol,
+                                                         typeId,
+                                                         document,
+                                                         node,
+                                                         strings,
+                                                         options.stringViews,
+                                                         isBound(handle),
+                                                         {slotValues.data(), slotCount},
+                                                         {slotProperties.data(), slotCount},
+                                                         {converted.data(), slotCount},
+                                                         objects);
+                if (handle.objectHandle) {
+                    objects[i] = handle.objectHandle(view);
+                } else {
+                    handle.viewHandle(view);
+                }
+            } else if (handle.handle) {
+                handle.handle(generateNode(node, strings, options.stringViews, objects));
+            }
+        }
+    }
+
+    return errors;
+}
+
+HXL::ErrorList HXL::Deserializer::checkHandles(const HXL::CompiledProtocol &protocol,
+                                               const HXL::Document &document,
+                                               size_t begin,
+                                               size_t end,
+                                               HXL::DeserializationBuffers &buffers) {
     ErrorList errors;
+    const std::vector<Node> &nodes = document.nodes;
 
     // Before we start executing handles, we need to verify that all of them are present.
     // This needs to be done in a separate loop, before processing, otherwise we risk
     // that some processing takes place, before we're sure we can even finish.
-    for (const Node &node: document->nodes) {
-        auto it = std::find_if(protocol.handles.begin(),
-                               protocol.handles.end(),
-                               [&](const DeserializationHandle &handle) -> bool {
-                                   return handle.nodeType == node.type;
-                               });
+    // Each distinct node type only needs to be checked once.
+    std::vector<bool> &checked = buffers.checked;
+    checked.assign(protocol.handles.size(), false);
+    std::unordered_set<std::string> unknownTypes;
+    for (size_t i = begin; i < end; ++i) {
+        const Node &node = nodes[i];
+        std::optional<TypeId> typeId = resolveType(protocol, node);
 
-        if (it == protocol.handles.end()) {
-            errors.push_back({ErrorCode::HXL_CANNOT_DESERIALIZE_NODE,
-                              std::format("Missing deserializer for: {}", node.type)});
+        if (!typeId.has_value()) {
+            if (unknownTypes.insert(node.type).second) {
+                errors.push_back({ErrorCode::HXL_CANNOT_DESERIALIZE_NODE,
+                                  std::format("Missing deserializer for: {}", node.type)});
+            }
+        } else if (!checked[typeId.value()]) {
+            checked[typeId.value()] = true;
+            const std::vector<DeserializationHandle> &handles = protocol.handles[typeId.value()];
+            if (handles.empty()) {
+                errors.push_back({ErrorCode::HXL_CANNOT_DESERIALIZE_NODE,
+                                  std::format("Missing deserializer for: {}", node.type)});
+            } else if (std::any_of(handles.begin(), handles.end(), [](const DeserializationHandle &handle) {
+                           return countCallbacks(handle) == 0;
+                       })) {
+                errors.push_back({ErrorCode::HXL_AMBIGUOUS_HANDLE,
+                                  std::format("Handle for {} must set exactly one callback", node.type)});
+            } else if (!protocol.sharesSchemaIds && std::any_of(handles.begin(),
+                                                                handles.end(),
+                                                                [](const DeserializationHandle &handle) {
+                                                                    return handle.viewHandle || handle.bindViewHandle ||
+                                                                           handle.objectHandle || handle.bindObjectHandle ||
+                                                                           handle.batchHandle;
+                                                                })) {
+                errors.push_back({ErrorCode::HXL_CANNOT_DESERIALIZE_NODE,
+                                  std::format("View handle for {} requires a protocol compiled with a schema", node.type)});
+            } else if (protocol.sharesSchemaIds) {
+                for (const DeserializationHandle &handle: handles) {
+                    for (const std::string &property: handle.boundProperties) {
+                        if (!protocol.slots[typeId.value()].contains(property)) {
+                            errors.push_back({ErrorCode::HXL_UNDECLARED_BOUND_PROPERTY,
+                                              std::format("Bound property {} is not declared on {}", property, node.type)});
+                        }
+                    }
+                }
+            }
         }
     }
 
-    if (!errors.empty()) {
-        return errors;
+    return errors;
+}
+
+HXL::ErrorList HXL::Deserializer::deserializeDeferred(const HXL::CompiledProtocol &protocol,
+                                                      const std::shared_ptr<Document> &document,
+                                                      const HXL::DeserializationOptions &options,
+                                                      HXL::DeserializationBuffers &buffers) {
+    std::vector<std::shared_ptr<void>> &objects = buffers.objects;
+    if (!buffers.deferred) {
+        objects.clear();
+        return {};
     }
 
-    // ... And now for the execution of the handles.
-    for (const Node &node: document->nodes) {
-        std::for_each(protocol.handles.begin(),
-                      protocol.handles.end(),
-                      [&](const DeserializationHandle &handle) {
-                          if (handle.nodeType == node.type) {
-                              handle.handle(generateNode(node));
-                          }
-                      });
+    auto runsOnPool = [&](const DeserializationHandle &handle) {
+        return options.pool && handle.concurrency != HandleConcurrency::Sequential;
+    };
+
+    // Then the batch handles and the handles which run on the pool. The nodes
+    // are grouped by type, and the types are handled level by level, so the
+    // types that are referenced are completed first.
+    TypeGroups groups = groupByType(protocol, document);
+    ChunkBuffers chunkBuffers;
+    std::vector<size_t> deferredIndices;
+    for (const std::vector<TypeId> &level: groups.levels) {
+        std::optional<TaskGroup> tasks;
+        if (options.pool) {
+            tasks.emplace(*options.pool);
+            schedule(protocol, document, groups, level, options, objects, tasks.value());
+        }
+
+        for (TypeId typeId: level) {
+            for (const DeserializationHandle &handle: protocol.handles[typeId]) {
+                if (handle.batchHandle && !runsOnPool(handle)) {
+                    runInOrder(protocol, handle, typeId, *document, groups.of(typeId), options, objects, chunkBuffers,
+                               groups.referencesOwnType[typeId]);
+                }
+            }
+
+            // The sequential handles of the nodes which had to wait for the
+            // objects of the levels before this one
+            deferredIndices.clear();
+            for (size_t index: groups.of(typeId)) {
+                if (buffers.deferredNodes[index]) {
+                    deferredIndices.push_back(index);
+                }
+            }
+            if (deferredIndices.empty()) {
+                continue;
+            }
+            for (const DeserializationHandle &handle: protocol.handles[typeId]) {
+                if (!handle.batchHandle && !runsOnPool(handle)) {
+                    runInOrder(protocol, handle, typeId, *document, deferredIndices, options, objects, chunkBuffers,
+                               groups.referencesOwnType[typeId]);
+                }
+            }
+        }
+
+        if (tasks.has_value()) {
+            tasks->wait();
+        }
     }
 
-    return errors;
+    objects.clear();
+    buffers.deferred = false;
+
+    // The handles skip the nodes left, once a stop is requested
+    if (options.stopToken.stop_requested()) {
+        return {{ErrorCode::HXL_CANCELLED, "Processing was cancelled."}};
+    }
+    return {};
+}
+
+HXL::Deserializer::TypeGroups HXL::Deserializer::groupByType(const HXL::CompiledProtocol &protocol,
+                                                             const std::shared_ptr<Document> &document) {
+    const std::vector<Node> &nodes = document->nodes;
+    size_t typeCount = protocol.handles.size();
+
+    // Group the nodes by type with a counting sort, which keeps the nodes
+    // of each type in document order. ``offsets[t]`` to ``offsets[t + 1]``
+    // is the range of type ``t`` in ``nodes``.
+    TypeGroups groups{
+            .nodes = std::vector<size_t>(nodes.size()),
+            .offsets = std::vector<size_t>(typeCount + 1, 0),
+            .referencesOwnType = std::vector<bool>(typeCount, false),
+    };
+    std::vector<TypeId> typeIds(nodes.size());
+    std::vector<TypeId> order;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        typeIds[i] = resolveType(protocol, nodes[i]).value();
+        if (groups.offsets[typeIds[i] + 1]++ == 0) {
+            order.push_back(typeIds[i]);
+        }
+    }
+    for (size_t t = 1; t < groups.offsets.size(); ++t) {
+        groups.offsets[t] += groups.offsets[t - 1];
+    }
+    std::vector<size_t> cursor(groups.offsets.begin(), groups.offsets.end() - 1);
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        groups.nodes[cursor[typeIds[i]]++] = i;
+    }
+
+    // Which types reference which (through resolved references)
+    std::vector<std::vector<TypeId>> dependencies(typeCount);
+    std::unordered_set<uint64_t> seen;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        for (const NodeProperty &nodeProperty: nodes[i].properties) {
+            const NodeRef *ref = nodeProperty.value.has_value() ? std::get_if<NodeRef>(&nodeProperty.value.value()) : nullptr;
+            if (!ref || !ref->index.has_value() || ref->index.value() >= nodes.size()) {
+                continue;
+            }
+
+            TypeId dependency = typeIds[ref->index.value()];
+            if (dependency == typeIds[i]) {
+                groups.referencesOwnType[dependency] = true;
+            } else if (seen.insert((static_cast<uint64_t>(typeIds[i]) << 32) | dependency).second) {
+                dependencies[typeIds[i]].push_back(dependency);
+            }
+        }
+    }
+
+    // Assign each type to the level after its deepest dependency. Types which
+    // depend on each other in a cycle are left, and get a level of their own.
+    std::vector<std::optional<size_t>> levelOf(typeCount);
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        for (TypeId typeId: order) {
+            if (levelOf[typeId].has_value()) {
+                continue;
+            }
+
+            size_t level = 0;
+            bool resolved = true;
+            for (TypeId dependency: dependencies[typeId]) {
+                if (!levelOf[dependency].has_value()) {
+                    resolved = false;
+                    break;
+                }
+                level = std::max(level, levelOf[dependency].value() + 1);
+            }
+
+            if (resolved) {
+                levelOf[typeId] = level;
+                if (groups.levels.size() <= level) {
+                    groups.levels.resize(level + 1);
+                }
+                groups.levels[level].push_back(typeId);
+                progress = true;
+            }
+        }
+    }
+    for (TypeId typeId: order) {
+        if (!levelOf[typeId].has_value()) {
+            groups.levels.push_back({typeId});
+        }
+    }
+
+    return groups;
 }
 
-HXL::DeserializedNode HXL::Deserializer::generateNode(const HXL::Node &node) {
+void HXL::Deserializer::schedule(const HXL::CompiledProtocol &protocol,
+                                 const std::shared_ptr<Document> &document,
+                                 const HXL::Deserializer::TypeGroups &groups,
+                                 const std::vector<TypeId> &level,
+                                 const HXL::DeserializationOptions &options,
+                                 std::vector<std::shared_ptr<void>> &objects,
+                                 HXL::TaskGroup &tasks) {
+    const Document &source = *document;
+
+    for (TypeId typeId: level) {
+        std::span<const size_t> indices = groups.of(typeId);
+
+        // A type which references itself must be handled in document order,
+        // so its references are bound to objects which are completed. All its
+        // handles on the pool therefore run in a single task.
+        if (groups.referencesOwnType[typeId] && !objects.empty()) {
+            tasks.run([&, typeId, indices]() {
+                ChunkBuffers buffers;
+                for (const DeserializationHandle &handle: protocol.handles[typeId]) {
+                    if (handle.concurrency != HandleConcurrency::Sequential) {
+                        runInOrder(protocol, handle, typeId, source, indices, options, objects, buffers, groups.referencesOwnType[typeId]);
+                    }
+                }
+            });
+            continue;
+        }
+
+        for (const DeserializationHandle &handle: protocol.handles[typeId]) {
+            if (handle.concurrency == HandleConcurrency::PerType) {
+                tasks.run([&, typeId, indices]() {
+                    ChunkBuffers buffers;
+                    runInOrder(protocol, handle, typeId, source, indices, options, objects, buffers, groups.referencesOwnType[typeId]);
+                });
+            }
+
+            if (handle.concurrency != HandleConcurrency::ThreadSafe) {
+                continue;
+            }
+
+            size_t chunkSize = std::max<size_t>(chunkSizeOf(handle, options, indices.size()), 1);
+            size_t chunkCount = (indices.size() + chunkSize - 1) / chunkSize;
+            auto chunk = [indices, chunkSize](size_t index) {
+                return indices.subspan(index * chunkSize, std::min(chunkSize, indices.size() - index * chunkSize));
+            };
+
+            if (!options.orderedCommit) {
+                for (size_t i = 0; i < chunkCount; ++i) {
+                    tasks.run([&, typeId, chunk, i]() {
+                        ChunkBuffers buffers;
+                        prepareChunk(protocol, handle, typeId, source, chunk(i), options, objects, buffers);
+                        commitChunk(handle, buffers, chunk(i), objects, options.stopToken);
+                    });
+                }
+                continue;
+            }
+
+            // Chunks are prepared in parallel, but committed in order. Whichever
+            // task finds the next chunk ready, commits it and any ready chunks
+            // following it, so no task ever blocks waiting for its turn.
+            struct OrderedCommit {
+                std::mutex mutex;
+                std::vector<ChunkBuffers> chunks;
+                std::vector<bool> ready;
+                size_t next = 0;
+                bool committing = false;
+            };
+            auto state = std::make_shared<OrderedCommit>();
+            state->chunks.resize(chunkCount);
+            state->ready.resize(chunkCount, false);
+
+            for (size_t i = 0; i < chunkCount; ++i) {
+                tasks.run([&, typeId, chunk, i, state, chunkCount]() {
+                    prepareChunk(protocol, handle, typeId, source, chunk(i), options, objects, state->chunks[i]);
+
+                    std::unique_lock<std::mutex> lock(state->mutex);
+                    state->ready[i] = true;
+                    if (state->committing) {
+                        return;
+                    }
+                    state->committing = true;
+                    while (state->next < chunkCount && state->ready[state->next]) {
+                        size_t committed = state->next;
+                        lock.unlock();
+                        commitChunk(handle, state->chunks[committed], chunk(committed), objects, options.stopToken);
+                        state->chunks[committed] = {};
+                        lock.lock();
+                        ++state->next;
+                    }
+                    state->committing = false;
+                });
+            }
+        }
+    }
+}
+
+void HXL::Deserializer::runInOrder(const HXL::CompiledProtocol &protocol,
+                                   const HXL::DeserializationHandle &handle,
+                                   HXL::TypeId typeId,
+                                   const HXL::Document &document,
+                                   std::span<const size_t> indices,
+                                   const HXL::DeserializationOptions &options,
+                                   std::vector<std::shared_ptr<void>> &objects,
+                                   HXL::Deserializer::ChunkBuffers &buffers,
+                                   bool referencesOwnType) {
+    // The references of a chunk are bound when it's prepared, so a node
+    // referencing an object the same handle creates needs it committed first
+    size_t chunkSize = referencesOwnType && handle.objectHandle && !handle.batchHandle
+                               ? 1
+                               : std::max<size_t>(chunkSizeOf(handle, options, indices.size()), 1);
+    for (size_t start = 0; start < indices.size(); start += chunkSize) {
+        if (options.stopToken.stop_requested()) {
+            return;
+        }
+        std::span<const size_t> chunk = indices.subspan(start, std::min(chunkSize, indices.size() - start));
+        prepareChunk(protocol, handle, typeId, document, chunk, options, objects, buffers);
+        commitChunk(handle, buffers, chunk, objects, options.stopToken);
+    }
+}
+
+size_t HXL::Deserializer::countCallbacks(const HXL::DeserializationHandle &handle) {
+    std::array<bool, 6> callbacks{
+            static_cast<bool>(handle.handle),
+            static_cast<bool>(handle.viewHandle),
+            static_cast<bool>(handle.bindViewHandle),
+            static_cast<bool>(handle.objectHandle),
+            static_cast<bool>(handle.bindObjectHandle),
+            static_cast<bool>(handle.batchHandle),
+    };
+    return std::count(callbacks.begin(), callbacks.end(), true);
+}
+
+bool HXL::Deserializer::isBound(const HXL::DeserializationHandle &handle) {
+    return (handle.bindObjectHandle && handle.objectHandle) || (handle.bindViewHandle && handle.viewHandle);
+}
+
+size_t HXL::Deserializer::chunkSizeOf(const HXL::DeserializationHandle &handle,
+                                      const HXL::DeserializationOptions &options,
+                                      size_t count) {
+    if (handle.batchHandle) {
+        return handle.batchSize > 0 ? handle.batchSize : count;
+    }
+    return options.chunkSize;
+}
+
+void HXL::Deserializer::prepareChunk(const HXL::CompiledProtocol &protocol,
+                                     const HXL::DeserializationHandle &handle,
+                                     HXL::TypeId typeId,
+                                     const HXL::Document &document,
+                                     std::span<const size_t> indices,
+                                     const HXL::DeserializationOptions &options,
+                                     const std::vector<std::shared_ptr<void>> &objects,
+                                     HXL::Deserializer::ChunkBuffers &buffers) {
+    HXL_TRACE_SPAN(handle.nodeType, "prepare");
+    if (!handle.batchHandle && !handle.objectHandle && !handle.viewHandle) {
+        buffers.nodes.clear();
+        for (size_t index: indices) {
+            buffers.nodes.push_back(generateNode(document.nodes[index], document.strings, options.stringViews, objects));
+        }
+        return;
+    }
+
+    // The buffers only grow, so they're re-used between chunks
+    size_t slotCount = protocol.slots[typeId].size();
+    buffers.views.resize(std::max(buffers.views.size(), indices.size()));
+    buffers.slotValues.resize(std::max(buffers.slotValues.size(), indices.size() * slotCount));
+    buffers.slotProperties.resize(std::max(buffers.slotProperties.size(), indices.size() * slotCount));
+    buffers.converted.resize(std::max(buffers.converted.size(), indices.size() * slotCount));
+
+    for (size_t i = 0; i < indices.size(); ++i) {
+        buffers.views[i] = generateView(protocol,
+                                        typeId,
+                                        document,
+                                        document.nodes[indices[i]],
+                                        document.strings,
+                                        options.stringViews,
+                                        isBound(handle),
+                                        {buffers.slotValues.data() + i * slotCount, slotCount},
+                                        {buffers.slotProperties.data() + i * slotCount, slotCount},
+                                        {buffers.converted.data() + i * slotCount, slotCount},
+                                        objects);
+    }
+}
+
+void HXL::Deserializer::commitChunk(const HXL::DeserializationHandle &handle,
+                                    const HXL::Deserializer::ChunkBuffers &buffers,
+                                    std::span<const size_t> indices,
+                                    std::vector<std::shared_ptr<void>> &objects,
+                                    const std::stop_token &stopToken) {
+    HXL_TRACE_SPAN(handle.nodeType, "handle");
+    if (stopToken.stop_requested()) {
+        return;
+    }
+
+    if (handle.batchHandle) {
+        handle.batchHandle(std::span<const DeserializedNodeView>(buffers.views.data(), indices.size()));
+    } else if (handle.objectHandle) {
+        for (size_t i = 0; i < indices.size() && !stopToken.stop_requested(); ++i) {
+            objects[indices[i]] = handle.objectHandle(buffers.views[i]);
+        }
+    } else if (handle.viewHandle) {
+        for (size_t i = 0; i < indices.size() && !stopToken.stop_requested(); ++i) {
+            handle.viewHandle(buffers.views[i]);
+        }
+    } else if (handle.handle) {
+        for (size_t i = 0; i < buffers.nodes.size() && !stopToken.stop_requested(); ++i) {
+            handle.handle(buffers.nodes[i]);
+        }
+    }
+}
+
+HXL::CompiledProtocol HXL::Deserializer::compile(const HXL::DeserializationProtocol &protocol) {
+    CompiledProtocol compiled;
+
+    for (const DeserializationHandle &handle: protocol.handles) {
+        auto [it, inserted] = compiled.typeIds.emplace(handle.nodeType, compiled.handles.size());
+        if (inserted) {
+            compiled.handles.emplace_back();
+        }
+        DeserializationHandle &added = compiled.handles[it->second].emplace_back(handle);
+        if (countCallbacks(handle) > 1) {
+            added = DeserializationHandle{handle.nodeType};
+        }
+    }
+
+    return compiled;
+}
+
+HXL::CompiledProtocol HXL::Deserializer::compile(const HXL::DeserializationProtocol &protocol,
+                                                 const HXL::CompiledSchema &schema) {
+    CompiledProtocol compiled{
+            .handles = std::vector<std::vector<DeserializationHandle>>(schema.schema.types.size()),
+            .typeIds = schema.typeIds,
+            .slots = schema.slots,
+            .sharesSchemaIds = true,
+    };
+
+    for (const DeserializationHandle &handle: protocol.handles) {
+        std::optional<TypeId> typeId = schema.findType(handle.nodeType);
+        if (!typeId.has_value()) {
+            continue;
+        }
+
+        // Handles with several callbacks are ambiguous, so they're added without
+        // any. Handles binding properties which aren't declared are left unbound.
+        // Both are reported by ``checkHandles``.
+        DeserializationHandle &added = compiled.handles[typeId.value()].emplace_back(handle);
+        if (countCallbacks(handle) > 1) {
+            added = DeserializationHandle{handle.nodeType};
+            continue;
+        }
+        const std::unordered_map<std::string, SlotId> &slots = schema.slots[typeId.value()];
+        if (std::any_of(added.boundProperties.begin(),
+                        added.boundProperties.end(),
+                        [&](const std::string &property) { return !slots.contains(property); })) {
+            continue;
+        }
+        if (added.bindViewHandle) {
+            added.viewHandle = added.bindViewHandle(slots);
+        }
+        if (added.bindObjectHandle) {
+            added.objectHandle = added.bindObjectHandle(slots);
+        }
+    }
+
+    return compiled;
+}
+
+std::optional<HXL::TypeId> HXL::Deserializer::resolveType(const HXL::CompiledProtocol &protocol,
+                                                          const HXL::Node &node) {
+    if (protocol.sharesSchemaIds && node.typeId.has_value()) {
+        return node.typeId;
+    }
+
+    auto it = protocol.typeIds.find(node.type);
+    if (it == protocol.typeIds.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+HXL::DeserializedNodeView HXL::Deserializer::generateView(const HXL::CompiledProtocol &protocol,
+                                                          HXL::TypeId typeId,
+                                                          const HXL::Document &document,
+                                                          const HXL::Node &node,
+                                                          std::string_view strings,
+                                                          bool stringViews,
+                                                          bool bound,
+                                                          std::span<const DeserializedValue *> slotValues,
+                                                          std::span<const NodeProperty *> slotProperties,
+                                                          std::span<DeserializedValue> converted,
+                                                          const std::vector<std::shared_ptr<void>> &objects) {
+    const std::unordered_map<std::string, SlotId> &slots = protocol.slots[typeId];
+    std::fill(slotValues.begin(), slotValues.end(), nullptr);
+    std::fill(slotProperties.begin(), slotProperties.end(), nullptr);
+
+    for (const NodeProperty &nodeProperty: node.properties) {
+        std::optional<SlotId> slot = nodeProperty.slot;
+        if (!slot.has_value()) {
+            auto it = slots.find(nodeProperty.name);
+            if (it == slots.end()) {
+                continue;
+            }
+            slot = it->second;
+        }
+        slotProperties[slot.value()] = &nodeProperty;
+
+        // Values which haven't been converted by the schema validation
+        // are converted into the shared buffer, as are references which
+        // are bound to an object. Bound handles read the unconverted
+        // values from the properties, so they're left out for them.
+        if (nodeProperty.value.has_value()) {
+            std::optional<NodeRef> ref = bindReference(nodeProperty.value.value(), objects);
+            if (ref.has_value()) {
+                converted[slot.value()] = std::move(ref.value());
+                slotValues[slot.value()] = &converted[slot.value()];
+            } else {
+                slotValues[slot.value()] = &nodeProperty.value.value();
+            }
+        } else if (!bound) {
+            converted[slot.value()] = toValue(nodeProperty, strings, stringViews);
+            slotValues[slot.value()] = &converted[slot.value()];
+        }
+    }
+
+    return {
+            .typeId = typeId,
+            .name = node.name,
+            .values = slotValues,
+            .properties = slotProperties,
+            .document = &document,
+    };
+}
+
+std::optional<HXL::NodeRef> HXL::Deserializer::bindReference(const HXL::DeserializedValue &value,
+                                                              const std::vector<std::shared_ptr<void>> &objects) {
+    const NodeRef *ref = objects.empty() ? nullptr : std::get_if<NodeRef>(&value);
+    if (!ref || !ref->index.has_value() || ref->index.value() >= objects.size()) {
+        return std::nullopt;
+    }
+
+    return NodeRef{
+            .references = ref->references,
+            .index = ref->index,
+            .object = objects[ref->index.value()],
+    };
+}
+
+HXL::DeserializedNode HXL::Deserializer::deserializeNode(const HXL::Document &document, size_t index) {
+    return generateNode(document.nodes[index], document.strings, false, {});
+}
+
+HXL::DeserializedNode HXL::Deserializer::generateNode(const HXL::Node &node,
+                                                      std::string_view strings,
+                                                      bool stringViews,
+                                                      const std::vector<std::shared_ptr<void>> &objects) {
     DeserializedNode result {
             .name = node.name,
     };
 
     for (const NodeProperty &nodeProperty: node.properties) {
-        result.properties[nodeProperty.name].value = toValue(nodeProperty);
+        // Values which have passed schema validation are already converted.
+        // Only documents which skipped that stage are interpreted here.
+        DeserializedValue &value = result.properties[nodeProperty.name].value;
+        if (!nodeProperty.value.has_value()) {
+            value = toValue(nodeProperty, strings, stringViews);
+        } else if (std::optional<NodeRef> ref = bindReference(nodeProperty.value.value(), objects)) {
+            value = std::move(ref.value());
+        } else {
+            value = nodeProperty.value.value();
+        }
     }
 
     return result;
 }
 
-HXL::DeserializedValue HXL::Deserializer::toValue(const HXL::NodeProperty &nodeProperty) {
-    if (nodeProperty.values.size() > 1) {
+HXL::DeserializedValue HXL::Deserializer::toValue(const HXL::NodeProperty &nodeProperty,
+                                                  std::string_view strings,
+                                                  bool stringViews) {
+    auto text = [&](const PropertyScalar &scalar) {
+        return strings.substr(scalar.string.offset, scalar.string.length);
+    };
+
+    bool isArray = nodeProperty.structure == ValueStructure::Array;
+    if (nodeProperty.dataType == DataType::String && isArray) {
+        if (stringViews) {
+            std::vector<std::string_view> result;
+            result.reserve(nodeProperty.values.size());
+            for (const PropertyScalar &scalar: nodeProperty.values) {
+                result.push_back(text(scalar));
+            }
+            return result;
+        }
+
+        std::vector<std::string> result;
+        result.reserve(nodeProperty.values.size());
+        for (const PropertyScalar &scalar: nodeProperty.values) {
+            result.emplace_back(text(scalar));
+        }
+        return result;
+    }
+
+    if (isArray) {
         switch (nodeProperty.dataType) {
-            case DataType::Int:
-                return Helpers::toArray<int>(nodeProperty.values);
-            case DataType::Float:
-                return Helpers::toArray<float>(nodeProperty.values);
-            case DataType::String:
-                return Helpers::toArray<std::string>(nodeProperty.values);
+            case DataType::Int: {
+                std::vector<int> result;
+                result.reserve(nodeProperty.values.size());
+                for (const PropertyScalar &scalar: nodeProperty.values) {
+                    result.push_back(scalar.integer);
+                }
+                return result;
+            }
+            case DataType::Float: {
+                std::vector<float> result;
+                result.reserve(nodeProperty.values.size());
+                for (const PropertyScalar &scalar: nodeProperty.values) {
+                    result.push_back(scalar.real);
+                }
+                return result;
+            }
             default:
                 throw std::runtime_error("Data type not allowed in arrays.");
         }
     }
 
+    const PropertyScalar &value = nodeProperty.values[0];
     switch (nodeProperty.dataType) {
         case DataType::Bool:
-            return nodeProperty.values[0] == "true";
+            return value.boolean;
         case DataType::Float:
-            return std::stof(nodeProperty.values[0]);
+            return value.real;
         case DataType::Int:
-            return std::stoi(nodeProperty.values[0]);
+            return value.integer;
         case DataType::NodeRef:
-            return NodeRef{nodeProperty.values[0]};
+            return NodeRef{std::string(text(value))};
         default:
-            return nodeProperty.values[0];
+            if (stringViews) {
+                return text(value);
+            }
+            return std::string(text(value));
     }
 }
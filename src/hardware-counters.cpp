@@ -0,0 +1,162 @@
+#include "hxl-lang/utilities/hardware-counters.h"
+
+#include <iterator>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+#if defined(__linux__)
+    /**
+     * The events, in the order of ``HardwareCounters``. The first leads the
+     * group, so all of them are scheduled onto the CPU together.
+     */
+    constexpr uint64_t events[] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES,
+    };
+
+    constexpr size_t eventCount = std::size(events);
+
+    /**
+     * The counters of a thread, opened on first use.
+     */
+    class CounterGroup {
+    public:
+        CounterGroup() {
+            for (size_t i = 0; i < eventCount; ++i) {
+                perf_event_attr attributes{};
+                attributes.type = PERF_TYPE_HARDWARE;
+                attributes.size = sizeof(perf_event_attr);
+                attributes.config = events[i];
+                attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+                // The kernel and hypervisor are excluded, as that's all an
+                // unprivileged process is allowed to count
+                attributes.exclude_kernel = 1;
+                attributes.exclude_hv = 1;
+
+                int leader = i == 0 ? -1 : descriptors[0];
+                descriptors[i] = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, leader, PERF_FLAG_FD_CLOEXEC));
+                if (descriptors[i] < 0) {
+                    close();
+                    return;
+                }
+            }
+        }
+
+        ~CounterGroup() {
+            close();
+        }
+
+        CounterGroup(const CounterGroup &) = delete;
+
+        CounterGroup &operator=(const CounterGroup &) = delete;
+
+        [[nodiscard]] bool isOpen() const {
+            return descriptors[0] >= 0;
+        }
+
+        /**
+         * Read the counters of the group, scaled up by the share of the time
+         * they were scheduled, if the CPU had to share them with other groups.
+         *
+         * @param counters
+         * @return Whether they could be read
+         */
+        bool read(HXL::HardwareCounters &counters) const {
+            struct {
+                uint64_t count;
+                uint64_t timeEnabled;
+                uint64_t timeRunning;
+                uint64_t values[eventCount];
+            } buffer{};
+
+            if (!isOpen() || ::read(descriptors[0], &buffer, sizeof(buffer)) != sizeof(buffer)) {
+                return false;
+            }
+            if (buffer.count != eventCount || buffer.timeRunning == 0) {
+                return false;
+            }
+
+            double scale = static_cast<double>(buffer.timeEnabled) / static_cast<double>(buffer.timeRunning);
+            auto scaled = [&](size_t i) {
+                return buffer.timeEnabled == buffer.timeRunning
+                               ? buffer.values[i]
+                               : static_cast<uint64_t>(static_cast<double>(buffer.values[i]) * scale);
+            };
+            counters = {
+                    .cycles = scaled(0),
+                    .instructions = scaled(1),
+                    .cacheMisses = scaled(2),
+                    .branchMisses = scaled(3),
+            };
+            return true;
+        }
+
+    private:
+        int descriptors[eventCount] = {-1, -1, -1, -1};
+
+        void close() {
+            for (int &descriptor: descriptors) {
+                if (descriptor >= 0) {
+                    ::close(descriptor);
+                    descriptor = -1;
+                }
+            }
+        }
+    };
+
+    const CounterGroup &group() {
+        thread_local CounterGroup counters;
+        return counters;
+    }
+#endif
+}
+
+HXL::HardwareCounterReader::Snapshot HXL::HardwareCounterReader::start() noexcept {
+    Snapshot snapshot{.available = false, .counters = {}};
+#if defined(__linux__)
+    snapshot.available = group().read(snapshot.counters);
+#endif
+    return snapshot;
+}
+
+std::optional<HXL::HardwareCounters> HXL::HardwareCounterReader::stop(const HXL::HardwareCounterReader::Snapshot &snapshot) noexcept {
+    if (!snapshot.available) {
+        return std::nullopt;
+    }
+
+#if defined(__linux__)
+    HardwareCounters counters;
+    if (!group().read(counters)) {
+        return std::nullopt;
+    }
+
+    // Scaled counts may go back a little, as the share they're scaled by changes
+    auto delta = [](uint64_t end, uint64_t begin) {
+        return end > begin ? end - begin : 0;
+    };
+    return HardwareCounters{
+            .cycles = delta(counters.cycles, snapshot.counters.cycles),
+            .instructions = delta(counters.instructions, snapshot.counters.instructions),
+            .cacheMisses = delta(counters.cacheMisses, snapshot.counters.cacheMisses),
+            .branchMisses = delta(counters.branchMisses, snapshot.counters.branchMisses),
+    };
+#else
+    return std::nullopt;
+#endif
+}
+
+bool HXL::HardwareCounterReader::available() noexcept {
+#if defined(__linux__)
+    return group().isOpen();
+#else
+    return false;
+#endif
+}
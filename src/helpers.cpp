@@ -1,2 +1,157 @@
 #include "hxl-lang/utilities/helpers.h"
+#include <algorithm>
+#include <format>
 
+namespace {
+    /**
+     * Parse a comma-separated list of numbers, where whitespace is
+     * allowed around the numbers, and append them to ``result``.
+     *
+     * @tparam T
+     * @param contents
+     * @param result
+     * @return False, if the list is malformed, or a number can't be represented as ``T``
+     */
+    template<typename T>
+    bool parseNumbers(std::string_view contents, std::vector<T> &result) {
+        const char *it = contents.data();
+        const char *end = contents.data() + contents.size();
+        auto skipWhitespace = [&]() {
+            while (it != end && *it == ' ') {
+                ++it;
+            }
+        };
+
+        while (true) {
+            skipWhitespace();
+            if (it == end || !((*it >= '0' && *it <= '9') || *it == '-')) {
+                return false;
+            }
+
+            T number;
+            auto [next, ec] = std::from_chars(it, end, number);
+            if (ec != std::errc()) {
+                return false;
+            }
+            result.push_back(number);
+            it = next;
+
+            skipWhitespace();
+            if (it == end) {
+                return true;
+            } else if (*it != ',') {
+                return false;
+            }
+            ++it;
+        }
+    }
+}
+
+std::optional<HXL::DeserializedValue> HXL::Helpers::parseNumericArray(std::string_view contents, HXL::DataType &dataType) {
+    // The numbers before the first one with a decimal point are integers,
+    // and are only converted to floats once it's reached, just like the
+    // values of an array which mixes them
+    size_t firstFloat = contents.find('.');
+    size_t intsEnd = firstFloat == std::string_view::npos ? contents.size() : contents.rfind(',', firstFloat);
+    size_t count = std::count(contents.begin(), contents.end(), ',') + 1;
+
+    std::vector<int> ints;
+    dataType = DataType::Int;
+    if (intsEnd != std::string_view::npos) {
+        ints.reserve(firstFloat == std::string_view::npos ? count : 0);
+        if (!parseNumbers<int>(contents.substr(0, intsEnd), ints)) {
+            return std::nullopt;
+        }
+    }
+    if (firstFloat == std::string_view::npos) {
+        return DeserializedValue(std::move(ints));
+    }
+
+    std::vector<float> floats;
+    floats.reserve(count);
+    floats.assign(ints.begin(), ints.end());
+    dataType = DataType::Float;
+    if (!parseNumbers<float>(contents.substr(intsEnd == std::string_view::npos ? 0 : intsEnd + 1), floats)) {
+        return std::nullopt;
+    }
+    return DeserializedValue(std::move(floats));
+}
+
+HXL::Result<HXL::DeserializedValue> HXL::Helpers::toValue(const HXL::NodeProperty &nodeProperty,
+                                                          HXL::DataType dataType,
+                                                          HXL::ValueStructure structure,
+                                                          std::string_view strings) {
+    auto text = [&](const PropertyScalar &scalar) {
+        return strings.substr(scalar.string.offset, scalar.string.length);
+    };
+
+    // Integers are accepted where floats are declared
+    auto toFloat = [&](const PropertyScalar &scalar) {
+        return nodeProperty.dataType == DataType::Int ? static_cast<float>(scalar.integer) : scalar.real;
+    };
+
+    if (structure == ValueStructure::Array) {
+        switch (dataType) {
+            case DataType::Int: {
+                std::vector<int> result;
+                result.reserve(nodeProperty.values.size());
+                for (const PropertyScalar &scalar: nodeProperty.values) {
+                    result.push_back(scalar.integer);
+                }
+                return DeserializedValue(std::move(result));
+            }
+            case DataType::Float: {
+                std::vector<float> result;
+                result.reserve(nodeProperty.values.size());
+                for (const PropertyScalar &scalar: nodeProperty.values) {
+                    result.push_back(toFloat(scalar));
+                }
+                return DeserializedValue(std::move(result));
+            }
+            case DataType::String: {
+                std::vector<std::string> result;
+                result.reserve(nodeProperty.values.size());
+                for (const PropertyScalar &scalar: nodeProperty.values) {
+                    result.emplace_back(text(scalar));
+                }
+                return DeserializedValue(std::move(result));
+            }
+            default:
+                return Error{
+                        .errorCode = ErrorCode::HXL_ILLEGAL_DATA_TYPE,
+                        .message = std::format("Data type not allowed in arrays: {}", toString(dataType)),
+                };
+        }
+    }
+
+    const PropertyScalar &value = nodeProperty.values[0];
+    switch (dataType) {
+        case DataType::Bool:
+            return DeserializedValue(value.boolean);
+        case DataType::Int:
+            return DeserializedValue(value.integer);
+        case DataType::Float:
+            return DeserializedValue(toFloat(value));
+        case DataType::NodeRef:
+            return DeserializedValue(NodeRef{std::string(text(value))});
+        default:
+            return DeserializedValue(std::string(text(value)));
+    }
+}
+
+std::string HXL::Helpers::toString(HXL::DataType dataType) {
+    switch (dataType) {
+        case DataType::Bool:
+            return "Bool";
+        case DataType::Float:
+            return "Float";
+        case DataType::Int:
+            return "Int";
+        case DataType::String:
+            return "String";
+        case DataType::NodeRef:
+            return "NodeRef";
+        default:
+            return std::to_string(static_cast<int>(dataType));
+    }
+}
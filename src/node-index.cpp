@@ -0,0 +1,64 @@
+#include "hxl-lang/utilities/node-index.h"
+
+#include <algorithm>
+#include <functional>
+
+void HXL::NodeIndex::clear() {
+    std::fill(entries.begin(), entries.end(), Entry{});
+    count = 0;
+}
+
+bool HXL::NodeIndex::insert(const std::vector<Node> &nodes, size_t index) {
+    if ((count + 1) * 2 > entries.size()) {
+        grow();
+    }
+
+    size_t hash = std::hash<std::string_view>{}(nodes[index].name);
+    size_t mask = entries.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        Entry &entry = entries[i];
+        if (entry.index == empty) {
+            entry = {hash, index};
+            ++count;
+            return true;
+        }
+        if (entry.hash == hash && nodes[entry.index].name == nodes[index].name) {
+            return false;
+        }
+    }
+}
+
+std::optional<size_t> HXL::NodeIndex::find(const std::vector<Node> &nodes, std::string_view name) const {
+    if (count == 0) {
+        return std::nullopt;
+    }
+
+    size_t hash = std::hash<std::string_view>{}(name);
+    size_t mask = entries.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        const Entry &entry = entries[i];
+        if (entry.index == empty) {
+            return std::nullopt;
+        }
+        if (entry.hash == hash && nodes[entry.index].name == name) {
+            return entry.index;
+        }
+    }
+}
+
+void HXL::NodeIndex::grow() {
+    std::vector<Entry> previous = std::move(entries);
+    entries.assign(std::max<size_t>(previous.size() * 2, 16), Entry{});
+
+    size_t mask = entries.size() - 1;
+    for (const Entry &entry: previous) {
+        if (entry.index == empty) {
+            continue;
+        }
+        size_t i = entry.hash & mask;
+        while (entries[i].index != empty) {
+            i = (i + 1) & mask;
+        }
+        entries[i] = entry;
+    }
+}
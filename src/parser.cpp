@@ -1,14 +1,154 @@
 #include "hxl-lang/services/parser.h"
+#include "hxl-lang/services/schema-validator.h"
+#include "hxl-lang/utilities/helpers.h"
 #include <iostream>
 
 HXL::Result<HXL::Document> HXL::Parser::parse(const std::vector<Token> &tokens) {
+    Document document;
+    NodeIndex nodeIndex;
+    NoProbes probes;
+    std::optional<Error> error = parseDocument(tokens, nullptr, document, nodeIndex, true, {}, probes);
+    if (error.has_value()) {
+        return error.value();
+    }
+    return document;
+}
+
+HXL::Result<HXL::Document> HXL::Parser::parse(const std::vector<Token> &tokens,
+                                              const HXL::CompiledSchema &schema) {
+    Document document;
+    NodeIndex nodeIndex;
+    std::optional<Error> error = parse(tokens, schema, document, nodeIndex);
+    if (error.has_value()) {
+        return error.value();
+    }
+    return document;
+}
+
+std::optional<HXL::Error> HXL::Parser::parse(const std::vector<Token> &tokens,
+                                             const HXL::CompiledSchema &schema,
+                                             HXL::Document &document,
+                                             HXL::NodeIndex &nodeIndex,
+                                             bool requireProperties,
+                                             const HXL::ResourceLimits &limits) {
+    NoProbes probes;
+    return parse(tokens, schema, document, nodeIndex, requireProperties, limits, probes);
+}
+
+template<typename Probes>
+std::optional<HXL::Error> HXL::Parser::parse(const std::vector<Token> &tokens,
+                                             const HXL::CompiledSchema &schema,
+                                             HXL::Document &document,
+                                             HXL::NodeIndex &nodeIndex,
+                                             bool requireProperties,
+                                             const HXL::ResourceLimits &limits,
+                                             Probes &probes) {
+    return parseDocument(tokens, &schema, document, nodeIndex, requireProperties, limits, probes);
+}
+
+std::optional<HXL::Error> HXL::Parser::parsePart(const std::vector<Token> &tokens,
+                                                 const HXL::CompiledSchema &schema,
+                                                 HXL::Document &document,
+                                                 HXL::NodeIndex &nodeIndex,
+                                                 bool last,
+                                                 bool requireProperties,
+                                                 const HXL::ResourceLimits &limits) {
+    NoProbes probes;
+    return parsePart(tokens, schema, document, nodeIndex, last, requireProperties, limits, probes);
+}
+
+template<typename Probes>
+std::optional<HXL::Error> HXL::Parser::parsePart(const std::vector<Token> &tokens,
+                                                 const HXL::CompiledSchema &schema,
+                                                 HXL::Document &document,
+                                                 HXL::NodeIndex &nodeIndex,
+                                                 bool last,
+                                                 bool requireProperties,
+                                                 const HXL::ResourceLimits &limits,
+                                                 Probes &probes,
+                                                 const std::stop_token &stopToken) {
+    // The nodes of the part are appended to the ones before it
+    DocumentExtent extent{.nodes = document.nodes.size(), .strings = document.strings.size()};
+    return parsePart(tokens, schema, document, extent, nodeIndex, last, requireProperties, limits, probes, stopToken);
+}
+
+template<typename Probes>
+std::optional<HXL::Error> HXL::Parser::parsePart(const std::vector<Token> &tokens,
+                                                 const HXL::CompiledSchema &schema,
+                                                 HXL::Document &document,
+                                                 HXL::DocumentExtent &extent,
+                                                 HXL::NodeIndex &nodeIndex,
+                                                 bool last,
+                                                 bool requireProperties,
+                                                 const HXL::ResourceLimits &limits,
+                                                 Probes &probes,
+                                                 const std::stop_token &stopToken) {
+    if (last) {
+        std::optional<Error> error = checkEnd(tokens);
+        if (error.has_value()) {
+            return error;
+        }
+    }
+
+    return parseNodes(tokens, &schema, document, nodeIndex, extent, requireProperties, limits, probes, stopToken);
+}
+
+std::optional<HXL::Error> HXL::Parser::checkEnd(const std::vector<Token> &tokens) {
     if (tokens.empty()) {
         return Error{.errorCode = ErrorCode::HXL_EMPTY, .message = "Source is empty."};
     } else if (tokens[tokens.size() - 1].tokenType != T::T_NEWLINE) {
         return Error{.errorCode = ErrorCode::HXL_INVALID_EOF, .message = "Source must end with an empty line."};
     }
+    return std::nullopt;
+}
 
-    std::vector<Node> nodes;
+template<typename Probes>
+std::optional<HXL::Error> HXL::Parser::parseDocument(const std::vector<Token> &tokens,
+                                                     const HXL::CompiledSchema *schema,
+                                                     HXL::Document &document,
+                                                     HXL::NodeIndex &nodeIndex,
+                                                     bool requireProperties,
+                                                     const HXL::ResourceLimits &limits,
+                                                     Probes &probes) {
+    std::optional<Error> error = checkEnd(tokens);
+    if (error.has_value()) {
+        return error;
+    }
+
+    // Storage of the string values of the document
+    document.strings.clear();
+
+    // When parsing with a schema, node names are mapped to their index,
+    // so required properties can be looked up through inheritance
+    nodeIndex.clear();
+
+    // Nodes left in the document from a previous parse are re-used,
+    // so the memory of their properties is kept. Only the first
+    // ``nodeCount`` nodes belong to this document.
+    DocumentExtent extent;
+    error = parseNodes(tokens, schema, document, nodeIndex, extent, requireProperties, limits, probes, {});
+    if (error.has_value()) {
+        return error;
+    }
+
+    document.nodes.resize(extent.nodes);
+
+    return std::nullopt;
+}
+
+template<typename Probes>
+std::optional<HXL::Error> HXL::Parser::parseNodes(const std::vector<Token> &tokens,
+                                                  const HXL::CompiledSchema *schema,
+                                                  HXL::Document &document,
+                                                  HXL::NodeIndex &nodeIndex,
+                                                  HXL::DocumentExtent &extent,
+                                                  bool requireProperties,
+                                                  const HXL::ResourceLimits &limits,
+                                                  Probes &probes,
+                                                  const std::stop_token &stopToken) {
+    std::vector<Node> &nodes = document.nodes;
+    std::string &strings = document.strings;
+    size_t &nodeCount = extent.nodes;
 
     // The index of the node we're currently working on
     // ``std::nullopt``, when not working on any nodes
@@ -55,47 +195,139 @@ HXL::Result<HXL::Document> HXL::Parser::parse(const std::vector<Token> &tokens)
     struct BuildingProperty {
         std::string key;
         PropertySpecialization specialization = PropertySpecialization::None;
-        std::vector<std::string> values;
+        PropertyValues values;
         DataType dataType;
+        SourcePosition position;
+        std::optional<SlotId> slot;
+        std::optional<DeserializedValue> value;
 
         /**
-         * Short-hand for adding values
+         * Add the value of a token, stored by its data type.
+         * Strings are written to the document's ``strings`` at ``stringsEnd``,
+         * in place if the storage is large enough, otherwise appended.
          *
-         * @param value
+         * @param token
+         * @param strings
+         * @param stringsEnd
+         * @param probes
+         * @return
          */
-        void operator+=(const Token &token) {
+        std::optional<Error> add(const Token &token, std::string &strings, size_t &stringsEnd, Probes &probes) {
             if (!token.value.has_value()) {
-                return;
+                return std::nullopt;
             }
+            const std::string &text = token.value.value();
 
-            values.push_back(token.toString());
+            DataType tokenDataType = DataType::NodeRef;
+            if (specialization != PropertySpecialization::Reference) {
+                switch (token.tokenType) {
+                    case TokenType::T_STRING_LITERAL:
+                        tokenDataType = DataType::String;
+                        break;
+                    case TokenType::T_BOOL:
+                        tokenDataType = DataType::Bool;
+                        break;
+                    case TokenType::T_INT:
+                        tokenDataType = DataType::Int;
+                        break;
+                    case TokenType::T_FLOAT:
+                        tokenDataType = DataType::Float;
+                        break;
+                    default:
+                        assert(false && "Data type mapping in parser has failed.");
+                }
+            }
 
-            if (specialization == PropertySpecialization::Reference) {
-                dataType = DataType::NodeRef;
-                return;
+            // Integers and floats can be mixed in arrays, which are then
+            // stored as floats. Other data types can't be mixed.
+            if (values.empty()) {
+                dataType = tokenDataType;
+            } else if (dataType == DataType::Int && tokenDataType == DataType::Float) {
+                for (PropertyScalar &value: values) {
+                    value.real = static_cast<float>(value.integer);
+                }
+                dataType = DataType::Float;
+            } else if (dataType != tokenDataType &&
+                       !(dataType == DataType::Float && tokenDataType == DataType::Int)) {
+                return Error{
+                        .errorCode = ErrorCode::HXL_ARRAY_MIXED_TYPES,
+                        .message = std::format("[Line {}, Col {}] Array {} mixes data types",
+                                               position.line,
+                                               position.col,
+                                               key),
+                };
             }
 
-            switch (token.tokenType) {
-                case TokenType::T_STRING_LITERAL:
-                    dataType = DataType::String;
+            // Only formatted when a number actually fails to convert
+            auto outOfRange = [&]() -> Error {
+                return {
+                        .errorCode = ErrorCode::HXL_ILLEGAL_DATA_TYPE,
+                        .message = std::format("[Line {}, Col {}] Value of property {} cannot be represented as {}",
+                                               position.line,
+                                               position.col,
+                                               key,
+                                               Helpers::toString(dataType)),
+                };
+            };
+
+            PropertyScalar scalar{};
+            switch (dataType) {
+                case DataType::Bool:
+                    scalar.boolean = text == "true";
                     break;
-                case TokenType::T_BOOL:
-                    dataType = DataType::Bool;
-                    break;
-                case TokenType::T_INT:
-                    dataType = DataType::Int;
+                case DataType::Int: {
+                    probes.record(&StageProbes::numberConversions);
+                    std::optional<int> number = Helpers::toNumber<int>(text);
+                    if (!number.has_value()) {
+                        return outOfRange();
+                    }
+                    scalar.integer = number.value();
                     break;
-                case TokenType::T_FLOAT:
-                    dataType = DataType::Float;
+                }
+                case DataType::Float: {
+                    probes.record(&StageProbes::numberConversions);
+                    std::optional<float> number = Helpers::toNumber<float>(text);
+                    if (!number.has_value()) {
+                        return outOfRange();
+                    }
+                    scalar.real = number.value();
                     break;
+                }
                 default:
-                    assert(false && "Data type mapping in parser has failed.");
+                    scalar.string = {static_cast<uint32_t>(stringsEnd), static_cast<uint32_t>(text.size())};
+                    if (stringsEnd + text.size() <= strings.size()) {
+                        std::copy(text.begin(), text.end(), strings.begin() + static_cast<std::ptrdiff_t>(stringsEnd));
+                    } else {
+                        strings.resize(stringsEnd);
+                        strings += text;
+                    }
+                    stringsEnd += text.size();
+                    probes.record(&StageProbes::stringBytes, text.size());
             }
+            values.push_back(scalar);
+
+            return std::nullopt;
         }
     };
 
     std::optional<BuildingProperty> buildingProperty;
 
+    // Short-hand for the position where a token begins
+    auto startOf = [](const Token &token, const std::string &tk) -> SourcePosition {
+        return {token.position.line, static_cast<uint16_t>(token.position.col - tk.length())};
+    };
+
+    auto arrayTooLong = [&]() -> Error {
+        return {
+                .errorCode = ErrorCode::HXL_ARRAY_TOO_LONG,
+                .message = std::format("[Line {}, Col {}] Property {} exceeds the limit of {} values",
+                                       buildingProperty->position.line,
+                                       buildingProperty->position.col,
+                                       buildingProperty->key,
+                                       limits.maxArrayLength),
+        };
+    };
+
     // In this loop, the idea is to first of all look at the current token
     // Every token type has different behavior and expectations.
     // For each token type, we check the contexts that it fits into
@@ -104,10 +336,7 @@ HXL::Result<HXL::Document> HXL::Parser::parse(const std::vector<Token> &tokens)
     for (auto it = tokens.begin(); it != tokens.end(); ++it) {
         const Token &token = *it;
         auto peekIt = std::next(it);
-        std::optional<Token> peek;
-        if (peekIt != tokens.end()) {
-            peek = *peekIt;
-        }
+        const Token *peek = peekIt != tokens.end() ? &*peekIt : nullptr;
 
         switch (token.tokenType) {
             /**
@@ -117,24 +346,31 @@ HXL::Result<HXL::Document> HXL::Parser::parse(const std::vector<Token> &tokens)
                 if (!token.value.has_value()) {
                     return unexpectedTokenError(token);
                 }
-                std::string tk = token.value.value();
+                const std::string &tk = token.value.value();
 
                 if (context == GC::AfterNodeName && tk == "<=") {
                     context = GC::Inheritance;
                 } else if (context == GC::ExpandingArray_GotValue && tk == ",") {
                     context = GC::ExpandingArray_ExpectsValue;
                 } else if (sentence == Sentence::NotDetermined && tk == "<") {
+                    // The previous node is complete, so its required properties can be checked
+                    if (schema && requireProperties && currentNode.has_value()) {
+                        std::optional<Error> error = checkRequired(*schema, nodes, nodeIndex, nodes[currentNode.value()]);
+                        if (error.has_value()) {
+                            return error.value();
+                        }
+                    }
                     context = GC::NodeType;
                     sentence = Sentence::Node;
                 } else if (context == GC::NodeType && tk == ">") {
                     context = GC::AfterNodeType;
-                    if (peek.has_value() && peek->tokenType != TokenType::T_WHITESPACE) {
-                        return unexpectedTokenError(peek.value());
+                    if (peek && peek->tokenType != TokenType::T_WHITESPACE) {
+                        return unexpectedTokenError(*peek);
                     }
                 } else if (context == GC::PropertyKey && tk == ":") {
                     context = GC::PropertyValue;
-                    if (peek.has_value() && peek->tokenType != TokenType::T_WHITESPACE) {
-                        return unexpectedTokenError(peek.value());
+                    if (peek && peek->tokenType != TokenType::T_WHITESPACE) {
+                        return unexpectedTokenError(*peek);
                     }
                 } else if (context == GC::PropertyKey && tk == "[]") {
                     buildingProperty->specialization = PropertySpecialization::Array;
@@ -155,7 +391,7 @@ HXL::Result<HXL::Document> HXL::Parser::parse(const std::vector<Token> &tokens)
                     return unexpectedTokenError(token);
                 }
 
-                std::string tk = token.value.value();
+                const std::string &tk = token.value.value();
                 if (context == GC::PropertyValue && tk != "{" &&
                     buildingProperty->specialization != PropertySpecialization::Array) {
                     return Error{
@@ -181,23 +417,103 @@ HXL::Result<HXL::Document> HXL::Parser::parse(const std::vector<Token> &tokens)
                     return unexpectedTokenError(token);
                 }
 
-                std::string tk = token.value.value();
+                const std::string &tk = token.value.value();
 
                 if (context == GC::NodeType) {
-                    nodes.push_back({tk});
-                    currentNode = nodes.size() - 1;
+                    std::optional<TypeId> typeId;
+                    if (schema) {
+                        probes.record(&StageProbes::typeLookups);
+                        typeId = schema->findType(tk);
+                        if (!typeId.has_value()) {
+                            SourcePosition pos = startOf(token, tk);
+                            return Error{
+                                    .errorCode = ErrorCode::HXL_UNKNOWN_NODE_TYPE,
+                                    .message = std::format("[Line {}, Col {}] Node type not declared in schema: {}",
+                                                           pos.line,
+                                                           pos.col,
+                                                           tk),
+                            };
+                        }
+                    }
+                    if (nodeCount == limits.maxNodes) {
+                        SourcePosition pos = startOf(token, tk);
+                        return Error{
+                                .errorCode = ErrorCode::HXL_TOO_MANY_NODES,
+                                .message = std::format("[Line {}, Col {}] Source exceeds the limit of {} nodes",
+                                                       pos.line,
+                                                       pos.col,
+                                                       limits.maxNodes),
+                        };
+                    }
+                    if (nodeCount == nodes.size()) {
+                        nodes.emplace_back();
+                    }
+                    Node &node = nodes[nodeCount];
+                    node.type = tk;
+                    node.name.clear();
+                    node.properties.clear();
+                    node.inheritance.reset();
+                    node.position = startOf(token, tk);
+                    node.typeId = typeId;
+                    currentNode = nodeCount++;
                 } else if (context == GC::Inheritance) {
                     nodes[currentNode.value()].inheritance = {.from = tk};
+
+                    // Slots are specific to the node type, so a node can only
+                    // inherit properties from a node of the same type
+                    if (schema) {
+                        probes.record(&StageProbes::nodeLookups);
+                        std::optional<size_t> parent = nodeIndex.find(nodes, tk);
+                        if (parent.has_value() && nodes[parent.value()].typeId != nodes[currentNode.value()].typeId) {
+                            SourcePosition pos = startOf(token, tk);
+                            return Error{
+                                    .errorCode = ErrorCode::HXL_INHERIT_DIFF_TYPES,
+                                    .message = std::format("[Line {}, Col {}] Node {} cannot inherit {} of a different type.",
+                                                           pos.line,
+                                                           pos.col,
+                                                           nodes[currentNode.value()].name,
+                                                           tk),
+                            };
+                        }
+                    }
                 } else if (context == GC::AfterNodeType) {
                     nodes[currentNode.value()].name = tk;
+                    if (schema) {
+                        nodeIndex.insert(nodes, currentNode.value());
+                    }
                     context = GC::AfterNodeName;
                 } else if (context == GC::PropertyKey) {
+                    std::optional<SlotId> slot;
+                    if (schema) {
+                        const Node &node = nodes[currentNode.value()];
+                        probes.record(&StageProbes::slotLookups);
+                        slot = schema->findSlot(node.typeId.value(), tk);
+                        if (!slot.has_value()) {
+                            SourcePosition pos = startOf(token, tk);
+                            return Error{
+                                    .errorCode = ErrorCode::HXL_UNKNOWN_PROPERTY,
+                                    .message = std::format("[Line {}, Col {}] Node {} has an unknown property: {}",
+                                                           pos.line,
+                                                           pos.col,
+                                                           node.name,
+                                                           tk),
+                            };
+                        }
+                    }
                     buildingProperty = BuildingProperty{
                             .key = tk,
+                            .position = startOf(token, tk),
+                            .slot = slot,
                     };
                 } else if (context == GC::PropertyValue && buildingProperty.has_value() &&
                            buildingProperty->specialization == PropertySpecialization::Reference) {
-                    buildingProperty.value() += token;
+                    if (buildingProperty->values.size() == limits.maxArrayLength) {
+                        return arrayTooLong();
+                    }
+                    std::optional<Error> error = buildingProperty->add(token, strings, extent.strings, probes);
+                    if (error.has_value()) {
+                        return error.value();
+                    }
                 } else {
                     return unexpectedTokenError(token);
                 }
@@ -223,16 +539,41 @@ HXL::Result<HXL::Document> HXL::Parser::parse(const std::vector<Token> &tokens)
                 // If we're building a node property, we append it to the
                 // syntax tree.
                 if (currentNode.has_value() && sentence == Sentence::NodeProperty) {
-                    nodes[currentNode.value()].properties.push_back({
-                                                                            .name = buildingProperty->key,
-                                                                            .values = buildingProperty->values,
-                                                                            .dataType = buildingProperty->dataType,
-                                                                    });
+                    Node &node = nodes[currentNode.value()];
+                    NodeProperty nodeProperty{
+                            .name = buildingProperty->key,
+                            .values = std::move(buildingProperty->values),
+                            .dataType = buildingProperty->dataType,
+                            .structure = buildingProperty->specialization == PropertySpecialization::Array
+                                                 ? ValueStructure::Array
+                                                 : ValueStructure::Single,
+                            .position = buildingProperty->position,
+                            .value = std::move(buildingProperty->value),
+                            .slot = buildingProperty->slot,
+                    };
+
+                    // With a schema, the value is checked and converted before
+                    // it's added to the node
+                    if (schema) {
+                        const SchemaNodeType &schemaType = schema->type(node.typeId.value());
+                        std::optional<Error> error = SchemaValidator::checkProperty(schemaType.properties[nodeProperty.slot.value()],
+                                                                                    node,
+                                                                                    nodeProperty,
+                                                                                    strings);
+                        if (error.has_value()) {
+                            return error.value();
+                        }
+                    }
+
+                    node.properties.push_back(std::move(nodeProperty));
                 }
 
                 // Reset the context, as we enter a new line
                 context = GC::StartOfLine;
                 sentence = Sentence::NotDetermined;
+                if (stopToken.stop_requested()) {
+                    return Error{ErrorCode::HXL_CANCELLED, "Processing was cancelled."};
+                }
                 break;
 
                 /**
@@ -267,13 +608,64 @@ HXL::Result<HXL::Document> HXL::Parser::parse(const std::vector<Token> &tokens)
             case TokenType::T_FLOAT:
             case TokenType::T_BOOL:
                 if (context == GC::PropertyValue || context == GC::ExpandingArray_ExpectsValue) {
-                    buildingProperty.value() += token;
+                    if (buildingProperty->values.size() == limits.maxArrayLength) {
+                        return arrayTooLong();
+                    }
+                    std::optional<Error> error = buildingProperty->add(token, strings, extent.strings, probes);
+                    if (error.has_value()) {
+                        return error.value();
+                    }
                     context = GC::ExpandingArray_GotValue;
                 } else {
                     return unexpectedTokenError(token);
                 }
                 break;
 
+                /**
+                 * Numeric arrays
+                 *
+                 * A large array of numbers is converted straight to a typed
+                 * buffer, without storing every number as a string.
+                 */
+            case TokenType::T_NUMERIC_ARRAY: {
+                if (context != GC::ExpandingArray_ExpectsValue || !token.value.has_value() ||
+                    !buildingProperty->values.empty()) {
+                    return unexpectedTokenError(token);
+                }
+
+                // The values are counted before they're converted, so an array
+                // which is too long is never allocated
+                if (limits.maxArrayLength != std::numeric_limits<size_t>::max() &&
+                    static_cast<size_t>(std::count(token.value->begin(), token.value->end(), ',')) >= limits.maxArrayLength) {
+                    return arrayTooLong();
+                }
+
+                // The tokenizer only takes well-formed arrays in one go, so the
+                // conversion can only fail on a number out of range, which is
+                // reported as it would be for the value token
+                DataType dataType;
+                std::optional<DeserializedValue> value = Helpers::parseNumericArray(token.value.value(), dataType);
+                if (!value.has_value()) {
+                    return Error{
+                            .errorCode = ErrorCode::HXL_ILLEGAL_DATA_TYPE,
+                            .message = std::format("[Line {}, Col {}] Value of property {} cannot be represented as {}",
+                                                   buildingProperty->position.line,
+                                                   buildingProperty->position.col,
+                                                   buildingProperty->key,
+                                                   Helpers::toString(dataType)),
+                    };
+                }
+
+                const auto *floats = std::get_if<std::vector<float>>(&value.value());
+                const auto *ints = std::get_if<std::vector<int>>(&value.value());
+                probes.record(&StageProbes::numberConversions, floats ? floats->size() : ints->size());
+
+                buildingProperty->dataType = dataType;
+                buildingProperty->value = std::move(value);
+                context = GC::ExpandingArray_GotValue;
+                break;
+            }
+
                 /**
                  * If no case fits
                  */
@@ -282,7 +674,118 @@ HXL::Result<HXL::Document> HXL::Parser::parse(const std::vector<Token> &tokens)
         }
     }
 
-    return Document{
-            .nodes = nodes,
-    };
+    if (schema && requireProperties && currentNode.has_value()) {
+        std::optional<Error> error = checkRequired(*schema, nodes, nodeIndex, nodes[currentNode.value()]);
+        if (error.has_value()) {
+            return error.value();
+        }
+    }
+
+    return std::nullopt;
+}
+
+template std::optional<HXL::Error> HXL::Parser::parse(const std::vector<Token> &,
+                                                      const HXL::CompiledSchema &,
+                                                      HXL::Document &,
+                                                      HXL::NodeIndex &,
+                                                      bool,
+                                                      const HXL::ResourceLimits &,
+                                                      HXL::NoProbes &);
+
+template std::optional<HXL::Error> HXL::Parser::parse(const std::vector<Token> &,
+                                                      const HXL::CompiledSchema &,
+                                                      HXL::Document &,
+                                                      HXL::NodeIndex &,
+                                                      bool,
+                                                      const HXL::ResourceLimits &,
+                                                      HXL::StageProbes &);
+
+template std::optional<HXL::Error> HXL::Parser::parsePart(const std::vector<Token> &,
+                                                          const HXL::CompiledSchema &,
+                                                          HXL::Document &,
+                                                          HXL::NodeIndex &,
+                                                          bool,
+                                                          bool,
+                                                          const HXL::ResourceLimits &,
+                                                          HXL::NoProbes &,
+                                                          const std::stop_token &);
+
+template std::optional<HXL::Error> HXL::Parser::parsePart(const std::vector<Token> &,
+                                                          const HXL::CompiledSchema &,
+                                                          HXL::Document &,
+                                                          HXL::NodeIndex &,
+                                                          bool,
+                                                          bool,
+                                                          const HXL::ResourceLimits &,
+                                                          HXL::StageProbes &,
+                                                          const std::stop_token &);
+
+template std::optional<HXL::Error> HXL::Parser::parsePart(const std::vector<Token> &,
+                                                          const HXL::CompiledSchema &,
+                                                          HXL::Document &,
+                                                          HXL::DocumentExtent &,
+                                                          HXL::NodeIndex &,
+                                                          bool,
+                                                          bool,
+                                                          const HXL::ResourceLimits &,
+                                                          HXL::NoProbes &,
+                                                          const std::stop_token &);
+
+template std::optional<HXL::Error> HXL::Parser::parsePart(const std::vector<Token> &,
+                                                          const HXL::CompiledSchema &,
+                                                          HXL::Document &,
+                                                          HXL::DocumentExtent &,
+                                                          HXL::NodeIndex &,
+                                                          bool,
+                                                          bool,
+                                                          const HXL::ResourceLimits &,
+                                                          HXL::StageProbes &,
+                                                          const std::stop_token &);
+
+std::optional<HXL::Error> HXL::Parser::checkRequired(const HXL::CompiledSchema &schema,
+                                                     const std::vector<Node> &nodes,
+                                                     const HXL::NodeIndex &nodeIndex,
+                                                     const HXL::Node &node) {
+    const std::vector<SchemaNodeProperty> &schemaProperties = schema.type(node.typeId.value()).properties;
+
+    for (SlotId slot = 0; slot < schemaProperties.size(); ++slot) {
+        if (!schemaProperties[slot].required) {
+            continue;
+        }
+
+        // Look for the property on the node, and otherwise on the nodes it inherits.
+        // Parents are declared before the child (and of the same type), so only
+        // parents with a lower index are followed, which also rules out cycles.
+        size_t current = &node - nodes.data();
+        bool found = false;
+        while (true) {
+            found = std::any_of(nodes[current].properties.begin(),
+                                nodes[current].properties.end(),
+                                [&](const NodeProperty &item) -> bool {
+                                    return item.slot == slot;
+                                });
+            if (found || !nodes[current].inheritance.has_value()) {
+                break;
+            }
+
+            std::optional<size_t> parent = nodeIndex.find(nodes, nodes[current].inheritance->from);
+            if (!parent.has_value() || parent.value() >= current) {
+                break;
+            }
+            current = parent.value();
+        }
+
+        if (!found) {
+            return Error{
+                    .errorCode = ErrorCode::HXL_REQUIRED_PROPERTY_NOT_FOUND,
+                    .message = std::format("[Line {}, Col {}] Node {} is missing required property: {}",
+                                           node.position.line,
+                                           node.position.col,
+                                           node.name,
+                                           schemaProperties[slot].name),
+            };
+        }
+    }
+
+    return std::nullopt;
 }
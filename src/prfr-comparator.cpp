@@ -0,0 +1,128 @@
+#include "hxl-lang/utilities/prfr-comparator.h"
+#include "hxl-lang/utilities/prfr-exporter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+
+namespace {
+    /**
+     * The times of a stage in the runs, which measured it, sorted.
+     */
+    std::vector<const HXL::ExecutionTime *> sortedTimes(std::span<const HXL::PerformanceResults> runs,
+                                                        HXL::PerformanceResults::StageResult HXL::PerformanceResults::*stage) {
+        std::vector<const HXL::ExecutionTime *> times;
+        for (const HXL::PerformanceResults &run: runs) {
+            if ((run.*stage).has_value()) {
+                times.push_back(&(run.*stage).value());
+            }
+        }
+        std::sort(times.begin(), times.end(), [](const HXL::ExecutionTime *a, const HXL::ExecutionTime *b) {
+            return a->ns < b->ns;
+        });
+        return times;
+    }
+
+    /**
+     * The median of sorted values, which for an even number is the mean
+     * of the two in the middle.
+     */
+    HXL::PerformanceTime median(const std::vector<HXL::PerformanceTime> &sorted) {
+        size_t middle = sorted.size() / 2;
+        return sorted.size() % 2 == 1 ? sorted[middle] : (sorted[middle - 1] + sorted[middle]) / 2;
+    }
+}
+
+HXL::PerformanceResults HXL::Utilities::PerformanceResultsComparator::median(std::span<const HXL::PerformanceResults> runs) {
+    PerformanceResults results;
+    for (const PerformanceResults::Stage &stage: PerformanceResults::stages()) {
+        std::vector<const ExecutionTime *> times = sortedTimes(runs, stage.result);
+        if (times.empty()) {
+            continue;
+        }
+
+        std::vector<PerformanceTime> ns;
+        for (const ExecutionTime *time: times) {
+            ns.push_back(time->ns);
+        }
+
+        ExecutionTime result = *times[times.size() / 2];
+        result.ns = ::median(ns);
+        result.ms = result.ns / 1000;
+        results.*stage.result = result;
+    }
+    return results;
+}
+
+HXL::Utilities::PerformanceComparison HXL::Utilities::PerformanceResultsComparator::compare(const HXL::PerformanceResults &baseline,
+                                                                                             std::span<const HXL::PerformanceResults> runs,
+                                                                                             const HXL::Utilities::ComparisonOptions &options) {
+    PerformanceComparison comparison;
+    for (const PerformanceResults::Stage &stage: PerformanceResults::stages()) {
+        const PerformanceResults::StageResult &base = baseline.*stage.result;
+        std::vector<const ExecutionTime *> times = sortedTimes(runs, stage.result);
+        if (!base.has_value() || times.empty()) {
+            continue;
+        }
+
+        std::vector<PerformanceTime> ns;
+        for (const ExecutionTime *time: times) {
+            ns.push_back(time->ns);
+        }
+        PerformanceTime medianNs = ::median(ns);
+
+        // The median absolute deviation, which (unlike the standard deviation)
+        // isn't thrown off by a single run, which was interrupted
+        std::vector<PerformanceTime> deviations;
+        for (PerformanceTime time: ns) {
+            deviations.push_back(std::abs(time - medianNs));
+        }
+        std::sort(deviations.begin(), deviations.end());
+        PerformanceTime noiseNs = ::median(deviations);
+
+        PerformanceTime baselineNs = base->ns;
+        PerformanceTime thresholdNs = std::max({
+                static_cast<PerformanceTime>(std::llround(options.tolerance * static_cast<double>(baselineNs))),
+                static_cast<PerformanceTime>(std::llround(options.noiseFactor * static_cast<double>(noiseNs))),
+                options.minimumDelta,
+        });
+
+        PerformanceTime difference = medianNs - baselineNs;
+        comparison.stages.push_back({
+                .stage = stage.name,
+                .baselineNs = baselineNs,
+                .medianNs = medianNs,
+                .noiseNs = noiseNs,
+                .thresholdNs = thresholdNs,
+                .delta = baselineNs > 0 ? static_cast<double>(difference) / static_cast<double>(baselineNs) : 0.0,
+                .regressed = difference > thresholdNs,
+                .improved = -difference > thresholdNs,
+        });
+    }
+    return comparison;
+}
+
+HXL::Result<HXL::Utilities::PerformanceComparison> HXL::Utilities::PerformanceResultsComparator::compare(const std::filesystem::path &baseline,
+                                                                                                         std::span<const HXL::PerformanceResults> runs,
+                                                                                                         const HXL::Utilities::ComparisonOptions &options) {
+    Result<PerformanceResults> results = PerformanceResultsExporter::load(baseline);
+    if (results.isErr()) {
+        return results.error();
+    }
+    return compare(results.get(), runs, options);
+}
+
+std::string HXL::Utilities::PerformanceResultsComparator::describe(const HXL::Utilities::PerformanceComparison &comparison) {
+    std::string description;
+    for (const StageComparison &stage: comparison.stages) {
+        std::string_view verdict = stage.regressed ? "regressed" : stage.improved ? "improved" : "unchanged";
+        description += std::format("{}: {} ns -> {} ns ({:.1f}%, threshold {} ns) {}\n",
+                                   stage.stage,
+                                   stage.baselineNs,
+                                   stage.medianNs,
+                                   stage.delta * 100.0,
+                                   stage.thresholdNs,
+                                   verdict);
+    }
+    return description;
+}
@@ -0,0 +1,424 @@
+#include "hxl-lang/utilities/prfr-exporter.h"
+
+#include <cctype>
+#include <charconv>
+#include <format>
+#include <fstream>
+#include <sstream>
+
+namespace {
+    /**
+     * The counters, in the order (and by the names) they're exported.
+     */
+    struct Counter {
+        std::string_view name;
+        size_t HXL::StageCounters::*value;
+    };
+
+    const Counter counters[] = {
+            {"bytes", &HXL::StageCounters::bytes},
+            {"tokens", &HXL::StageCounters::tokens},
+            {"nodes", &HXL::StageCounters::nodes},
+            {"properties", &HXL::StageCounters::properties},
+            {"arrayElements", &HXL::StageCounters::arrayElements},
+            {"references", &HXL::StageCounters::references},
+            {"inheritanceLinks", &HXL::StageCounters::inheritanceLinks},
+    };
+
+    /**
+     * The probes, in the order (and by the names) they're exported.
+     */
+    struct Probe {
+        std::string_view name;
+        size_t HXL::StageProbes::*value;
+    };
+
+    const Probe probes[] = {
+            {"literalBytes", &HXL::StageProbes::literalBytes},
+            {"commentBytes", &HXL::StageProbes::commentBytes},
+            {"numericArrayBytes", &HXL::StageProbes::numericArrayBytes},
+            {"typeLookups", &HXL::StageProbes::typeLookups},
+            {"slotLookups", &HXL::StageProbes::slotLookups},
+            {"nodeLookups", &HXL::StageProbes::nodeLookups},
+            {"numberConversions", &HXL::StageProbes::numberConversions},
+            {"stringBytes", &HXL::StageProbes::stringBytes},
+    };
+
+    std::string rate(double value) {
+        return std::format("{:.3f}", value);
+    }
+
+    /**
+     * Reads the subset of JSON written by ``toJson``: Objects, numbers
+     * and ``null``, with strings as keys.
+     */
+    class JsonReader {
+    public:
+        explicit JsonReader(std::string_view json) : json(json) {
+        }
+
+        /**
+         * Read an object, and call ``handle`` with each key, positioned at
+         * its value, which the handle must read.
+         */
+        template<typename F>
+        bool readObject(F &&handle) {
+            if (!consume('{')) {
+                return false;
+            }
+            if (consume('}')) {
+                return true;
+            }
+            do {
+                std::string_view key;
+                if (!readKey(key) || !consume(':') || !handle(key)) {
+                    return false;
+                }
+            } while (consume(','));
+            return consume('}');
+        }
+
+        bool readNull() {
+            skipWhitespace();
+            if (json.substr(position, 4) != "null") {
+                return false;
+            }
+            position += 4;
+            return true;
+        }
+
+        bool isNull() {
+            skipWhitespace();
+            return json.substr(position, 4) == "null";
+        }
+
+        template<typename T>
+        bool readInteger(T &value) {
+            skipWhitespace();
+            int64_t number;
+            auto [end, error] = std::from_chars(json.data() + position, json.data() + json.size(), number);
+            if (error != std::errc()) {
+                return false;
+            }
+            position = end - json.data();
+            value = static_cast<T>(number);
+            return true;
+        }
+
+        /**
+         * Skip a value, which isn't read.
+         */
+        bool skipValue() {
+            skipWhitespace();
+            if (position < json.size() && json[position] == '{') {
+                return readObject([&](std::string_view) {
+                    return skipValue();
+                });
+            }
+            if (isNull()) {
+                return readNull();
+            }
+            size_t begin = position;
+            while (position < json.size() && (std::isdigit(static_cast<unsigned char>(json[position])) || std::string_view("+-.eE").find(json[position]) != std::string_view::npos)) {
+                ++position;
+            }
+            return position > begin;
+        }
+
+        bool atEnd() {
+            skipWhitespace();
+            return position == json.size();
+        }
+
+        [[nodiscard]] size_t offset() const {
+            return position;
+        }
+
+    private:
+        std::string_view json;
+        size_t position = 0;
+
+        void skipWhitespace() {
+            while (position < json.size() && std::isspace(static_cast<unsigned char>(json[position]))) {
+                ++position;
+            }
+        }
+
+        bool consume(char c) {
+            skipWhitespace();
+            if (position < json.size() && json[position] == c) {
+                ++position;
+                return true;
+            }
+            return false;
+        }
+
+        bool readKey(std::string_view &key) {
+            if (!consume('"')) {
+                return false;
+            }
+            size_t end = json.find('"', position);
+            if (end == std::string_view::npos) {
+                return false;
+            }
+            key = json.substr(position, end - position);
+            position = end + 1;
+            return true;
+        }
+    };
+
+    bool readAllocations(JsonReader &reader, HXL::AllocationCounters &allocations) {
+        return reader.readObject([&](std::string_view key) {
+            if (key == "allocations") {
+                return reader.readInteger(allocations.allocations);
+            } else if (key == "bytesAllocated") {
+                return reader.readInteger(allocations.bytesAllocated);
+            } else if (key == "bytesRetained") {
+                return reader.readInteger(allocations.bytesRetained);
+            } else if (key == "peakBytes") {
+                return reader.readInteger(allocations.peakBytes);
+            } else if (key == "peakRssDelta") {
+                return reader.readInteger(allocations.peakRssDelta);
+            }
+            return reader.skipValue();
+        });
+    }
+
+    bool readHardware(JsonReader &reader, HXL::HardwareCounters &hardware) {
+        return reader.readObject([&](std::string_view key) {
+            if (key == "cycles") {
+                return reader.readInteger(hardware.cycles);
+            } else if (key == "instructions") {
+                return reader.readInteger(hardware.instructions);
+            } else if (key == "cacheMisses") {
+                return reader.readInteger(hardware.cacheMisses);
+            } else if (key == "branchMisses") {
+                return reader.readInteger(hardware.branchMisses);
+            }
+            return reader.skipValue();
+        });
+    }
+
+    bool readStage(JsonReader &reader, HXL::ExecutionTime &time) {
+        bool hasMicroseconds = false;
+        bool read = reader.readObject([&](std::string_view key) {
+            if (key == "ns") {
+                return reader.readInteger(time.ns);
+            } else if (key == "us") {
+                hasMicroseconds = true;
+                return reader.readInteger(time.ms);
+            } else if (key == "counters") {
+                return reader.readObject([&](std::string_view name) {
+                    for (const Counter &counter: counters) {
+                        if (counter.name == name) {
+                            return reader.readInteger(time.counters.*counter.value);
+                        }
+                    }
+                    return reader.skipValue();
+                });
+            } else if (key == "allocations") {
+                if (reader.isNull()) {
+                    return reader.readNull();
+                }
+                time.allocations = HXL::AllocationCounters{};
+                return readAllocations(reader, time.allocations.value());
+            } else if (key == "hardware") {
+                if (reader.isNull()) {
+                    return reader.readNull();
+                }
+                time.hardware = HXL::HardwareCounters{};
+                return readHardware(reader, time.hardware.value());
+            } else if (key == "probes") {
+                if (reader.isNull()) {
+                    return reader.readNull();
+                }
+                time.probes = HXL::StageProbes{};
+                return reader.readObject([&](std::string_view name) {
+                    for (const Probe &probe: probes) {
+                        if (probe.name == name) {
+                            return reader.readInteger(time.probes.value().*probe.value);
+                        }
+                    }
+                    return reader.skipValue();
+                });
+            }
+            return reader.skipValue();
+        });
+
+        if (!hasMicroseconds) {
+            time.ms = time.ns / 1000;
+        }
+        return read;
+    }
+}
+
+std::string HXL::Utilities::PerformanceResultsExporter::toJson(const HXL::PerformanceResults &results) {
+    std::string json = "{\n";
+    std::span<const PerformanceResults::Stage> stages = PerformanceResults::stages();
+    for (size_t i = 0; i < stages.size(); ++i) {
+        const PerformanceResults::StageResult &result = results.*stages[i].result;
+        json += "  \"" + std::string(stages[i].name) + "\": ";
+
+        if (!result.has_value()) {
+            json += "null";
+        } else {
+            const ExecutionTime &time = result.value();
+            json += "{\n";
+            json += "    \"ns\": " + std::to_string(time.ns) + ",\n";
+            json += "    \"us\": " + std::to_string(time.ms) + ",\n";
+
+            json += "    \"counters\": {";
+            for (size_t c = 0; c < std::size(counters); ++c) {
+                json += (c > 0 ? ", \"" : "\"") + std::string(counters[c].name) + "\": " + std::to_string(time.counters.*counters[c].value);
+            }
+            json += "},\n";
+
+            json += "    \"megabytesPerSecond\": " + rate(time.megabytesPerSecond()) + ",\n";
+            json += "    \"nodesPerSecond\": " + rate(time.nodesPerSecond()) + ",\n";
+
+            json += "    \"allocations\": ";
+            if (time.allocations.has_value()) {
+                const AllocationCounters &allocations = time.allocations.value();
+                json += "{\"allocations\": " + std::to_string(allocations.allocations) +
+                        ", \"bytesAllocated\": " + std::to_string(allocations.bytesAllocated) +
+                        ", \"bytesRetained\": " + std::to_string(allocations.bytesRetained) +
+                        ", \"peakBytes\": " + std::to_string(allocations.peakBytes) +
+                        ", \"peakRssDelta\": " + std::to_string(allocations.peakRssDelta) + "}";
+            } else {
+                json += "null";
+            }
+            json += ",\n";
+
+            json += "    \"hardware\": ";
+            if (time.hardware.has_value()) {
+                const HardwareCounters &hardware = time.hardware.value();
+                json += "{\"cycles\": " + std::to_string(hardware.cycles) +
+                        ", \"instructions\": " + std::to_string(hardware.instructions) +
+                        ", \"cacheMisses\": " + std::to_string(hardware.cacheMisses) +
+                        ", \"branchMisses\": " + std::to_string(hardware.branchMisses) + "}";
+            } else {
+                json += "null";
+            }
+            json += ",\n";
+
+            json += "    \"probes\": ";
+            if (time.probes.has_value()) {
+                json += "{";
+                for (size_t p = 0; p < std::size(probes); ++p) {
+                    json += (p > 0 ? ", \"" : "\"") + std::string(probes[p].name) + "\": " + std::to_string(time.probes.value().*probes[p].value);
+                }
+                json += "}";
+            } else {
+                json += "null";
+            }
+            json += "\n  }";
+        }
+
+        json += i + 1 < stages.size() ? ",\n" : "\n";
+    }
+    return json + "}\n";
+}
+
+HXL::Result<HXL::PerformanceResults> HXL::Utilities::PerformanceResultsExporter::fromJson(std::string_view json) {
+    PerformanceResults results;
+    JsonReader reader(json);
+    bool read = reader.readObject([&](std::string_view key) {
+        for (const PerformanceResults::Stage &stage: PerformanceResults::stages()) {
+            if (stage.name != key) {
+                continue;
+            }
+            if (reader.isNull()) {
+                return reader.readNull();
+            }
+            PerformanceResults::StageResult &result = results.*stage.result;
+            result = ExecutionTime{};
+            return readStage(reader, result.value());
+        }
+        return reader.skipValue();
+    });
+
+    if (!read || !reader.atEnd()) {
+        return Error{
+                .errorCode = ErrorCode::HXL_INVALID_PERFORMANCE_RESULTS,
+                .message = std::format("Invalid performance results at offset {}.", reader.offset()),
+        };
+    }
+    return results;
+}
+
+HXL::Result<HXL::PerformanceResults> HXL::Utilities::PerformanceResultsExporter::load(const std::filesystem::path &path) {
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream) {
+        return Error{
+                .errorCode = ErrorCode::HXL_CANNOT_READ_FILE,
+                .message = std::format("Cannot read file: {}", path.string()),
+        };
+    }
+
+    std::ostringstream json;
+    json << stream.rdbuf();
+    return fromJson(json.str());
+}
+
+std::string HXL::Utilities::PerformanceResultsExporter::toCsv(std::span<const HXL::PerformanceResults> runs) {
+    std::string csv = "run,stage,ns,us";
+    for (const Counter &counter: counters) {
+        csv += "," + std::string(counter.name);
+    }
+    csv += ",megabytesPerSecond,nodesPerSecond,allocations,bytesAllocated,bytesRetained,peakBytes,peakRssDelta";
+    csv += ",cycles,instructions,cacheMisses,branchMisses";
+    for (const Probe &probe: probes) {
+        csv += "," + std::string(probe.name);
+    }
+    csv += "\n";
+
+    for (size_t run = 0; run < runs.size(); ++run) {
+        for (const PerformanceResults::Stage &stage: PerformanceResults::stages()) {
+            const PerformanceResults::StageResult &result = runs[run].*stage.result;
+            if (!result.has_value()) {
+                continue;
+            }
+
+            const ExecutionTime &time = result.value();
+            csv += std::to_string(run) + "," + std::string(stage.name) + "," + std::to_string(time.ns) + "," + std::to_string(time.ms);
+            for (const Counter &counter: counters) {
+                csv += "," + std::to_string(time.counters.*counter.value);
+            }
+            csv += "," + rate(time.megabytesPerSecond()) + "," + rate(time.nodesPerSecond());
+
+            // Allocations which weren't tracked are left empty
+            if (time.allocations.has_value()) {
+                const AllocationCounters &allocations = time.allocations.value();
+                csv += "," + std::to_string(allocations.allocations) +
+                       "," + std::to_string(allocations.bytesAllocated) +
+                       "," + std::to_string(allocations.bytesRetained) +
+                       "," + std::to_string(allocations.peakBytes) +
+                       "," + std::to_string(allocations.peakRssDelta);
+            } else {
+                csv += ",,,,,";
+            }
+
+            // As are hardware events, which weren't counted
+            if (time.hardware.has_value()) {
+                const HardwareCounters &hardware = time.hardware.value();
+                csv += "," + std::to_string(hardware.cycles) +
+                       "," + std::to_string(hardware.instructions) +
+                       "," + std::to_string(hardware.cacheMisses) +
+                       "," + std::to_string(hardware.branchMisses);
+            } else {
+                csv += ",,,,";
+            }
+
+            // And probes, which weren't taken
+            for (const Probe &probe: probes) {
+                csv += time.probes.has_value() ? "," + std::to_string(time.probes.value().*probe.value) : ",";
+            }
+            csv += "\n";
+        }
+    }
+    return csv;
+}
+
+std::string HXL::Utilities::PerformanceResultsExporter::toCsv(const HXL::PerformanceResults &results) {
+    return toCsv(std::span<const PerformanceResults>(&results, 1));
+}
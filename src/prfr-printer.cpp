@@ -1,4 +1,5 @@
 #include "hxl-lang/utilities/prfr-printer.h"
+#include <format>
 #include <iostream>
 
 /**
@@ -70,6 +71,11 @@ inline void cells(const std::vector<std::string> &cells,
     std::cout << cell << "\n";
 }
 
+/**
+ * The number of columns in the table.
+ */
+uint8_t columns = 5;
+
 /**
  * Draw a row with a title and performance metrics.
  *
@@ -78,26 +84,34 @@ inline void cells(const std::vector<std::string> &cells,
  */
 inline void row(const std::string &title,
                 const std::optional<HXL::ExecutionTime> &time) {
-    std::string milli, micro;
+    std::string milli, micro, megabytes, nodes;
 
     // Text to show if there's no metric for this category.
-    milli = micro = "-";
+    milli = micro = megabytes = nodes = "-";
 
     if (time.has_value()) {
         HXL::PerformanceTime ms = time.value().ms;
         micro = std::to_string(ms);
         milli = std::to_string(ms / 1000);
+
+        // Rates are only shown, when the stage has counted its work
+        if (time->counters.bytes > 0) {
+            megabytes = std::format("{:.1f}", time->megabytesPerSecond());
+        }
+        if (time->counters.nodes > 0) {
+            nodes = std::to_string(static_cast<long long>(time->nodesPerSecond()));
+        }
     }
 
     // Draw the cells
-    cells({title, milli + " ms", micro}, ' ', '|', cellSize);
+    cells({title, milli + " ms", micro, megabytes, nodes}, ' ', '|', cellSize);
 }
 
 void HXL::Utilities::PerformanceResultsPrinter::print(const HXL::PerformanceResults &results) {
     // Header
-    separatorLine('-', cellSize * 3);
-    cells({"Metric", "Millisecs.", "Microsecs."}, ' ', '|', cellSize);
-    separatorLine('-', cellSize * 3);
+    separatorLine('-', cellSize * columns);
+    cells({"Metric", "Millisecs.", "Microsecs.", "MB/s", "Nodes/s"}, ' ', '|', cellSize);
+    separatorLine('-', cellSize * columns);
 
     // Rows with each metric
     row("Tokenization", results.tokenization);
@@ -108,9 +122,9 @@ void HXL::Utilities::PerformanceResultsPrinter::print(const HXL::PerformanceResu
     row("Deserialization", results.deserialization);
 
     // Total (footer)
-    separatorLine('-', cellSize * 3);
+    separatorLine('-', cellSize * columns);
     row("Total", results.getTotal());
-    separatorLine('-', cellSize * 3);
+    separatorLine('-', cellSize * columns);
 
     std::cout.flush();
 }
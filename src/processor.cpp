@@ -1,68 +1,760 @@
 #include "hxl-lang/services/processor.h"
 #include "hxl-lang/services/deserializer.h"
 #include "hxl-lang/services/parser.h"
-#include "hxl-lang/services/schema-validator.h"
+#include "hxl-lang/services/schema-compiler.h"
 #include "hxl-lang/services/semantic-analyzer.h"
 #include "hxl-lang/services/tokenizer.h"
 #include "hxl-lang/services/transformer.h"
+#include "hxl-lang/utilities/bounded-queue.h"
+#include "hxl-lang/utilities/thread-pool.h"
 
-HXL::ProcessResult HXL::Processor::process(const std::string &source, const HXL::Schema &schema, const HXL::DeserializationProtocol &protocol) {
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <exception>
+#include <future>
+#include <limits>
+#include <thread>
+#include <type_traits>
+
+namespace {
+    /**
+     * A part of the source, tokenized into one of the token batches,
+     * which is passed from the tokenizer to the parser.
+     */
+    struct TokenizedPart {
+        size_t batch;
+        bool last;
+    };
+
+    /**
+     * A range of nodes, which is passed between the later stages.
+     */
+    struct NodeRange {
+        size_t begin, end;
+    };
+
+    /**
+     * Find where the part of the source, which starts at ``begin``, ends,
+     * so it holds (about) ``nodeCount`` nodes. Parts end before a line
+     * that starts with ``<``, which is always the start of a node.
+     *
+     * @param source
+     * @param begin
+     * @param nodeCount
+     * @return
+     */
+    size_t endOfPart(std::string_view source, size_t begin, size_t nodeCount) {
+        size_t position = begin;
+        for (size_t found = 0; found < std::max<size_t>(nodeCount, 1); ++found) {
+            position = source.find("\n<", position);
+            if (position == std::string_view::npos) {
+                return source.size();
+            }
+            ++position;
+        }
+        return position;
+    }
+
+    /**
+     * The limits for tokenizing the next part of a source, when ``tokenCount``
+     * tokens have been produced by the parts before it.
+     *
+     * @param limits
+     * @param tokenCount
+     * @return
+     */
+    HXL::ResourceLimits limitsOfPart(const HXL::ResourceLimits &limits, size_t tokenCount) {
+        HXL::ResourceLimits part = limits;
+        if (limits.maxTokens != std::numeric_limits<size_t>::max()) {
+            part.maxTokens = limits.maxTokens - std::min(tokenCount, limits.maxTokens);
+        }
+        return part;
+    }
+
+    /**
+     * The results of processing a source in parts, from the time measured
+     * per stage. The parser counts the nodes it has parsed, and the transformer
+     * the nodes it has transformed (with their inherited properties), which
+     * the semantic analysis and the deserialization handle in turn.
+     *
+     * @param bytes
+     * @param tokenization
+     * @param parsing
+     * @param semanticAnalysis
+     * @param transformer
+     * @param deserialization
+     * @return
+     */
+    HXL::PerformanceResults stageResults(size_t bytes,
+                                         HXL::ExecutionTime tokenization,
+                                         HXL::ExecutionTime parsing,
+                                         HXL::ExecutionTime semanticAnalysis,
+                                         HXL::ExecutionTime transformer,
+                                         HXL::ExecutionTime deserialization) {
+        parsing.counters.tokens = tokenization.counters.tokens;
+        semanticAnalysis.counters = parsing.counters;
+        semanticAnalysis.counters.tokens = 0;
+        deserialization.counters = transformer.counters;
+        for (HXL::ExecutionTime *stage: {&tokenization, &parsing, &semanticAnalysis, &transformer, &deserialization}) {
+            stage->counters.bytes = bytes;
+        }
+
+        return {
+                .tokenization = tokenization,
+                .parsing = parsing,
+                .semanticAnalysis = semanticAnalysis,
+                .transformer = transformer,
+                .deserialization = deserialization,
+        };
+    }
+
+    /**
+     * Attach the probes of the tokenizer or the parser to the time of its
+     * stage, if they were taken (see ``FullInstrumentation``).
+     *
+     * @param time
+     * @param probes
+     */
+    template<typename Probes>
+    void attachProbes(HXL::PerformanceResults::StageResult &time, const Probes &probes) {
+        if constexpr (std::is_same_v<Probes, HXL::StageProbes>) {
+            time->probes = probes;
+        }
+    }
+}
+
+template<typename Instrumentation>
+HXL::BasicProcessor<Instrumentation>::BasicProcessor(const HXL::Schema &schema,
+                                                     const HXL::DeserializationProtocol &protocol,
+                                                     const HXL::ProcessorOptions &options)
+    : processorOptions(options),
+      compiledSchema(std::make_shared<CompiledSchema>(SchemaCompiler::compile(schema))),
+      compiledProtocol(std::make_shared<CompiledProtocol>(Deserializer::compile(protocol, *compiledSchema))) {
+}
+
+template<typename Instrumentation>
+HXL::BasicProcessor<Instrumentation>::BasicProcessor(std::shared_ptr<const HXL::CompiledSchema> schema,
+                                                     std::shared_ptr<const HXL::CompiledProtocol> protocol,
+                                                     const HXL::ProcessorOptions &options)
+    : processorOptions(options),
+      compiledSchema(std::move(schema)),
+      compiledProtocol(std::move(protocol)) {
+}
+
+template<typename Instrumentation>
+HXL::ProcessResult HXL::BasicProcessor<Instrumentation>::process(const std::string &source, const HXL::Schema &schema, const HXL::DeserializationProtocol &protocol) {
+    return process(source, schema, protocol, {});
+}
+
+template<typename Instrumentation>
+HXL::ProcessResult HXL::BasicProcessor<Instrumentation>::process(const std::string &source,
+                                                                 const HXL::Schema &schema,
+                                                                 const HXL::DeserializationProtocol &protocol,
+                                                                 const HXL::DeserializationOptions &options) {
+    return BasicProcessor(schema, protocol).process(source, options);
+}
+
+template<typename Instrumentation>
+HXL::ProcessResult HXL::BasicProcessor<Instrumentation>::process(const std::string &source,
+                                                                 const HXL::Schema &schema,
+                                                                 const HXL::DeserializationProtocol &protocol,
+                                                                 const HXL::DeserializationOptions &options,
+                                                                 const HXL::ProcessorOptions &processorOptions) {
+    return BasicProcessor(schema, protocol, processorOptions).process(source, options);
+}
+
+template<typename Instrumentation>
+HXL::ProcessResult HXL::BasicProcessor<Instrumentation>::process(const std::string &source) {
+    return process(source, {});
+}
+
+template<typename Instrumentation>
+HXL::ProcessResult HXL::BasicProcessor<Instrumentation>::process(const std::string &source, const HXL::DeserializationOptions &options) {
     PerformanceResults performanceResults;
+    typename Instrumentation::Probes tokenizerProbes, parserProbes;
 
     // Tokenization
-    TokenizerResult tokenizerResult;
-    performanceResults.tokenization = measure([&]() {
-        tokenizerResult = Tokenizer::tokenize(source);
+    std::optional<Error> tokenizerError;
+    performanceResults.tokenization = measureStage("tokenization", [&]() {
+        tokenizerError = Tokenizer::tokenize(source, tokens, 1, processorOptions.tokenizer, processorOptions.limits, tokenizerProbes);
     });
-    if (tokenizerResult.isErr()) {
-        return {.errors = {tokenizerResult.error()}};
+    if (tokenizerError.has_value()) {
+        return {.errors = {tokenizerError.value()}};
+    }
+
+    // The document (with its nodes and string storage) is re-used, unless
+    // the caller still holds on to the previous one
+    if (!document || document.use_count() > 1) {
+        document = std::make_shared<Document>();
     }
 
     // Parsing
-    Result<Document> syntaxTree;
-    performanceResults.parsing = measure([&]() {
-        syntaxTree = Parser::parse(tokenizerResult.get());
+    // The parser is directed by the schema, which means unknown node types and
+    // properties are rejected as they're encountered, and values are type-checked
+    // and converted on the go. This covers the job of the Schema Validator.
+    std::optional<Error> parserError;
+    performanceResults.parsing = measureStage("parsing", [&]() {
+        parserError = Parser::parse(tokens,
+                                    *compiledSchema,
+                                    *document,
+                                    nodeIndex,
+                                    processorOptions.validation != ValidationLevel::Trusted,
+                                    processorOptions.limits,
+                                    parserProbes);
     });
-    if (syntaxTree.isErr()) {
-        return {.errors = {syntaxTree.error()}};
+    if (parserError.has_value()) {
+        return {.errors = {parserError.value()}};
     }
 
-    // Store document as a shared pointer
-    std::shared_ptr<Document> document = std::make_shared<Document>(syntaxTree.get());
+    // The counters are taken outside the measured stages. The transformer
+    // adds inherited properties, so the nodes are counted again after it.
+    StageCounters parsed;
+    if constexpr (Instrumentation::measuresStages) {
+        parsed = count(*compiledSchema, document->nodes, 0, document->nodes.size());
+        parsed.bytes = source.size();
+        performanceResults.tokenization->counters = {.bytes = source.size(), .tokens = tokens.size()};
+        performanceResults.parsing->counters = parsed;
+        performanceResults.parsing->counters.tokens = tokens.size();
+        attachProbes(performanceResults.tokenization, tokenizerProbes);
+        attachProbes(performanceResults.parsing, parserProbes);
+    }
 
     // Semantic analysis
-    ErrorList semanticErrors;
-    performanceResults.semanticAnalysis = measure([&]() {
-        semanticErrors = SemanticAnalyzer::analyze(document);
-    });
-    if (!semanticErrors.empty()) {
-        return {.errors = semanticErrors};
+    if (processorOptions.validation == ValidationLevel::Full) {
+        ErrorList semanticErrors;
+        performanceResults.semanticAnalysis = measureStage("semanticAnalysis", [&]() {
+            semanticErrors = SemanticAnalyzer::analyze(document, nodeIndex);
+        });
+        if (!semanticErrors.empty()) {
+            return {.errors = semanticErrors};
+        }
+        performanceResults.semanticAnalysis->counters = parsed;
     }
 
     // Transform (inheritance resolution, etc.)
-    performanceResults.transformer = measure([&]() {
-        Transformer::transform(document);
+    std::optional<Error> transformerError;
+    performanceResults.transformer = measureStage("transformer", [&]() {
+        transformerError = Transformer::transform(document, nodeIndex, processorOptions.limits);
     });
+    if (transformerError.has_value()) {
+        return {.errors = {transformerError.value()}};
+    }
 
-    // Schema validation
-    ErrorList schemaErrors;
-    performanceResults.schemaValidation = measure([&]() {
-        schemaErrors = SchemaValidator::validate(schema, document);
-    });
-    if (!schemaErrors.empty()) {
-        return {.errors = schemaErrors};
+    StageCounters transformed;
+    if constexpr (Instrumentation::measuresStages) {
+        transformed = count(*compiledSchema, document->nodes, 0, document->nodes.size());
+        transformed.bytes = source.size();
+        performanceResults.transformer->counters = transformed;
     }
 
     // Deserialization
+    // The protocol shares type IDs with the schema, so nodes are dispatched
+    // straight to their handles
     ErrorList deserializationErrors;
-    performanceResults.deserialization = measure([&]() {
-      deserializationErrors = Deserializer::deserialize(protocol, document);
+    performanceResults.deserialization = measureStage("deserialization", [&]() {
+      deserializationErrors = Deserializer::deserialize(*compiledProtocol, document, options, deserializationBuffers);
     });
     if (!deserializationErrors.empty()) {
         return {.errors = deserializationErrors};
     }
+    performanceResults.deserialization->counters = transformed;
+
+    // Without instrumentation, the (unmeasured) stages aren't reported
+    if constexpr (!Instrumentation::measuresStages) {
+        return {.document = document};
+    }
 
     return {
             .performanceResults = performanceResults,
+            .document = document,
     };
 }
+
+template<typename Instrumentation>
+HXL::BatchProcessResult HXL::BasicProcessor<Instrumentation>::processBatch(std::span<const std::string> sources,
+                                                                           const HXL::Schema &schema,
+                                                                           const HXL::DeserializationProtocol &protocol,
+                                                                           HXL::ThreadPool &pool,
+                                                                           const HXL::DeserializationOptions &options) {
+    return BasicProcessor(schema, protocol).processBatch(sources, pool, options);
+}
+
+template<typename Instrumentation>
+HXL::BatchProcessResult HXL::BasicProcessor<Instrumentation>::processBatch(std::span<const std::string> sources,
+                                                                           HXL::ThreadPool &pool,
+                                                                           const HXL::DeserializationOptions &options) const {
+    BatchProcessResult batch;
+    batch.results.resize(sources.size());
+
+    // Sources are handed out one at a time, rather than in fixed ranges,
+    // so a few large sources don't hold up a worker while others idle
+    std::atomic<size_t> next = 0;
+    size_t workerCount = std::min(pool.size(), sources.size());
+
+    batch.wallTime = measure([&]() {
+        TaskGroup group(pool);
+        for (size_t worker = 0; worker < workerCount; ++worker) {
+            group.run([&]() {
+                BasicProcessor processor(compiledSchema, compiledProtocol, processorOptions);
+                for (size_t i = next.fetch_add(1); i < sources.size(); i = next.fetch_add(1)) {
+                    HXL_TRACE_SPAN("source", "source");
+                    batch.results[i] = processor.process(sources[i], options);
+                }
+            });
+        }
+        group.wait();
+    });
+
+    for (const ProcessResult &result: batch.results) {
+        batch.performanceResults += result.performanceResults;
+        if (!result.errors.empty()) {
+            ++batch.failed;
+        }
+    }
+
+    return batch;
+}
+
+template<typename Instrumentation>
+HXL::ProcessResult HXL::BasicProcessor<Instrumentation>::processPipelined(const std::string &source,
+                                                                         const HXL::DeserializationOptions &options,
+                                                                         const HXL::PipelineOptions &pipeline) {
+    if (!document || document.use_count() > 1) {
+        document = std::make_shared<Document>();
+    }
+    document->nodes.clear();
+    document->strings.clear();
+    nodeIndex.clear();
+    resolutionIndex.clear();
+
+    // The parser writes nodes and strings into the document, while the later
+    // stages read the ones before them. So the vectors are sized in advance,
+    // and only their elements are written until the stages are joined. Every
+    // node starts with a "<", and every string is a part of the source, so
+    // neither can outgrow its storage.
+    size_t nodeBound = std::count(source.begin(), source.end(), '<');
+    document->nodes.resize(nodeBound);
+    document->strings.resize(source.size());
+    std::string_view strings(document->strings);
+    DocumentExtent extent;
+
+    // The token batches are handed back to the tokenizer, once parsed
+    size_t batchCount = pipeline.queueDepth + 2;
+    if (tokenBatches.size() < batchCount) {
+        tokenBatches.resize(batchCount);
+    }
+    BoundedQueue<size_t> freeBatches(batchCount);
+    for (size_t i = 0; i < batchCount; ++i) {
+        freeBatches.push(i);
+    }
+
+    BoundedQueue<TokenizedPart> tokenized(pipeline.queueDepth);
+    BoundedQueue<NodeRange> parsed(pipeline.queueDepth);
+    BoundedQueue<NodeRange> resolved(pipeline.queueDepth);
+
+    // When a stage stops (on error or otherwise), it closes the queues on
+    // both sides, so the stages before it stop as well
+    auto stopAll = [&]() {
+        freeBatches.close();
+        tokenized.close();
+        parsed.close();
+        resolved.close();
+    };
+
+    // Errors, exceptions and the time spent (and work done) per stage.
+    // Each is only written by its own stage.
+    std::optional<Error> tokenizerError, parserError;
+    ErrorList resolutionErrors, deserializationErrors;
+    std::exception_ptr exceptions[4];
+    ExecutionTime tokenization{}, parsing{}, semanticAnalysis{}, transformer{}, deserialization{};
+    typename Instrumentation::Probes tokenizerProbes, parserProbes;
+
+    std::thread tokenizerStage([&]() {
+        try {
+            size_t begin = 0, tokenCount = 0;
+            uint16_t line = 1;
+            do {
+                std::optional<size_t> batch = freeBatches.pop();
+                if (!batch.has_value()) {
+                    break;
+                }
+
+                std::string_view part = std::string_view(source).substr(begin, endOfPart(source, begin, pipeline.batchSize) - begin);
+                tokenization += measureStage("tokenization", [&]() {
+                    tokenizerError = Tokenizer::tokenize(part,
+                                                         tokenBatches[batch.value()],
+                                                         line,
+                                                         processorOptions.tokenizer,
+                                                         limitsOfPart(processorOptions.limits, tokenCount),
+                                                         tokenizerProbes);
+                });
+                if (tokenizerError.has_value()) {
+                    break;
+                }
+                tokenCount += tokenBatches[batch.value()].size();
+                tokenization.counters.tokens = tokenCount;
+
+                line += static_cast<uint16_t>(std::count(part.begin(), part.end(), '\n'));
+                begin += part.size();
+                if (!tokenized.push({batch.value(), begin == source.size()})) {
+                    break;
+                }
+            } while (begin < source.size());
+            tokenized.close();
+        } catch (...) {
+            exceptions[0] = std::current_exception();
+        }
+        if (tokenizerError.has_value() || exceptions[0]) {
+            stopAll();
+        }
+    });
+
+    std::thread parserStage([&]() {
+        try {
+            while (std::optional<TokenizedPart> part = tokenized.pop()) {
+                size_t begin = extent.nodes;
+                parsing += measureStage("parsing", [&]() {
+                    parserError = Parser::parsePart(tokenBatches[part->batch],
+                                                    *compiledSchema,
+                                                    *document,
+                                                    extent,
+                                                    nodeIndex,
+                                                    part->last,
+                                                    false,
+                                                    processorOptions.limits,
+                                                    parserProbes);
+                });
+                freeBatches.push(part->batch);
+                if (parserError.has_value()) {
+                    break;
+                }
+                assert(document->nodes.size() == nodeBound && document->strings.size() == source.size());
+                if constexpr (Instrumentation::measuresStages) {
+                    parsing.counters += count(*compiledSchema, document->nodes, begin, extent.nodes);
+                }
+                if (!parsed.push({begin, extent.nodes})) {
+                    break;
+                }
+            }
+            parsed.close();
+        } catch (...) {
+            exceptions[1] = std::current_exception();
+        }
+        if (parserError.has_value() || exceptions[1]) {
+            stopAll();
+        }
+    });
+
+    std::thread resolutionStage([&]() {
+        try {
+            while (std::optional<NodeRange> range = parsed.pop()) {
+                semanticAnalysis += measureStage("semanticAnalysis", [&]() {
+                    resolutionErrors = analyze(resolutionIndex, range->begin, range->end);
+                });
+                if (!resolutionErrors.empty()) {
+                    break;
+                }
+
+                // Required properties may be inherited, so they're checked
+                // once the inheritance is resolved
+                transformer += measureStage("transformer", [&]() {
+                    std::optional<Error> error = Transformer::transform(*document,
+                                                                        resolutionIndex,
+                                                                        range->begin,
+                                                                        range->end,
+                                                                        processorOptions.limits);
+                    if (error.has_value()) {
+                        resolutionErrors.push_back(error.value());
+                        return;
+                    }
+                    if (processorOptions.validation == ValidationLevel::Trusted) {
+                        return;
+                    }
+                    for (size_t i = range->begin; i < range->end && resolutionErrors.empty(); ++i) {
+                        std::optional<Error> error = Parser::checkRequired(*compiledSchema,
+                                                                           document->nodes,
+                                                                           resolutionIndex,
+                                                                           document->nodes[i]);
+                        if (error.has_value()) {
+                            resolutionErrors.push_back(error.value());
+                        }
+                    }
+                });
+                if (!resolutionErrors.empty()) {
+                    break;
+                }
+                if constexpr (Instrumentation::measuresStages) {
+                    transformer.counters += count(*compiledSchema, document->nodes, range->begin, range->end);
+                }
+                if (!resolved.push(range.value())) {
+                    break;
+                }
+            }
+            resolved.close();
+        } catch (...) {
+            exceptions[2] = std::current_exception();
+        }
+        if (!resolutionErrors.empty() || exceptions[2]) {
+            stopAll();
+        }
+    });
+
+    try {
+        while (std::optional<NodeRange> range = resolved.pop()) {
+            deserialization += measureStage("deserialization", [&]() {
+                deserializationErrors = Deserializer::deserializeNodes(*compiledProtocol,
+                                                                       *document,
+                                                                       strings,
+                                                                       range->begin,
+                                                                       range->end,
+                                                                       options,
+                                                                       deserializationBuffers);
+            });
+            if (!deserializationErrors.empty()) {
+                break;
+            }
+        }
+    } catch (...) {
+        exceptions[3] = std::current_exception();
+    }
+    stopAll();
+
+    tokenizerStage.join();
+    parserStage.join();
+    resolutionStage.join();
+    document->nodes.resize(extent.nodes);
+    document->strings.resize(extent.strings);
+
+    for (const std::exception_ptr &exception: exceptions) {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+
+    if (tokenizerError.has_value()) {
+        return {.errors = {tokenizerError.value()}};
+    } else if (parserError.has_value()) {
+        return {.errors = {parserError.value()}};
+    } else if (!resolutionErrors.empty()) {
+        return {.errors = resolutionErrors};
+    } else if (!deserializationErrors.empty()) {
+        return {.errors = deserializationErrors};
+    }
+
+    // The deferred phase, for the handles which need all nodes of their type
+    deserialization += measureStage("deserialization", [&]() {
+        deserializationErrors = Deserializer::deserializeDeferred(*compiledProtocol, document, options, deserializationBuffers);
+    });
+    if (!deserializationErrors.empty()) {
+        return {.errors = deserializationErrors};
+    }
+
+    PerformanceResults performanceResults;
+    if constexpr (Instrumentation::measuresStages) {
+        performanceResults = stageResults(source.size(), tokenization, parsing, semanticAnalysis, transformer, deserialization);
+        attachProbes(performanceResults.tokenization, tokenizerProbes);
+        attachProbes(performanceResults.parsing, parserProbes);
+    }
+
+    return {
+            .performanceResults = performanceResults,
+            .document = document,
+    };
+}
+
+template<typename Instrumentation>
+std::future<HXL::ProcessResult> HXL::BasicProcessor<Instrumentation>::processAsync(std::string source, HXL::AsyncOptions options) {
+    std::function<void(std::function<void()>)> executor = std::move(options.executor);
+    auto process = [this, source = std::move(source), options = std::move(options)]() {
+        return processInSteps(source, options);
+    };
+
+    if (!executor) {
+        return std::async(std::launch::async, std::move(process));
+    }
+
+    auto task = std::make_shared<std::packaged_task<ProcessResult()>>(std::move(process));
+    std::future<ProcessResult> result = task->get_future();
+    executor([task]() {
+        (*task)();
+    });
+    return result;
+}
+
+template<typename Instrumentation>
+HXL::ProcessResult HXL::BasicProcessor<Instrumentation>::processInSteps(const std::string &source, const HXL::AsyncOptions &options) {
+    ProcessProgress progress{.totalBytes = source.size()};
+    auto report = [&]() {
+        if (options.progress) {
+            options.progress(progress);
+        }
+    };
+
+    const ProcessResult cancelled{.errors = {{ErrorCode::HXL_CANCELLED, "Processing was cancelled."}}};
+    size_t batchSize = std::max<size_t>(options.batchSize, 1);
+
+    // The stages check the stop token as they go, so a large source can be
+    // cancelled partway through a stage
+    TokenizerOptions tokenizerOptions = processorOptions.tokenizer;
+    tokenizerOptions.stopToken = options.stopToken;
+    DeserializationOptions deserializationOptions = options.deserialization;
+    deserializationOptions.stopToken = options.stopToken;
+
+    if (!document || document.use_count() > 1) {
+        document = std::make_shared<Document>();
+    }
+    document->nodes.clear();
+    document->strings.clear();
+    nodeIndex.clear();
+
+    // Tokenization and parsing, part by part
+    ExecutionTime tokenization{}, parsing{};
+    typename Instrumentation::Probes tokenizerProbes, parserProbes;
+    size_t begin = 0, tokenCount = 0;
+    uint16_t line = 1;
+    do {
+        if (options.stopToken.stop_requested()) {
+            return cancelled;
+        }
+
+        std::string_view part = std::string_view(source).substr(begin, endOfPart(source, begin, batchSize) - begin);
+        std::optional<Error> error;
+        tokenization += measureStage("tokenization", [&]() {
+            error = Tokenizer::tokenize(part,
+                                        tokens,
+                                        line,
+                                        tokenizerOptions,
+                                        limitsOfPart(processorOptions.limits, tokenCount),
+                                        tokenizerProbes);
+        });
+        if (error.has_value()) {
+            return {.errors = {error.value()}};
+        }
+        tokenCount += tokens.size();
+
+        line += static_cast<uint16_t>(std::count(part.begin(), part.end(), '\n'));
+        begin += part.size();
+        size_t firstNode = document->nodes.size();
+        parsing += measureStage("parsing", [&]() {
+            error = Parser::parsePart(tokens,
+                                      *compiledSchema,
+                                      *document,
+                                      nodeIndex,
+                                      begin == source.size(),
+                                      processorOptions.validation != ValidationLevel::Trusted,
+                                      processorOptions.limits,
+                                      parserProbes,
+                                      options.stopToken);
+        });
+        if (error.has_value()) {
+            return {.errors = {error.value()}};
+        }
+        if constexpr (Instrumentation::measuresStages) {
+            parsing.counters += count(*compiledSchema, document->nodes, firstNode, document->nodes.size());
+        }
+
+        progress.bytesTokenized = begin;
+        progress.nodesParsed = document->nodes.size();
+        report();
+    } while (begin < source.size());
+
+    // Semantic analysis, where all errors are collected, as with ``process``
+    size_t nodeCount = document->nodes.size();
+    ExecutionTime semanticAnalysis{}, transformer{}, deserialization{};
+    ErrorList errors;
+    nodeIndex.clear();
+    for (size_t i = 0; i < nodeCount; i += batchSize) {
+        if (options.stopToken.stop_requested()) {
+            return cancelled;
+        }
+        semanticAnalysis += measureStage("semanticAnalysis", [&]() {
+            ErrorList batchErrors = analyze(nodeIndex, i, std::min(i + batchSize, nodeCount));
+            errors.insert(errors.end(), batchErrors.begin(), batchErrors.end());
+        });
+    }
+    if (!errors.empty()) {
+        return {.errors = errors};
+    }
+
+    // Transformation
+    for (size_t i = 0; i < nodeCount; i += batchSize) {
+        if (options.stopToken.stop_requested()) {
+            return cancelled;
+        }
+        std::optional<Error> error;
+        transformer += measureStage("transformer", [&]() {
+            error = Transformer::transform(*document, nodeIndex, i, std::min(i + batchSize, nodeCount), processorOptions.limits);
+        });
+        if (error.has_value()) {
+            return {.errors = {error.value()}};
+        }
+    }
+    if constexpr (Instrumentation::measuresStages) {
+        transformer.counters = count(*compiledSchema, document->nodes, 0, nodeCount);
+    }
+
+    // Deserialization. All nodes are checked for handles first, so no
+    // handles are called, if any are missing.
+    errors = Deserializer::checkHandles(*compiledProtocol, *document, 0, nodeCount, deserializationBuffers);
+    if (!errors.empty()) {
+        return {.errors = errors};
+    }
+    for (size_t i = 0; i < nodeCount; i += batchSize) {
+        if (options.stopToken.stop_requested()) {
+            return cancelled;
+        }
+        size_t end = std::min(i + batchSize, nodeCount);
+        deserialization += measureStage("deserialization", [&]() {
+            errors = Deserializer::deserializeNodes(*compiledProtocol,
+                                                    *document,
+                                                    document->strings,
+                                                    i,
+                                                    end,
+                                                    deserializationOptions,
+                                                    deserializationBuffers);
+        });
+        if (!errors.empty()) {
+            return {.errors = errors};
+        }
+
+        progress.nodesDeserialized = end;
+        report();
+    }
+
+    deserialization += measureStage("deserialization", [&]() {
+        errors = Deserializer::deserializeDeferred(*compiledProtocol, document, deserializationOptions, deserializationBuffers);
+    });
+    if (!errors.empty()) {
+        return {.errors = errors};
+    }
+
+    PerformanceResults performanceResults;
+    if constexpr (Instrumentation::measuresStages) {
+        tokenization.counters.tokens = tokenCount;
+        performanceResults = stageResults(source.size(), tokenization, parsing, semanticAnalysis, transformer, deserialization);
+        attachProbes(performanceResults.tokenization, tokenizerProbes);
+        attachProbes(performanceResults.parsing, parserProbes);
+    }
+
+    return {
+            .performanceResults = performanceResults,
+            .document = document,
+    };
+}
+
+template<typename Instrumentation>
+HXL::ErrorList HXL::BasicProcessor<Instrumentation>::analyze(HXL::NodeIndex &index, size_t begin, size_t end) const {
+    if (processorOptions.validation == ValidationLevel::Full) {
+        return SemanticAnalyzer::analyze(*document, index, begin, end);
+    }
+
+    for (size_t i = begin; i < end; ++i) {
+        index.insert(document->nodes, i);
+    }
+    return {};
+}
+
+template class HXL::BasicProcessor<HXL::NoInstrumentation>;
+template class HXL::BasicProcessor<HXL::StageInstrumentation>;
+template class HXL::BasicProcessor<HXL::FullInstrumentation>;
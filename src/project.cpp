@@ -0,0 +1,329 @@
+#include "hxl-lang/services/project.h"
+#include "hxl-lang/services/parser.h"
+#include "hxl-lang/services/schema-compiler.h"
+#include "hxl-lang/services/semantic-analyzer.h"
+#include "hxl-lang/services/tokenizer.h"
+#include "hxl-lang/services/transformer.h"
+#include "hxl-lang/utilities/node-index.h"
+#include "hxl-lang/utilities/thread-pool.h"
+#include "hxl-lang/utilities/tracer.h"
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <sstream>
+
+HXL::Project::Project(const HXL::Schema &schema, const HXL::DeserializationProtocol &protocol)
+    : compiledSchema(std::make_shared<CompiledSchema>(SchemaCompiler::compile(schema))),
+      compiledProtocol(std::make_shared<CompiledProtocol>(Deserializer::compile(protocol, *compiledSchema))) {
+}
+
+void HXL::Project::setFile(const std::string &name, std::string source) {
+    auto it = std::find_if(files.begin(), files.end(), [&](const File &file) {
+        return file.name == name;
+    });
+    if (it == files.end()) {
+        it = files.insert(files.end(), File{.name = name});
+    }
+
+    if (it->source != source) {
+        it->source = std::move(source);
+        it->changed = true;
+    }
+}
+
+std::optional<HXL::Error> HXL::Project::loadFile(const std::filesystem::path &path) {
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream) {
+        return Error{
+                .errorCode = ErrorCode::HXL_CANNOT_READ_FILE,
+                .message = std::format("Cannot read file: {}", path.string()),
+        };
+    }
+
+    std::ostringstream source;
+    source << stream.rdbuf();
+    setFile(path.string(), std::move(source).str());
+    return std::nullopt;
+}
+
+void HXL::Project::removeFile(const std::string &name) {
+    std::erase_if(files, [&](const File &file) {
+        return file.name == name;
+    });
+}
+
+size_t HXL::Project::parseCount() const {
+    return parses;
+}
+
+HXL::ProcessResult HXL::Project::process(HXL::ThreadPool *pool, const HXL::DeserializationOptions &options) {
+    ProcessResult result = resolve(pool);
+    if (!result.errors.empty()) {
+        return result;
+    }
+
+    // The document was created by ``resolve``, and isn't shared yet
+    auto document = std::const_pointer_cast<Document>(result.document);
+    ErrorList errors;
+    result.performanceResults.deserialization = measureStage("deserialization", [&]() {
+        errors = Deserializer::deserialize(*compiledProtocol, document, options, deserializationBuffers);
+    });
+    if (!errors.empty()) {
+        return {.errors = errors};
+    }
+    result.performanceResults.deserialization->counters = result.performanceResults.transformer->counters;
+
+    return result;
+}
+
+HXL::ProcessResult HXL::Project::resolve(HXL::ThreadPool *pool) {
+    PerformanceResults performanceResults;
+
+    // Only the files, which are new or have changed since they were
+    // parsed, are parsed (again)
+    std::vector<File *> changed;
+    for (File &file: files) {
+        if (file.changed) {
+            changed.push_back(&file);
+        }
+    }
+    parses += changed.size();
+
+    std::vector<PerformanceResults> parsePerformance(changed.size());
+    if (pool && changed.size() > 1) {
+        TaskGroup tasks(*pool);
+        for (size_t i = 0; i < changed.size(); ++i) {
+            tasks.run([this, &changed, &parsePerformance, i]() {
+                parse(*changed[i], parsePerformance[i]);
+            });
+        }
+        tasks.wait();
+    } else {
+        for (size_t i = 0; i < changed.size(); ++i) {
+            parse(*changed[i], parsePerformance[i]);
+        }
+    }
+    for (const PerformanceResults &results: parsePerformance) {
+        performanceResults += results;
+    }
+
+    ErrorList errors;
+    for (const File &file: files) {
+        if (file.error.has_value()) {
+            errors.push_back(file.error.value());
+        }
+    }
+    if (!errors.empty()) {
+        return {.errors = errors};
+    }
+
+    // The linking is counted as part of the semantic analysis
+    std::shared_ptr<Document> document;
+    performanceResults.semanticAnalysis = measureStage("semanticAnalysis", [&]() {
+        document = link(errors);
+        if (errors.empty()) {
+            errors = SemanticAnalyzer::analyze(document);
+        }
+    });
+    if (!errors.empty()) {
+        return {.errors = errors};
+    }
+
+    // Only the changed files are tokenized and parsed, while all of them
+    // are linked, so the later stages count the linked document
+    size_t bytes = 0;
+    for (const File &file: files) {
+        bytes += file.source.size();
+    }
+    performanceResults.semanticAnalysis->counters = count(*compiledSchema, document->nodes, 0, document->nodes.size());
+    performanceResults.semanticAnalysis->counters.bytes = bytes;
+
+    // Required properties may be inherited from other files, so they're
+    // checked once the inheritance is resolved
+    performanceResults.transformer = measureStage("transformer", [&]() {
+        NodeIndex nodeIndex;
+        Transformer::transform(document, nodeIndex);
+        for (const Node &node: document->nodes) {
+            std::optional<Error> error = Parser::checkRequired(*compiledSchema, document->nodes, nodeIndex, node);
+            if (error.has_value()) {
+                errors.push_back(error.value());
+            }
+        }
+    });
+    if (!errors.empty()) {
+        return {.errors = errors};
+    }
+
+    performanceResults.transformer->counters = count(*compiledSchema, document->nodes, 0, document->nodes.size());
+    performanceResults.transformer->counters.bytes = bytes;
+
+    return {
+            .performanceResults = performanceResults,
+            .document = document,
+    };
+}
+
+void HXL::Project::parse(HXL::Project::File &file, HXL::PerformanceResults &performanceResults) const {
+    HXL_TRACE_SPAN(file.name, "file");
+    std::vector<Token> tokens;
+    std::optional<Error> error;
+    performanceResults.tokenization = measureStage("tokenization", [&]() {
+        error = Tokenizer::tokenize(file.source, tokens);
+    });
+
+    performanceResults.tokenization->counters = {.bytes = file.source.size(), .tokens = tokens.size()};
+
+    auto document = std::make_shared<Document>();
+    if (!error.has_value()) {
+        NodeIndex nodeIndex;
+        performanceResults.parsing = measureStage("parsing", [&]() {
+            error = Parser::parsePart(tokens, *compiledSchema, *document, nodeIndex, true, false);
+        });
+        performanceResults.parsing->counters = count(*compiledSchema, document->nodes, 0, document->nodes.size());
+        performanceResults.parsing->counters.bytes = file.source.size();
+        performanceResults.parsing->counters.tokens = tokens.size();
+    }
+
+    file.changed = false;
+    if (error.has_value()) {
+        file.document = nullptr;
+        file.error = Error{error->errorCode, std::format("{}: {}", file.name, error->message)};
+    } else {
+        file.document = std::move(document);
+        file.error = std::nullopt;
+    }
+}
+
+std::shared_ptr<HXL::Document> HXL::Project::link(HXL::ErrorList &errors) const {
+    // The nodes of all files, in the order of the files, with their strings
+    // moved to the storage of the linked document
+    auto document = std::make_shared<Document>();
+    std::vector<Node> nodes;
+    std::vector<size_t> fileOf;
+    for (size_t f = 0; f < files.size(); ++f) {
+        const Document &fileDocument = *files[f].document;
+        uint32_t base = static_cast<uint32_t>(document->strings.size());
+        document->strings += fileDocument.strings;
+
+        for (const Node &node: fileDocument.nodes) {
+            Node &copy = nodes.emplace_back(node);
+            fileOf.push_back(f);
+            for (NodeProperty &property: copy.properties) {
+                if (property.dataType == DataType::String || property.dataType == DataType::NodeRef) {
+                    for (PropertyScalar &value: property.values) {
+                        value.string.offset += base;
+                    }
+                }
+            }
+        }
+    }
+
+    // The symbol table of all files. Nodes with the same name are reported
+    // by the semantic analysis, so the first is used here.
+    NodeIndex symbols;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        symbols.insert(nodes, i);
+    }
+
+    // The nodes each node inherits and references, which must be ordered
+    // before it. Names which aren't found are left to the semantic analysis.
+    std::vector<size_t> dependencies;
+    std::vector<size_t> offsets;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        offsets.push_back(dependencies.size());
+        const Node &node = nodes[i];
+
+        if (node.inheritance.has_value()) {
+            std::optional<size_t> parent = symbols.find(nodes, node.inheritance->from);
+            if (parent.has_value() && parent.value() != i) {
+                dependencies.push_back(parent.value());
+
+                // Slots are specific to the node type (as checked by the parser within a file)
+                if (nodes[parent.value()].typeId != node.typeId) {
+                    errors.push_back({
+                            .errorCode = ErrorCode::HXL_INHERIT_DIFF_TYPES,
+                            .message = std::format("{}: Node {} cannot inherit {} of a different type.",
+                                                   files[fileOf[i]].name,
+                                                   node.name,
+                                                   node.inheritance->from),
+                    });
+                }
+            }
+        }
+
+        for (const NodeProperty &property: node.properties) {
+            if (property.dataType != DataType::NodeRef) {
+                continue;
+            }
+            for (const PropertyScalar &value: property.values) {
+                std::optional<size_t> target = symbols.find(nodes, document->text(value.string));
+                if (target.has_value() && target.value() != i) {
+                    dependencies.push_back(target.value());
+                }
+            }
+        }
+    }
+    offsets.push_back(dependencies.size());
+
+    if (!errors.empty()) {
+        return nullptr;
+    }
+
+    // Order the nodes depth-first, so every node comes after its dependencies,
+    // and otherwise keeps its place. A dependency, which is still being visited
+    // when it's met again, closes a cycle.
+    enum class Mark : uint8_t {
+        None,
+        Visiting,
+        Done,
+    };
+    std::vector<Mark> marks(nodes.size(), Mark::None);
+    std::vector<size_t> order;
+    order.reserve(nodes.size());
+
+    // Nodes being visited, and how many of their dependencies have been followed
+    std::vector<std::pair<size_t, size_t>> stack;
+    for (size_t root = 0; root < nodes.size(); ++root) {
+        if (marks[root] != Mark::None) {
+            continue;
+        }
+
+        marks[root] = Mark::Visiting;
+        stack.emplace_back(root, 0);
+        while (!stack.empty()) {
+            size_t current = stack.back().first;
+            size_t next = offsets[current] + stack.back().second;
+            if (next == offsets[current + 1]) {
+                marks[current] = Mark::Done;
+                order.push_back(current);
+                stack.pop_back();
+                continue;
+            }
+
+            ++stack.back().second;
+            size_t dependency = dependencies[next];
+            if (marks[dependency] == Mark::Visiting) {
+                errors.push_back({
+                        .errorCode = ErrorCode::HXL_CIRCULAR_NODE_REFERENCE,
+                        .message = std::format("{}: Node {} references or inherits {}, which depends on it in return.",
+                                               files[fileOf[current]].name,
+                                               nodes[current].name,
+                                               nodes[dependency].name),
+                });
+                return nullptr;
+            }
+            if (marks[dependency] == Mark::None) {
+                marks[dependency] = Mark::Visiting;
+                stack.emplace_back(dependency, 0);
+            }
+        }
+    }
+
+    document->nodes.reserve(nodes.size());
+    for (size_t i: order) {
+        document->nodes.push_back(std::move(nodes[i]));
+    }
+
+    return document;
+}
@@ -0,0 +1,20 @@
+#include "hxl-lang/services/schema-compiler.h"
+
+HXL::CompiledSchema HXL::SchemaCompiler::compile(const HXL::Schema &schema) {
+    CompiledSchema compiled{.schema = schema};
+
+    compiled.typeIds.reserve(schema.types.size());
+    compiled.slots.resize(schema.types.size());
+
+    for (TypeId typeId = 0; typeId < schema.types.size(); ++typeId) {
+        const SchemaNodeType &nodeType = schema.types[typeId];
+        compiled.typeIds.emplace(nodeType.name, typeId);
+
+        compiled.slots[typeId].reserve(nodeType.properties.size());
+        for (SlotId slot = 0; slot < nodeType.properties.size(); ++slot) {
+            compiled.slots[typeId].emplace(nodeType.properties[slot].name, slot);
+        }
+    }
+
+    return compiled;
+}
@@ -1,18 +1,33 @@
 #include "hxl-lang/services/schema-validator.h"
+#include "hxl-lang/services/schema-compiler.h"
+#include "hxl-lang/utilities/helpers.h"
+
+/**
+ * Check if a value parsed as ``actual`` can be stored in a property
+ * declared as ``expected``. Apart from exact matches, integers are
+ * accepted where floats are expected.
+ *
+ * @param actual
+ * @param expected
+ * @return
+ */
+inline bool isCompatible(HXL::DataType actual, HXL::DataType expected) {
+    return actual == expected || (actual == HXL::DataType::Int && expected == HXL::DataType::Float);
+}
 
 HXL::ErrorList HXL::SchemaValidator::validate(const HXL::Schema &schema, const std::shared_ptr<Document> &document) {
+    return validate(SchemaCompiler::compile(schema), document);
+}
+
+HXL::ErrorList HXL::SchemaValidator::validate(const HXL::CompiledSchema &schema, const std::shared_ptr<Document> &document) {
     ErrorList errors;
 
-    for (const Node &node: document->nodes) {
+    for (Node &node: document->nodes) {
         // Look for the node type in the schema
-        auto it = std::find_if(schema.types.begin(),
-                               schema.types.end(),
-                               [&](const SchemaNodeType &nodeType) -> bool {
-                                   return nodeType.name == node.type;
-                               });
+        std::optional<TypeId> typeId = schema.findType(node.type);
 
         // If the type isn't found, it's an error.
-        if (it == schema.types.end()) {
+        if (!typeId.has_value()) {
             errors.push_back({
                     .errorCode = ErrorCode::HXL_UNKNOWN_NODE_TYPE,
                     .message = std::format("Node type not declared in schema: {}", node.type),
@@ -22,37 +37,30 @@ HXL::ErrorList HXL::SchemaValidator::validate(const HXL::Schema &schema, const s
             continue;
         }
 
-        SchemaNodeType schemaForNode = *it;
+        node.typeId = typeId;
+        const SchemaNodeType &schemaForNode = schema.type(typeId.value());
 
         // Iterate through the node's properties and verify against the schema
-        for (const NodeProperty &nodeProperty: node.properties) {
-            auto npIt = std::find_if(schemaForNode.properties.begin(),
-                                     schemaForNode.properties.end(),
-                                     [&](const SchemaNodeProperty &item) {
-                                         return item.name == nodeProperty.name;
-                                     });
-
-            if (npIt == schemaForNode.properties.end()) {
+        for (NodeProperty &nodeProperty: node.properties) {
+            std::optional<SlotId> slot = schema.findSlot(typeId.value(), nodeProperty.name);
+
+            if (!slot.has_value()) {
                 errors.push_back({
                         .errorCode = ErrorCode::HXL_UNKNOWN_PROPERTY,
                         .message = std::format("Node {} has an unknown property: {}", node.name, nodeProperty.name),
                 });
+                continue;
             }
 
-            std::for_each(schemaForNode.properties.begin(),
-                          schemaForNode.properties.end(),
-                          [&](const SchemaNodeProperty &schemaNodeProperty) {
-                              if (schemaNodeProperty.name != nodeProperty.name) {
-                                  return;
-                              }
-
-                              if (schemaNodeProperty.structure == ValueStructure::Single && nodeProperty.values.size() != 1) {
-                                  errors.push_back({
-                                          .errorCode = ErrorCode::HXL_ILLEGAL_DATA_TYPE,
-                                          .message = std::format("Property not declared as array: {}", nodeProperty.name),
-                                  });
-                              }
-                          });
+            nodeProperty.slot = slot;
+
+            std::optional<Error> error = checkProperty(schemaForNode.properties[slot.value()],
+                                                       node,
+                                                       nodeProperty,
+                                                       document->strings);
+            if (error.has_value()) {
+                errors.push_back(error.value());
+            }
         }
 
         // Iterate through the properties defined in the schema
@@ -78,3 +86,61 @@ HXL::ErrorList HXL::SchemaValidator::validate(const HXL::Schema &schema, const s
 
     return errors;
 }
+
+std::optional<HXL::Error> HXL::SchemaValidator::checkProperty(const HXL::SchemaNodeProperty &schemaNodeProperty,
+                                                              const HXL::Node &node,
+                                                              HXL::NodeProperty &nodeProperty,
+                                                              std::string_view strings) {
+    if (schemaNodeProperty.structure == ValueStructure::Single && nodeProperty.values.size() != 1) {
+        return Error{
+                .errorCode = ErrorCode::HXL_ILLEGAL_DATA_TYPE,
+                .message = std::format("Property not declared as array: {}", nodeProperty.name),
+        };
+    }
+
+    if (!isCompatible(nodeProperty.dataType, schemaNodeProperty.dataType)) {
+        return Error{
+                .errorCode = ErrorCode::HXL_ILLEGAL_DATA_TYPE,
+                .message = std::format("[Line {}, Col {}] Property {} on node {} must be {}, got {}",
+                                       nodeProperty.position.line,
+                                       nodeProperty.position.col,
+                                       nodeProperty.name,
+                                       node.name,
+                                       Helpers::toString(schemaNodeProperty.dataType),
+                                       Helpers::toString(nodeProperty.dataType)),
+        };
+    }
+
+    // The schema decides whether the value is delivered as an array
+    nodeProperty.structure = schemaNodeProperty.structure;
+
+    // Arrays of numbers which were parsed in bulk are already converted,
+    // and so are values which have been validated before. Only integers
+    // may need to be widened to floats.
+    if (nodeProperty.value.has_value()) {
+        const auto *ints = std::get_if<std::vector<int>>(&nodeProperty.value.value());
+        if (ints && schemaNodeProperty.dataType == DataType::Float) {
+            nodeProperty.value = std::vector<float>(ints->begin(), ints->end());
+        }
+        return std::nullopt;
+    }
+
+    // Strings are already in their final form, in the document's storage.
+    // Whether they're copied is up to the Deserializer.
+    if (schemaNodeProperty.dataType == DataType::String) {
+        return std::nullopt;
+    }
+
+    // The type is confirmed, so we convert the value to its final form
+    // right away, while the property is still hot.
+    Result<DeserializedValue> value = Helpers::toValue(nodeProperty,
+                                                       schemaNodeProperty.dataType,
+                                                       schemaNodeProperty.structure,
+                                                       strings);
+    if (value.isErr()) {
+        return value.error();
+    }
+    nodeProperty.value = std::move(std::get<DeserializedValue>(value));
+
+    return std::nullopt;
+}
@@ -1,21 +1,36 @@
 #include "hxl-lang/services/semantic-analyzer.h"
-#include <unordered_set>
+#include <algorithm>
+#include <string_view>
 
 HXL::ErrorList HXL::SemanticAnalyzer::analyze(const std::shared_ptr<Document> &document) {
+    NodeIndex seenNames;
+    return analyze(document, seenNames);
+}
+
+HXL::ErrorList HXL::SemanticAnalyzer::analyze(const std::shared_ptr<Document> &document, HXL::NodeIndex &seenNames) {
+    seenNames.clear();
+    return analyze(*document, seenNames, 0, document->nodes.size());
+}
+
+HXL::ErrorList HXL::SemanticAnalyzer::analyze(const HXL::Document &document,
+                                              HXL::NodeIndex &seenNames,
+                                              size_t begin,
+                                              size_t end) {
     ErrorList errors;
 
     // NODE.200: Node name uniqueness
     // NODE.201: Node property uniqueness
 
-    std::unordered_set<std::string> seenNames;
-    for (const Node &node: document->nodes) {
-        if (seenNames.find(node.name) != seenNames.end()) {
+    // Nodes are added as they're seen, so only the nodes declared
+    // before the current one can be found
+    const std::vector<Node> &nodes = document.nodes;
+    for (size_t i = begin; i < end; ++i) {
+        const Node &node = nodes[i];
+        if (!seenNames.insert(nodes, i)) {
             errors.push_back({
                                      .errorCode = ErrorCode::HXL_NON_UNIQUE_NODE,
                                      .message = std::format("Node name \"{}\" is not unique.", node.name),
                              });
-        } else {
-            seenNames.insert(node.name);
         }
 
         if (node.inheritance.has_value()) {
@@ -24,25 +39,25 @@ HXL::ErrorList HXL::SemanticAnalyzer::analyze(const std::shared_ptr<Document> &d
                                          .errorCode = ErrorCode::HXL_ILLEGAL_INHERITANCE,
                                          .message = std::format("Node {} cannot inherit itself.", node.name),
                                  });
-            } else {
-                auto findInhr = seenNames.find(node.inheritance.value().from);
-                if (findInhr == seenNames.end()) {
-                    errors.push_back({
-                                             .errorCode = ErrorCode::HXL_ILLEGAL_INHERITANCE,
-                                             .message = std::format(
-                                                     "Node {} attempts to inherit {} which does not exist.",
-                                                     node.name,
-                                                     node.inheritance.value().from),
-                                     });
-                }
+            } else if (!seenNames.find(nodes, node.inheritance.value().from).has_value()) {
+                errors.push_back({
+                                         .errorCode = ErrorCode::HXL_ILLEGAL_INHERITANCE,
+                                         .message = std::format(
+                                                 "Node {} attempts to inherit {} which does not exist.",
+                                                 node.name,
+                                                 node.inheritance.value().from),
+                                 });
             }
         }
 
-        std::vector<std::string> foundPropKeys;
-        for (const NodeProperty &nodeProperty: node.properties) {
-            // If the property key is already on the list of found ones, then it's
+        for (auto it = node.properties.begin(); it != node.properties.end(); ++it) {
+            const NodeProperty &nodeProperty = *it;
+
+            // If the property key is already among the ones before it, then it's
             // definitely not unique
-            if (std::find(foundPropKeys.begin(), foundPropKeys.end(), nodeProperty.name) != foundPropKeys.end()) {
+            if (std::any_of(node.properties.begin(), it, [&](const NodeProperty &item) {
+                    return item.name == nodeProperty.name;
+                })) {
                 errors.push_back({
                                          .errorCode = ErrorCode::HXL_NON_UNIQUE_PROPERTY,
                                          .message = std::format(R"(Property "{}" under "{}" is not unique.)",
@@ -50,11 +65,10 @@ HXL::ErrorList HXL::SemanticAnalyzer::analyze(const std::shared_ptr<Document> &d
                                                                 node.name),
                                  });
             }
-            foundPropKeys.push_back(nodeProperty.name);
 
             if (nodeProperty.dataType == DataType::NodeRef) {
-                auto referencedNode = nodeProperty.values[0];
-                auto findRef = seenNames.find(referencedNode);
+                std::string_view referencedNode = document.text(nodeProperty.values[0].string);
+                bool found = seenNames.find(nodes, referencedNode).has_value();
                 if (node.name == referencedNode) {
                     errors.push_back({
                                              .errorCode = ErrorCode::HXL_ILLEGAL_REFERENCE,
@@ -62,7 +76,7 @@ HXL::ErrorList HXL::SemanticAnalyzer::analyze(const std::shared_ptr<Document> &d
                                                                     node.name,
                                                                     nodeProperty.name),
                                      });
-                } else if (findRef == seenNames.end()) {
+                } else if (!found) {
                     errors.push_back({
                                              .errorCode = ErrorCode::HXL_NODE_REFERENCE_NOT_FOUND,
                                              .message = std::format(
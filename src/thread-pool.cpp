@@ -0,0 +1,170 @@
+#include "hxl-lang/utilities/thread-pool.h"
+
+#include <algorithm>
+
+namespace {
+    /**
+     * Index of the pool queue owned by the current thread.
+     * Threads outside a pool have no queue.
+     */
+    thread_local const HXL::ThreadPool *currentPool = nullptr;
+    thread_local size_t currentQueue = 0;
+}
+
+HXL::ThreadPool::ThreadPool(size_t threadCount) {
+    threadCount = std::max<size_t>(threadCount, 1);
+
+    for (size_t i = 0; i < threadCount; ++i) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads.emplace_back(&ThreadPool::work, this, i);
+    }
+}
+
+HXL::ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (std::thread &thread: threads) {
+        thread.join();
+    }
+}
+
+void HXL::ThreadPool::submit(std::function<void()> task) {
+    // Tasks submitted by a worker stay on its own queue, while the
+    // ones from outside are distributed round-robin.
+    size_t index = currentPool == this
+                           ? currentQueue
+                           : nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+
+    // The task is counted before it's published, so a worker taking it
+    // can never count it off first. The count is raised under the sleep
+    // mutex, so a worker can't miss it between checking it and waiting.
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        pending.fetch_add(1);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    wake.notify_one();
+}
+
+bool HXL::ThreadPool::runPending() {
+    std::function<void()> task;
+    if (!take(currentPool == this ? currentQueue : 0, task)) {
+        return false;
+    }
+    task();
+    return true;
+}
+
+size_t HXL::ThreadPool::size() const {
+    return threads.size();
+}
+
+void HXL::ThreadPool::work(size_t index) {
+    currentPool = this;
+    currentQueue = index;
+
+    std::function<void()> task;
+    while (true) {
+        if (take(index, task)) {
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [&]() { return stopping || pending.load() > 0; });
+        if (stopping && pending.load() == 0) {
+            return;
+        }
+    }
+}
+
+bool HXL::ThreadPool::take(size_t index, std::function<void()> &task) {
+    // First, the back of our own queue...
+    {
+        Queue &own = *queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            pending.fetch_sub(1);
+            return true;
+        }
+    }
+
+    // ... then steal from the front of the others
+    for (size_t i = 1; i < queues.size(); ++i) {
+        Queue &other = *queues[(index + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(other.mutex);
+        if (!other.tasks.empty()) {
+            task = std::move(other.tasks.front());
+            other.tasks.pop_front();
+            pending.fetch_sub(1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+HXL::TaskGroup::TaskGroup(HXL::ThreadPool &pool) : pool(pool) {
+}
+
+HXL::TaskGroup::~TaskGroup() {
+    try {
+        wait();
+    } catch (...) {
+    }
+}
+
+void HXL::TaskGroup::run(std::function<void()> task) {
+    remaining.fetch_add(1);
+    pool.submit([this, task = std::move(task)]() {
+        try {
+            task();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!exception) {
+                exception = std::current_exception();
+            }
+        }
+        finish();
+    });
+}
+
+void HXL::TaskGroup::wait() {
+    while (remaining.load() > 0) {
+        if (pool.runPending()) {
+            continue;
+        }
+
+        // Nothing to help with, so the remaining tasks are already running
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&]() { return remaining.load() == 0; });
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (exception) {
+        std::exception_ptr thrown = exception;
+        exception = nullptr;
+        std::rethrow_exception(thrown);
+    }
+}
+
+void HXL::TaskGroup::finish() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (remaining.fetch_sub(1) == 1) {
+        done.notify_all();
+    }
+}
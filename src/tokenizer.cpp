@@ -1,13 +1,60 @@
 #include "hxl-lang/services/tokenizer.h"
+#include <bit>
 #include <iostream>
 
-uint8_t HXL::Tokenizer::indentSize = 4;
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
-HXL::TokenizerResult HXL::Tokenizer::tokenize(const std::string &source) {
+HXL::TokenizerResult HXL::Tokenizer::tokenize(const std::string &source,
+                                              const HXL::TokenizerOptions &options,
+                                              const HXL::ResourceLimits &limits) {
+    std::vector<Token> tokens;
+
+    // Allocate memory in advance, which is a reasonable expectation
+    // for most HXL sources. Avoid unnecessary re-allocations early in the parsing.
+    tokens.reserve(200);
+
+    std::optional<Error> error = tokenize(source, tokens, options, limits);
+    if (error.has_value()) {
+        return error.value();
+    }
+    return tokens;
+}
+
+std::optional<HXL::Error> HXL::Tokenizer::tokenize(const std::string &source,
+                                                   std::vector<Token> &tokens,
+                                                   const HXL::TokenizerOptions &options,
+                                                   const HXL::ResourceLimits &limits) {
+    return tokenize(source, tokens, 1, options, limits);
+}
+
+std::optional<HXL::Error> HXL::Tokenizer::tokenize(std::string_view source,
+                                                   std::vector<Token> &tokens,
+                                                   uint16_t firstLine,
+                                                   const HXL::TokenizerOptions &options,
+                                                   const HXL::ResourceLimits &limits) {
+    NoProbes probes;
+    return tokenize(source, tokens, firstLine, options, limits, probes);
+}
+
+template<typename Probes>
+std::optional<HXL::Error> HXL::Tokenizer::tokenize(std::string_view source,
+                                                   std::vector<Token> &tokens,
+                                                   uint16_t firstLine,
+                                                   const HXL::TokenizerOptions &options,
+                                                   const HXL::ResourceLimits &limits,
+                                                   Probes &probes) {
     // Shorthand for readability
     typedef BufferLooksLike BLL;
 
-    std::vector<Token> tokens;
+    // Tokens left in the vector are overwritten, so the memory
+    // of their values is re-used
+    TokenWriter emit{tokens, limits.maxTokens};
+
+    // Most tokens fit within the small string optimization, so the
+    // buffer rarely allocates. String literals and comments aren't
+    // collected in it.
     std::string buffer;
     char peek, prev;
 
@@ -18,12 +65,10 @@ HXL::TokenizerResult HXL::Tokenizer::tokenize(const std::string &source) {
         Comment,
     } context = Context::Indentation;
 
-    BufferLooksLike bufferLooksLike = BufferLooksLike::Empty;
+    // The number of spaces seen at the beginning of the current line
+    size_t indentation = 0;
 
-    // Allocate memory in advance, which is a reasonable expectation
-    // for most HXL sources. Avoid unnecessary re-allocations early in the parsing.
-    tokens.reserve(200);
-    buffer.reserve(50);
+    BufferLooksLike bufferLooksLike = BufferLooksLike::Empty;
 
     // In a few spots we fast-forward the iterator, i, therefore we cannot
     // safely increment it in the same fashion as line number is incremented,
@@ -32,11 +77,27 @@ HXL::TokenizerResult HXL::Tokenizer::tokenize(const std::string &source) {
     uint16_t colOffset = 0;
 
     // Initial cursor position in source
-    SourcePosition pos{1, 1};
+    SourcePosition pos{firstLine, 1};
+
+    auto tooManyTokens = [&]() -> Error {
+        return {ErrorCode::HXL_TOO_MANY_TOKENS,
+                std::format("[Line {}] Source exceeds the limit of tokens", pos.line)};
+    };
+    auto tooLong = [&]() -> Error {
+        return {ErrorCode::HXL_STRING_TOO_LONG,
+                std::format("[Line {}, Col {}] String exceeds the limit of {} characters",
+                            pos.line,
+                            pos.col,
+                            limits.maxStringLength)};
+    };
 
     // Used to indicate when the rest of a line should be ignored
     // Used to strip comments from the tokenization process
     bool ignoreRemainderOfLine = false;
+    size_t commentLength = 0;
+
+    // Where the string literal, which is currently being read, begins
+    size_t literalStart = 0;
 
     for (int i = 0; i < source.length(); ++i) {
         const char c = source[i];
@@ -49,24 +110,33 @@ HXL::TokenizerResult HXL::Tokenizer::tokenize(const std::string &source) {
             if (c == '\n') {
                 ignoreRemainderOfLine = false;
             } else {
-                buffer += c;
+                ++commentLength;
                 continue;
             }
         }
 
         // When the cursor is between two quotation marks, we continue
-        // to add to the buffer, until we meet the second quotation
+        // until we meet the second quotation, and take the literal
+        // straight from the source
         if (context == Context::StringLiteral) {
             if (c == '"') {
                 context = Context::None;
-                tokens.push_back({T::T_STRING_LITERAL, buffer, pos});
-                buffer.clear();
+                if (i - literalStart + buffer.size() > limits.maxStringLength) {
+                    return tooLong();
+                }
+                std::string_view literal = source.substr(literalStart, i - literalStart);
+                probes.record(&StageProbes::literalBytes, literal.size());
+                if (buffer.empty()) {
+                    emit(T::T_STRING_LITERAL, literal, pos);
+                } else {
+                    buffer += literal;
+                    emit(T::T_STRING_LITERAL, buffer, pos);
+                    buffer.clear();
+                }
             } else if (c == '\n') {
                 return Error{
                         ErrorCode::HXL_ILLEGAL_WHITESPACE,
                         std::format("[Line {}, Col {}] Illegal whitespace", pos.line, pos.col)};
-            } else {
-                buffer += c;
             }
 
             continue;
@@ -109,82 +179,105 @@ HXL::TokenizerResult HXL::Tokenizer::tokenize(const std::string &source) {
                     }
 
                     ignoreRemainderOfLine = true;
+                    commentLength = 0;
                     context = Context::Comment;
                     break;
 
                 // Delimiters
                 case '<':
-                    handleBuffer(buffer, tokens, bufferLooksLike, pos);
+                    handleBuffer(buffer, emit, bufferLooksLike, pos);
                     if (peek == '=') {
-                        tokens.push_back({T::T_DELIMITER, "<=", pos});
+                        emit(T::T_DELIMITER, "<=", pos);
                         ++i;
                     } else {
-                        tokens.push_back({T::T_DELIMITER, charToStr(c), pos});
+                        emit(T::T_DELIMITER, charToStr(c), pos);
                     }
                     break;
                 case '>':
                 case ':':
                 case ',':
                 case '&':
-                    handleBuffer(buffer, tokens, bufferLooksLike, pos);
-                    tokens.push_back({T::T_DELIMITER, charToStr(c), pos});
+                    handleBuffer(buffer, emit, bufferLooksLike, pos);
+                    emit(T::T_DELIMITER, charToStr(c), pos);
                     break;
                 case '[':
-                    handleBuffer(buffer, tokens, bufferLooksLike, pos);
+                    handleBuffer(buffer, emit, bufferLooksLike, pos);
                     if (peek == ']') {
-                        tokens.push_back({T::T_DELIMITER, "[]", pos});
+                        emit(T::T_DELIMITER, "[]", pos);
                         ++i;
                     } else {
-                        tokens.push_back({T::T_DELIMITER, charToStr(c), pos});
+                        emit(T::T_DELIMITER, charToStr(c), pos);
                     }
                     break;
 
                     // String literal
                 case '"':
                     context = Context::StringLiteral;
+                    literalStart = i + 1;
                     break;
 
                     // Punctuators
-                case '{':
+                case '{': {
+                    emit(T::T_PUNCTUATOR, charToStr(c), pos);
+
+                    // Large arrays of numbers are taken in one go. The parser
+                    // converts them straight to a typed buffer.
+                    size_t end = scanNumericArray(source, i + 1);
+                    if (end != std::string::npos && end - i > numericArrayMinLength &&
+                        isWellFormedNumericArray(source.substr(i + 1, end - i - 1), limits.maxStringLength)) {
+                        SourcePosition endPos{pos.line, static_cast<uint16_t>(end - colOffset)};
+                        emit(T::T_NUMERIC_ARRAY, source.substr(i + 1, end - i - 1), endPos);
+                        emit(T::T_PUNCTUATOR, "}", endPos);
+                        probes.record(&StageProbes::numericArrayBytes, end - i - 1);
+                        i = static_cast<int>(end);
+                    }
+                    break;
+                }
                 case '}':
-                    tokens.push_back({T::T_PUNCTUATOR, charToStr(c), pos});
+                    emit(T::T_PUNCTUATOR, charToStr(c), pos);
                     break;
 
                     // Whitespace
                 case '\t':
-                    tokens.push_back({T::T_TAB, std::nullopt, pos});
+                    emit(T::T_TAB, std::nullopt, pos);
                     break;
                 case '\n':
                     if (context == Context::Comment) {
                         // CMT.004
-                        // Comments cannot be empty
-                        if (buffer.empty() || buffer == " ") {
+                        // Comments cannot be empty (a comment always starts
+                        // with the whitespace after #)
+                        if (commentLength <= 1) {
                             return Error{
                                     ErrorCode::HXL_ILLEGAL_COMMENT,
                                     std::format("[Line {}] Illegal comment", pos.line)};
                         }
-
-                        // Empty whatever has been collected in comment context
-                        buffer.clear();
+                        probes.record(&StageProbes::commentBytes, commentLength + 1);
                     }
 
-                    handleBuffer(buffer, tokens, bufferLooksLike, pos);
-                    tokens.push_back({T::T_NEWLINE, std::nullopt, pos});
+                    handleBuffer(buffer, emit, bufferLooksLike, pos);
+                    emit(T::T_NEWLINE, std::nullopt, pos);
+                    if (emit.exceeded) {
+                        return tooManyTokens();
+                    }
                     ++pos.line;
                     colOffset = i - 1;
                     context = Context::Indentation;
+                    indentation = 0;
+                    if (options.stopToken.stop_requested()) {
+                        return Error{ErrorCode::HXL_CANCELLED, "Processing was cancelled."};
+                    }
                     break;
                 case ' ':
                     if (context == Context::Indentation) {
-                        if (pos.col == 5) {
-                            tokens.push_back({T::T_TAB, std::nullopt, pos});
+                        if (++indentation == options.indentSize) {
+                            emit(T::T_TAB, std::nullopt, pos);
                             context = Context::None;
                         }
                     } else if (peek == '#') {
-                        handleBuffer(buffer, tokens, bufferLooksLike, pos);
+                        handleBuffer(buffer, emit, bufferLooksLike, pos);
                     } else {
-                        handleBuffer(buffer, tokens, bufferLooksLike, pos);
-                        tokens.push_back({T::T_WHITESPACE, std::nullopt, pos});
+                        handleBuffer(buffer, emit, bufferLooksLike, pos);
+                        emit(T::T_WHITESPACE, std::nullopt, pos);
                     }
                     break;
 
@@ -212,6 +305,9 @@ HXL::TokenizerResult HXL::Tokenizer::tokenize(const std::string &source) {
                                 std::format("[Line {}] Unexpected token: {}", pos.line, c)};
                     }
 
+                    if (buffer.size() == limits.maxStringLength) {
+                        return tooLong();
+                    }
                     buffer += c;
             }
         } catch (SyntaxError &e) {
@@ -220,7 +316,112 @@ HXL::TokenizerResult HXL::Tokenizer::tokenize(const std::string &source) {
         }
     }
 
-    return tokens;
+    if (emit.exceeded) {
+        return tooManyTokens();
+    }
+    emit.finish();
+
+    return std::nullopt;
+}
+
+template std::optional<HXL::Error> HXL::Tokenizer::tokenize(std::string_view,
+                                                            std::vector<Token> &,
+                                                            uint16_t,
+                                                            const HXL::TokenizerOptions &,
+                                                            const HXL::ResourceLimits &,
+                                                            HXL::NoProbes &);
+
+template std::optional<HXL::Error> HXL::Tokenizer::tokenize(std::string_view,
+                                                            std::vector<Token> &,
+                                                            uint16_t,
+                                                            const HXL::TokenizerOptions &,
+                                                            const HXL::ResourceLimits &,
+                                                            HXL::StageProbes &);
+
+size_t HXL::Tokenizer::scanNumericArray(std::string_view source, size_t begin) {
+    auto isNumeric = [](char c) {
+        return (c >= '0' && c <= '9') || c == ',' || c == ' ' || c == '.' || c == '-';
+    };
+
+    size_t i = begin;
+
+#if defined(__SSE2__)
+    // Check 16 characters at a time, until one of them isn't
+    // part of a number (which is hopefully the closing brace)
+    const __m128i zero = _mm_set1_epi8('0'),
+                  nine = _mm_set1_epi8(9),
+                  comma = _mm_set1_epi8(','),
+                  space = _mm_set1_epi8(' '),
+                  dot = _mm_set1_epi8('.'),
+                  minus = _mm_set1_epi8('-');
+
+    for (; i + 16 <= source.size(); i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source.data() + i));
+        __m128i offset = _mm_sub_epi8(chunk, zero);
+        __m128i digits = _mm_cmpeq_epi8(_mm_min_epu8(offset, nine), offset);
+        __m128i others = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, comma), _mm_cmpeq_epi8(chunk, space)),
+                                      _mm_or_si128(_mm_cmpeq_epi8(chunk, dot), _mm_cmpeq_epi8(chunk, minus)));
+        int mask = _mm_movemask_epi8(_mm_or_si128(digits, others));
+        if (mask != 0xFFFF) {
+            i += std::countr_one(static_cast<unsigned>(mask));
+            return source[i] == '}' ? i : std::string::npos;
+        }
+    }
+#endif
+
+    for (; i < source.size(); ++i) {
+        if (!isNumeric(source[i])) {
+            return source[i] == '}' ? i : std::string::npos;
+        }
+    }
+
+    return std::string::npos;
+}
+
+bool HXL::Tokenizer::isWellFormedNumericArray(std::string_view contents, size_t maxLength) {
+    size_t i = 0;
+    auto skipWhitespace = [&]() {
+        while (i < contents.size() && contents[i] == ' ') {
+            ++i;
+        }
+    };
+    auto skipDigits = [&]() {
+        size_t begin = i;
+        while (i < contents.size() && contents[i] >= '0' && contents[i] <= '9') {
+            ++i;
+        }
+        return i > begin;
+    };
+
+    while (true) {
+        // A number: An optional minus, digits, and optionally a decimal
+        // point followed by digits
+        skipWhitespace();
+        size_t begin = i;
+        if (i < contents.size() && contents[i] == '-') {
+            ++i;
+        }
+        if (!skipDigits()) {
+            return false;
+        }
+        if (i < contents.size() && contents[i] == '.') {
+            ++i;
+            if (!skipDigits()) {
+                return false;
+            }
+        }
+        if (i - begin > maxLength) {
+            return false;
+        }
+
+        skipWhitespace();
+        if (i == contents.size()) {
+            return true;
+        } else if (contents[i] != ',') {
+            return false;
+        }
+        ++i;
+    }
 }
 
 std::string HXL::Tokenizer::charToStr(char c) {
@@ -228,7 +429,7 @@ std::string HXL::Tokenizer::charToStr(char c) {
 }
 
 void HXL::Tokenizer::handleBuffer(std::string &buffer,
-                                  std::vector<Token> &tokenList,
+                                  TokenWriter &emit,
                                   BufferLooksLike &bufferLooksLike,
                                   const SourcePosition &pos) {
     if (buffer.empty()) {
@@ -236,13 +437,13 @@ void HXL::Tokenizer::handleBuffer(std::string &buffer,
     }
 
     if (buffer == "true" || buffer == "false") {
-        tokenList.push_back({T::T_BOOL, buffer, pos});
+        emit(T::T_BOOL, buffer, pos);
     } else if (bufferLooksLike == BufferLooksLike::Integer) {
-        tokenList.push_back({T::T_INT, buffer, pos});
+        emit(T::T_INT, buffer, pos);
     } else if (bufferLooksLike == BufferLooksLike::Float) {
-        tokenList.push_back({T::T_FLOAT, buffer, pos});
+        emit(T::T_FLOAT, buffer, pos);
     } else if (bufferLooksLike == BufferLooksLike::Identifier) {
-        tokenList.push_back({T::T_IDENTIFIER, buffer, pos});
+        emit(T::T_IDENTIFIER, buffer, pos);
     } else {
         throw SyntaxError(std::format("Syntax error in: {}", buffer));
     }
@@ -250,3 +451,30 @@ void HXL::Tokenizer::handleBuffer(std::string &buffer,
     bufferLooksLike = BufferLooksLike::Empty;
     buffer.clear();
 }
+
+void HXL::Tokenizer::TokenWriter::operator()(HXL::TokenType tokenType,
+                                              std::optional<std::string_view> value,
+                                              const HXL::SourcePosition &position) {
+    if (count == limit) {
+        exceeded = true;
+        return;
+    }
+    if (count == tokens.size()) {
+        tokens.emplace_back();
+    }
+
+    Token &token = tokens[count++];
+    token.tokenType = tokenType;
+    token.position = position;
+    if (!value.has_value()) {
+        token.value.reset();
+    } else if (token.value.has_value()) {
+        token.value->assign(value.value());
+    } else {
+        token.value.emplace(value.value());
+    }
+}
+
+void HXL::Tokenizer::TokenWriter::finish() {
+    tokens.resize(count);
+}
@@ -0,0 +1,121 @@
+#include "hxl-lang/utilities/tracer.h"
+
+#include <format>
+#include <fstream>
+
+std::atomic<HXL::Tracer *> HXL::Tracer::current = nullptr;
+
+namespace {
+    std::atomic<uint32_t> nextThreadId = 1;
+
+    /**
+     * Escape a string for JSON.
+     */
+    std::string escape(std::string_view text) {
+        std::string escaped;
+        escaped.reserve(text.size());
+        for (char c: text) {
+            if (c == '"' || c == '\\') {
+                escaped += '\\';
+                escaped += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                escaped += ' ';
+            } else {
+                escaped += c;
+            }
+        }
+        return escaped;
+    }
+
+    std::string microseconds(int64_t ns) {
+        return std::format("{:.3f}", static_cast<double>(ns) / 1000.0);
+    }
+}
+
+HXL::Tracer::Tracer() : origin(std::chrono::steady_clock::now()) {
+}
+
+HXL::Tracer::~Tracer() {
+    end();
+}
+
+void HXL::Tracer::begin() {
+    current.store(this);
+}
+
+void HXL::Tracer::end() {
+    Tracer *expected = this;
+    current.compare_exchange_strong(expected, nullptr);
+}
+
+HXL::Tracer *HXL::Tracer::active() noexcept {
+    return current.load(std::memory_order_relaxed);
+}
+
+void HXL::Tracer::record(std::string_view name,
+                         std::string_view category,
+                         std::chrono::steady_clock::time_point start,
+                         std::chrono::steady_clock::time_point end) {
+    TraceEvent event{
+            .name = std::string(name),
+            .category = std::string(category),
+            .startNs = std::chrono::duration_cast<std::chrono::nanoseconds>(start - origin).count(),
+            .durationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count(),
+            .threadId = threadId(),
+    };
+
+    std::lock_guard<std::mutex> lock(mutex);
+    recorded.push_back(std::move(event));
+}
+
+std::vector<HXL::TraceEvent> HXL::Tracer::events() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return recorded;
+}
+
+std::string HXL::Tracer::toJson() const {
+    std::vector<TraceEvent> events = this->events();
+
+    std::string json = "{\"traceEvents\": [\n";
+    for (size_t i = 0; i < events.size(); ++i) {
+        const TraceEvent &event = events[i];
+        json += "  {\"name\": \"" + escape(event.name) +
+                "\", \"cat\": \"" + escape(event.category) +
+                "\", \"ph\": \"X\", \"ts\": " + microseconds(event.startNs) +
+                ", \"dur\": " + microseconds(event.durationNs) +
+                ", \"pid\": 1, \"tid\": " + std::to_string(event.threadId) + "}";
+        json += i + 1 < events.size() ? ",\n" : "\n";
+    }
+    return json + "], \"displayTimeUnit\": \"ns\"}\n";
+}
+
+std::optional<HXL::Error> HXL::Tracer::write(const std::filesystem::path &path) const {
+    std::ofstream stream(path, std::ios::binary);
+    if (!stream || !(stream << toJson())) {
+        return Error{
+                .errorCode = ErrorCode::HXL_CANNOT_WRITE_FILE,
+                .message = std::format("Cannot write file: {}", path.string()),
+        };
+    }
+    return std::nullopt;
+}
+
+uint32_t HXL::Tracer::threadId() noexcept {
+    thread_local const uint32_t id = nextThreadId.fetch_add(1);
+    return id;
+}
+
+HXL::TraceSpan::TraceSpan(std::string_view name, std::string_view category) noexcept
+    : tracer(Tracer::active()),
+      name(name),
+      category(category) {
+    if (tracer) {
+        start = std::chrono::steady_clock::now();
+    }
+}
+
+HXL::TraceSpan::~TraceSpan() {
+    if (tracer) {
+        tracer->record(name, category, start, std::chrono::steady_clock::now());
+    }
+}
@@ -14,14 +14,29 @@ HXL::Error HXL::Traits::HandlesErrors::unexpectedTokenError(const Token &token)
     };
 }
 
-HXL::ExecutionTime HXL::Traits::MeasuresExecutionTime::measure(const std::function<void()>& subject) {
-    auto start = std::chrono::high_resolution_clock::now();
+HXL::StageCounters HXL::Traits::MeasuresExecutionTime::count(const HXL::CompiledSchema &schema,
+                                                              const std::vector<Node> &nodes,
+                                                              size_t begin,
+                                                              size_t end) {
+    StageCounters counters{.nodes = end - begin};
+    for (size_t i = begin; i < end; ++i) {
+        const Node &node = nodes[i];
+        if (node.inheritance.has_value()) {
+            ++counters.inheritanceLinks;
+        }
 
-    subject();
-
-    auto end = std::chrono::high_resolution_clock::now();
-
-    return {
-            .ms = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count(),
-    };
+        counters.properties += node.properties.size();
+        for (const NodeProperty &property: node.properties) {
+            if (property.dataType == DataType::NodeRef) {
+                counters.references += property.values.size();
+            }
+            if (node.typeId.has_value() && property.slot.has_value()) {
+                const SchemaNodeProperty &definition = schema.schema.types[node.typeId.value()].properties[property.slot.value()];
+                if (definition.structure == ValueStructure::Array) {
+                    counters.arrayElements += property.values.size();
+                }
+            }
+        }
+    }
+    return counters;
 }
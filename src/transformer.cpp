@@ -1,39 +1,123 @@
 #include "hxl-lang/services/transformer.h"
+#include <format>
 
 
 void HXL::Transformer::transform(const std::shared_ptr<Document> &document) {
-    inheritanceResolution(document);
+    NodeIndex nodeIndex;
+    transform(document, nodeIndex);
 }
 
-void HXL::Transformer::inheritanceResolution(const std::shared_ptr<Document> &document) {
-    std::unordered_map<std::string, Node> nodeMap;
+std::optional<HXL::Error> HXL::Transformer::transform(const std::shared_ptr<Document> &document,
+                                                      HXL::NodeIndex &nodeIndex,
+                                                      const HXL::ResourceLimits &limits) {
+    nodeIndex.clear();
 
-    // Avoid re-allocation
-    nodeMap.reserve(document->nodes.size());
+    // Nodes are indexed as their inheritance is resolved, so only
+    // the nodes declared before a node can be inherited
+    for (size_t i = 0; i < document->nodes.size(); ++i) {
+        nodeIndex.insert(document->nodes, i);
+        std::optional<Error> error = inheritanceResolution(*document, nodeIndex, i, limits);
+        if (error.has_value()) {
+            return error;
+        }
+    }
+
+    for (size_t i = 0; i < document->nodes.size(); ++i) {
+        referenceResolution(*document, nodeIndex, i);
+    }
 
-    for (Node &node: document->nodes) {
-        nodeMap[node.name] = node;
+    return std::nullopt;
+}
+
+std::optional<HXL::Error> HXL::Transformer::transform(HXL::Document &document,
+                                                      const HXL::NodeIndex &nodeIndex,
+                                                      size_t begin,
+                                                      size_t end,
+                                                      const HXL::ResourceLimits &limits) {
+    for (size_t i = begin; i < end; ++i) {
+        std::optional<Error> error = inheritanceResolution(document, nodeIndex, i, limits);
+        if (error.has_value()) {
+            return error;
+        }
+        referenceResolution(document, nodeIndex, i);
+    }
+
+    return std::nullopt;
+}
+
+std::optional<HXL::Error> HXL::Transformer::inheritanceResolution(HXL::Document &document,
+                                                                  const HXL::NodeIndex &nodeIndex,
+                                                                  size_t index,
+                                                                  const HXL::ResourceLimits &limits) {
+    std::vector<Node> &nodes = document.nodes;
+
+    // If no inheritance is needed
+    Node &node = nodes[index];
+    node.inheritanceDepth = 0;
+    node.declaredProperties = static_cast<uint32_t>(node.properties.size());
+    if (!node.inheritance.has_value()) {
+        return std::nullopt;
+    }
+
+    // The schema ensures the node must exist before it is used
+    // for inheritance, so the parent is already in the index.
+    std::optional<size_t> parentIndex = nodeIndex.find(nodes, node.inheritance->from);
+    if (!parentIndex.has_value() || parentIndex.value() >= index) {
+        return std::nullopt;
+    }
+
+    // The depth is counted from the parent's, so it costs no more than
+    // the lookup of the parent
+    const Node &parent = nodes[parentIndex.value()];
+    node.inheritanceDepth = parent.inheritanceDepth + 1;
+    if (node.inheritanceDepth > limits.maxInheritanceDepth) {
+        return Error{
+                .errorCode = ErrorCode::HXL_INHERITANCE_TOO_DEEP,
+                .message = std::format("[Line {}, Col {}] Node {} exceeds the limit of {} levels of inheritance",
+                                       node.position.line,
+                                       node.position.col,
+                                       node.name,
+                                       limits.maxInheritanceDepth),
+        };
+    }
+
+    // Only the properties the parent declares itself are inherited,
+    // not the ones it has inherited in turn
+    for (size_t i = 0; i < parent.declaredProperties; ++i) {
+        const NodeProperty &parentProperty = parent.properties[i];
+        auto it = std::find_if(node.properties.begin(),
+                               node.properties.end(),
+                               [&](const NodeProperty &item) -> bool {
+                                   return item.name == parentProperty.name;
+                               });
+        if (it == node.properties.end()) {
+            node.properties.push_back(parentProperty);
+        }
+    }
+
+    return std::nullopt;
+}
+
+void HXL::Transformer::referenceResolution(HXL::Document &document, const HXL::NodeIndex &nodeIndex, size_t index) {
+    for (NodeProperty &nodeProperty: document.nodes[index].properties) {
+        if (nodeProperty.dataType != DataType::NodeRef || nodeProperty.values.empty()) {
+            continue;
+        }
 
-        // If no inheritance is needed
-        if (!node.inheritance.has_value()) {
+        // The semantic analysis has already reported references
+        // to nodes which don't exist
+        std::string_view name = document.text(nodeProperty.values[0].string);
+        std::optional<size_t> target = nodeIndex.find(document.nodes, name);
+        if (!target.has_value()) {
             continue;
         }
 
-        // The schema ensures the node must exist before it is used
-        // for inheritance, so we're guaranteed that the parent node
-        // exists in the node map.
-        // We're furthermore sure that the parent node exists, and
-        // don't need to waste computation on checking that.
-        Node parent = nodeMap[node.inheritance->from];
-        for (const NodeProperty &parentProperty: parent.properties) {
-            auto it = std::find_if(node.properties.begin(),
-                                   node.properties.end(),
-                                   [&](const NodeProperty &item) -> bool {
-                                       return item.name == parentProperty.name;
-                                   });
-            if (it == node.properties.end()) {
-                node.properties.push_back(parentProperty);
-            }
+        // Keep a reference converted by the schema validation,
+        // otherwise it's converted here.
+        NodeRef *ref = nodeProperty.value.has_value() ? std::get_if<NodeRef>(&nodeProperty.value.value()) : nullptr;
+        if (!ref) {
+            ref = &std::get<NodeRef>(nodeProperty.value.emplace(NodeRef{std::string(name)}));
         }
+        ref->index = target.value();
     }
 }
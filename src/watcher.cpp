@@ -0,0 +1,221 @@
+#include "hxl-lang/services/watcher.h"
+#include "hxl-lang/services/deserializer.h"
+#include "hxl-lang/utilities/node-index.h"
+
+#include <bit>
+#include <format>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    void combine(size_t &seed, size_t hash) {
+        seed ^= hash + 0x9e3779b97f4a7c15 + (seed << 6) + (seed >> 2);
+    }
+}
+
+HXL::Watcher::Watcher(HXL::Project &project, HXL::NodeChangeHandles handles)
+    : project(project),
+      handles(std::move(handles)) {
+#if defined(__linux__)
+    descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+}
+
+HXL::Watcher::~Watcher() {
+#if defined(__linux__)
+    if (descriptor >= 0) {
+        close(descriptor);
+    }
+#endif
+}
+
+std::optional<HXL::Error> HXL::Watcher::watch(const std::filesystem::path &path) {
+    // Events name the file within its directory, so the paths are made
+    // absolute, to match them
+    std::filesystem::path absolute = std::filesystem::absolute(path).lexically_normal();
+    std::optional<Error> error = project.loadFile(absolute);
+    if (error.has_value()) {
+        return error;
+    }
+
+#if defined(__linux__)
+    if (descriptor < 0) {
+        return Error{ErrorCode::HXL_CANNOT_WATCH_FILE, "Cannot initialize inotify."};
+    }
+
+    // A directory, which is already watched, returns the same descriptor
+    std::filesystem::path directory = absolute.parent_path();
+    int watchDescriptor = inotify_add_watch(descriptor,
+                                            directory.c_str(),
+                                            IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE);
+    if (watchDescriptor < 0) {
+        return Error{ErrorCode::HXL_CANNOT_WATCH_FILE, std::format("Cannot watch directory: {}", directory.string())};
+    }
+
+    directories[watchDescriptor] = directory;
+    files.insert(absolute.string());
+    return std::nullopt;
+#else
+    return Error{ErrorCode::HXL_CANNOT_WATCH_FILE, "Watching files is only supported on Linux."};
+#endif
+}
+
+HXL::ErrorList HXL::Watcher::poll([[maybe_unused]] std::chrono::milliseconds timeout, [[maybe_unused]] HXL::ThreadPool *pool) {
+#if defined(__linux__)
+    pollfd request{.fd = descriptor, .events = POLLIN};
+    if (descriptor < 0 || ::poll(&request, 1, static_cast<int>(timeout.count())) <= 0) {
+        return {};
+    }
+
+    // Read all pending events, so a burst of changes (as when an editor
+    // saves) results in a single update
+    ErrorList errors;
+    bool changed = false;
+    alignas(inotify_event) char buffer[4096];
+    ssize_t length;
+    while ((length = read(descriptor, buffer, sizeof(buffer))) > 0) {
+        for (ssize_t offset = 0; offset < length;) {
+            const auto *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+            auto directory = directories.find(event->wd);
+            if (event->len == 0 || directory == directories.end()) {
+                continue;
+            }
+
+            std::filesystem::path path = directory->second / event->name;
+            if (!files.contains(path.string())) {
+                continue;
+            }
+
+            changed = true;
+            if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                project.removeFile(path.string());
+            } else if (std::optional<Error> error = project.loadFile(path)) {
+                errors.push_back(error.value());
+            }
+        }
+    }
+
+    if (!changed || !errors.empty()) {
+        return errors;
+    }
+
+    return update(pool);
+#else
+    return {{ErrorCode::HXL_CANNOT_WATCH_FILE, "Watching files is only supported on Linux."}};
+#endif
+}
+
+HXL::ErrorList HXL::Watcher::update(HXL::ThreadPool *pool) {
+    ProcessResult result = project.resolve(pool);
+    if (!result.errors.empty()) {
+        return result.errors;
+    }
+
+    const Document &document = *result.document;
+    const std::vector<Node> &nodes = document.nodes;
+
+    std::unordered_map<std::string, size_t> next;
+    next.reserve(nodes.size());
+    std::vector<bool> added(nodes.size(), false);
+    std::vector<bool> affected(nodes.size(), false);
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        size_t hash = hashNode(document, nodes[i]);
+        next.emplace(nodes[i].name, hash);
+
+        auto previous = hashes.find(nodes[i].name);
+        added[i] = previous == hashes.end();
+        affected[i] = added[i] || previous->second != hash;
+    }
+
+    // The project orders nodes after the nodes they inherit and reference,
+    // so a single pass carries a change on to all of the nodes depending on it
+    NodeIndex nodeIndex;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        nodeIndex.insert(nodes, i);
+    }
+
+    auto isAffected = [&](std::string_view name) {
+        std::optional<size_t> index = nodeIndex.find(nodes, name);
+        return index.has_value() && affected[index.value()];
+    };
+
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        const Node &node = nodes[i];
+        if (affected[i]) {
+            continue;
+        }
+        if (node.inheritance.has_value() && isAffected(node.inheritance->from)) {
+            affected[i] = true;
+            continue;
+        }
+        for (const NodeProperty &property: node.properties) {
+            if (property.dataType != DataType::NodeRef) {
+                continue;
+            }
+            for (const PropertyScalar &value: property.values) {
+                if (isAffected(document.text(value.string))) {
+                    affected[i] = true;
+                }
+            }
+        }
+    }
+
+    for (const auto &[name, hash]: hashes) {
+        if (!next.contains(name) && handles.removed) {
+            handles.removed(name);
+        }
+    }
+
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (!affected[i]) {
+            continue;
+        }
+
+        const std::function<void(const DeserializedNode &)> &handle = added[i] ? handles.added : handles.changed;
+        if (handle) {
+            handle(Deserializer::deserializeNode(document, i));
+        }
+    }
+
+    hashes = std::move(next);
+    return {};
+}
+
+size_t HXL::Watcher::hashNode(const HXL::Document &document, const HXL::Node &node) {
+    size_t seed = std::hash<std::string>{}(node.type);
+    if (node.inheritance.has_value()) {
+        combine(seed, std::hash<std::string>{}(node.inheritance->from));
+    }
+
+    for (const NodeProperty &property: node.properties) {
+        combine(seed, std::hash<std::string>{}(property.name));
+        combine(seed, static_cast<size_t>(property.dataType));
+        combine(seed, property.values.size());
+
+        for (const PropertyScalar &value: property.values) {
+            switch (property.dataType) {
+                case DataType::Bool:
+                    combine(seed, value.boolean);
+                    break;
+                case DataType::Int:
+                    combine(seed, std::hash<int>{}(value.integer));
+                    break;
+                case DataType::Float:
+                    combine(seed, std::bit_cast<uint32_t>(value.real));
+                    break;
+                case DataType::String:
+                case DataType::NodeRef:
+                    combine(seed, std::hash<std::string_view>{}(document.text(value.string)));
+                    break;
+            }
+        }
+    }
+
+    return seed;
+}
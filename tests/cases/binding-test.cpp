@@ -0,0 +1,160 @@
+using namespace HXL;
+
+class BindingTest : public BaseCase {
+public:
+    /**
+     * List of tests.
+     */
+    void test() override {
+        intoVector();
+        unknownProperty();
+    }
+
+    struct Cube {
+        std::string name;
+        float size = 1.0;
+        double weight = 0.0;
+        std::string label = "None";
+        std::array<int, 3> pos{};
+        std::vector<std::string> tags;
+    };
+
+    CompiledSchema schema = SchemaCompiler::compile({
+            .types = {
+                    SchemaNodeType{.name = "Cube",
+                                   .properties = {
+                                           {"size", DataType::Float},
+                                           {"weight", DataType::Float},
+                                           {"label", DataType::String},
+                                           {"pos", DataType::Int, ValueStructure::Array},
+                                           {"tags", DataType::String, ValueStructure::Array},
+                                   }},
+            },
+    });
+
+    /**
+     * Test that bound properties are written into the members of
+     * objects appended to a vector.
+     */
+    void intoVector() {
+        it("Writes bound properties into objects", [&]() {
+            std::vector<Cube> cubes;
+
+            DeserializationProtocol protocol;
+            protocol.handles.push_back(HXL::bind<Cube>("size", &Cube::size,
+                                                       "weight", &Cube::weight,
+                                                       "label", &Cube::label,
+                                                       "pos", &Cube::pos)
+                                               .name(&Cube::name)
+                                               .into("Cube", cubes));
+
+            Result<std::vector<Token>> tokens = Tokenizer::tokenize("<Cube> A\n\tsize: 2.5\n\tweight: 4\n\tpos[]: { 1, 2, 3 }\n<Cube> B\n\tlabel: \"B\"\n");
+            Result<Document> syntaxTree = Parser::parse(std::get<std::vector<Token>>(tokens), schema);
+            std::shared_ptr<Document> document = std::make_shared<Document>(syntaxTree.get());
+
+            ErrorList errors = Deserializer::deserialize(Deserializer::compile(protocol, schema), document);
+
+            assertCount(0, errors);
+            assertCount(2, cubes);
+            assertEquals<std::string>("A", cubes[0].name);
+            assertEquals<float>(2.5, cubes[0].size);
+            assertEquals<double>(4.0, cubes[0].weight);
+            assertEquals<std::string>("None", cubes[0].label);
+            assertEquals<int>(3, cubes[0].pos[2]);
+
+            // Properties which aren't present keep their default value
+            assertEquals<std::string>("B", cubes[1].name);
+            assertEquals<float>(1.0, cubes[1].size);
+            assertEquals<std::string>("B", cubes[1].label);
+        });
+
+        it("Copies strings deserialized as views into members", [&]() {
+            std::vector<Cube> cubes;
+
+            DeserializationProtocol protocol;
+            protocol.handles.push_back(HXL::bind<Cube>("label", &Cube::label).into("Cube", cubes));
+
+            Result<std::vector<Token>> tokens = Tokenizer::tokenize("<Cube> A\n\tlabel: \"A\"\n");
+            Result<Document> syntaxTree = Parser::parse(std::get<std::vector<Token>>(tokens), schema);
+            std::shared_ptr<Document> document = std::make_shared<Document>(syntaxTree.get());
+
+            ErrorList errors = Deserializer::deserialize(Deserializer::compile(protocol, schema),
+                                                         document,
+                                                         {.stringViews = true});
+            document.reset();
+
+            assertCount(0, errors);
+            assertEquals<std::string>("A", cubes[0].label);
+        });
+
+        it("Reads unconverted values straight from the document", [&]() {
+            std::vector<Cube> cubes;
+            std::vector<bool> converted;
+
+            DeserializationProtocol protocol;
+            protocol.handles.push_back(HXL::bind<Cube>("label", &Cube::label,
+                                                       "tags", &Cube::tags,
+                                                       "size", &Cube::size)
+                                               .into("Cube", [&](const DeserializedNodeView &node) -> Cube & {
+                                                   for (size_t slot = 0; slot < node.properties.size(); ++slot) {
+                                                       const NodeProperty *property = node.properties[slot];
+                                                       if (property && property->dataType == DataType::String) {
+                                                           converted.push_back(node.values[slot] != nullptr);
+                                                       }
+                                                   }
+                                                   return cubes.emplace_back();
+                                               }));
+
+            Result<std::vector<Token>> tokens = Tokenizer::tokenize("<Cube> A\n\tlabel: \"A\"\n\ttags[]: { \"x\", \"y\" }\n\tsize: 3\n");
+            Result<Document> syntaxTree = Parser::parse(std::get<std::vector<Token>>(tokens), schema);
+            std::shared_ptr<Document> document = std::make_shared<Document>(syntaxTree.get());
+
+            ErrorList errors = Deserializer::deserialize(Deserializer::compile(protocol, schema), document);
+
+            assertCount(0, errors);
+            assertCount(2, converted);
+            assertFalse(converted[0]);
+            assertFalse(converted[1]);
+            assertEquals<std::string>("A", cubes[0].label);
+            assertCount(2, cubes[0].tags);
+            assertEquals<std::string>("y", cubes[0].tags[1]);
+            assertEquals<float>(3.0, cubes[0].size);
+        });
+    }
+
+    /**
+     * Test that binding a property which isn't in the schema is
+     * reported as an error, when nodes of the type are deserialized.
+     */
+    void unknownProperty() {
+        it("Rejects bound properties which aren't in the schema", [&]() {
+            std::vector<Cube> cubes;
+
+            DeserializationProtocol protocol;
+            protocol.handles.push_back(HXL::bind<Cube>("height", &Cube::size).into("Cube", cubes));
+
+            Result<std::vector<Token>> tokens = Tokenizer::tokenize("<Cube> A\n\tsize: 2.5\n");
+            Result<Document> syntaxTree = Parser::parse(std::get<std::vector<Token>>(tokens), schema);
+            std::shared_ptr<Document> document = std::make_shared<Document>(syntaxTree.get());
+
+            ErrorList errors = Deserializer::deserialize(Deserializer::compile(protocol, schema), document);
+
+            assertCount(1, errors);
+            assertError(ErrorCode::HXL_UNDECLARED_BOUND_PROPERTY, "Bound property height is not declared on Cube", errors[0]);
+            assertCount(0, cubes);
+        });
+
+        it("Reports bound properties which aren't in the schema from the Processor", [&]() {
+            std::vector<Cube> cubes;
+
+            DeserializationProtocol protocol;
+            protocol.handles.push_back(HXL::bind<Cube>("height", &Cube::size).into("Cube", cubes));
+
+            ProcessResult result = Processor::process("<Cube> A\n\tsize: 2.5\n", schema.schema, protocol);
+
+            assertCount(1, result.errors);
+            assertError(ErrorCode::HXL_UNDECLARED_BOUND_PROPERTY, "Bound property height is not declared on Cube", result.errors[0]);
+            assertCount(0, cubes);
+        });
+    }
+};
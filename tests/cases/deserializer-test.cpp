@@ -10,6 +10,13 @@ public:
         reference();
         inheritance();
         array();
+        compiledProtocol();
+        missingHandle();
+        nodeView();
+        batchHandle();
+        parallel();
+        boundReferences();
+        stringViews();
     }
 
     /**
@@ -141,4 +148,518 @@ public:
             testArray<std::string>(R"("Hello", "World", "!")", {"Hello", "World", "!"});
         });
     }
+
+    /**
+     * Test dispatching nodes by type ID, when the protocol is compiled
+     * with the same schema as the document was parsed with.
+     */
+    void compiledProtocol() {
+        it("Dispatches nodes with a compiled protocol", [&]() {
+            CompiledSchema schema = SchemaCompiler::compile({
+                    .types = {
+                            SchemaNodeType{.name = "Cube", .properties = {{"size", DataType::Float}}},
+                            SchemaNodeType{.name = "Sphere"},
+                    },
+            });
+
+            std::vector<std::string> handled;
+
+            DeserializationProtocol protocol;
+            protocol.handles.push_back({"Sphere", [&](const DeserializedNode &node) {
+                                            handled.push_back("Sphere " + node.name);
+                                        }});
+            protocol.handles.push_back({"Cube", [&](const DeserializedNode &node) {
+                                            handled.push_back("Cube " + node.name);
+                                        }});
+
+            Result<std::vector<Token>> tokens = Tokenizer::tokenize("<Cube> A\n\tsize: 8.0\n<Sphere> B\n<Cube> C\n");
+            Result<Document> syntaxTree = Parser::parse(std::get<std::vector<Token>>(tokens), schema);
+            std::shared_ptr<Document> document = std::make_shared<Document>(syntaxTree.get());
+
+            ErrorList errors = Deserializer::deserialize(Deserializer::compile(protocol, schema), document);
+
+            assertCount(0, errors);
+            assertCount(3, handled);
+            assertEquals<std::string>("Cube A", handled[0]);
+            assertEquals<std::string>("Sphere B", handled[1]);
+            assertEquals<std::string>("Cube C", handled[2]);
+        });
+    }
+
+    /**
+     * Test that a missing handle is reported once per node type,
+     * and that no handles are executed.
+     */
+    void missingHandle() {
+        it("Reports missing handles once per node type", [&]() {
+            Result<std::vector<Token>> tokens = Tokenizer::tokenize("<Cube> A\n<Sphere> B\n<Sphere> C\n");
+            Result<Document> syntaxTree = Parser::parse(std::get<std::vector<Token>>(tokens));
+            std::shared_ptr<Document> document = std::make_shared<Document>(syntaxTree.get());
+
+            int handled = 0;
+            DeserializationProtocol protocol;
+            protocol.handles.push_back({"Cube", [&](const DeserializedNode &node) {
+                                            ++handled;
+                                        }});
+
+            ErrorList errors = Deserializer::deserialize(protocol, document);
+
+            assertCount(1, errors);
+            assertError(ErrorCode::HXL_CANNOT_DESERIALIZE_NODE, "Missing deserializer for: Sphere", errors[0]);
+            assertEquals(0, handled);
+        });
+
+        it("Rejects handles which set several callbacks", [&]() {
+            CompiledSchema schema = SchemaCompiler::compile({
+                    .types = {
+                            SchemaNodeType{.name = "Cube"},
+                    },
+            });
+
+            Result<std::vector<Token>> tokens = Tokenizer::tokenize("<Cube> A\n");
+            Result<Document> syntaxTree = Parser::parse(std::get<std::vector<Token>>(tokens), schema);
+            std::shared_ptr<Document> document = std::make_shared<Document>(syntaxTree.get());
+
+            int handled = 0;
+            DeserializationHandle cube{"Cube", [&](const DeserializedNode &node) {
+                                           ++handled;
+                                       }};
+            cube.viewHandle = [&](const DeserializedNodeView &node) {
+                ++handled;
+            };
+            DeserializationProtocol protocol;
+            protocol.handles.push_back(cube);
+
+            for (const CompiledProtocol &compiled: {Deserializer::compile(protocol), Deserializer::compile(protocol, schema)}) {
+                ErrorList errors = Deserializer::deserialize(compiled, document);
+
+                assertCount(1, errors);
+                assertError(ErrorCode::HXL_AMBIGUOUS_HANDLE, "Handle for Cube must set exactly one callback", errors[0]);
+            }
+            assertEquals(0, handled);
+        });
+    }
+
+    /**
+     * Test that view handles receive the values by slot, looked up
+     * with keys resolved from the schema.
+     */
+    void nodeView() {
+        it("Passes node views to view handles", [&]() {
+            CompiledSchema schema = SchemaCompiler::compile({
+                    .types = {
+                            SchemaNodeType{.name = "Cube",
+                                           .properties = {
+                                                   {"size", DataType::Float},
+                                                   {"label", DataType::String},
+                                           }},
+                    },
+            });
+
+            PropertyKey size = schema.key("Cube", "size").value();
+            PropertyKey label = schema.key("Cube", "label").value();
+
+            std::vector<float> sizes;
+            std::vector<bool> hasLabel;
+
+            DeserializationHandle cube{"Cube"};
+            cube.viewHandle = [&](const DeserializedNodeView &node) {
+                sizes.push_back(node.get<float>(size));
+                hasLabel.push_back(node.has(label));
+            };
+
+            DeserializationProtocol protocol;
+            protocol.handles.push_back(cube);
+
+            Result<std::vector<Token>> tokens = Tokenizer::tokenize("<Cube> A\n\tlabel: \"A\"\n\tsize: 8.0\n<Cube> B\n\tsize: 2\n");
+            Result<Document> syntaxTree = Parser::parse(std::get<std::vector<Token>>(tokens), schema);
+            std::shared_ptr<Document> document = std::make_shared<Document>(syntaxTree.get());
+
+            ErrorList errors = Deserializer::deserialize(Deserializer::compile(protocol, schema), document);
+
+            assertCount(0, errors);
+            assertCount(2, sizes);
+            assertEquals<float>(8.0, sizes[0]);
+            assertEquals<float>(2.0, sizes[1]);
+            assertTrue(hasLabel[0]);
+            assertFalse(hasLabel[1]);
+        });
+    }
+
+    /**
+     * Test that batch handles receive the nodes grouped by type,
+     * in document order, and split into chunks of ``batchSize``.
+     */
+    void batchHandle() {
+        it("Passes nodes in batches to batch handles", [&]() {
+            CompiledSchema schema = SchemaCompiler::compile({
+                    .types = {
+                            SchemaNodeType{.name = "Cube", .properties = {{"size", DataType::Int}}},
+                            SchemaNodeType{.name = "Sphere", .properties = {{"radius", DataType::Int}}},
+                    },
+            });
+
+            PropertyKey size = schema.key("Cube", "size").value();
+
+            std::vector<size_t> batches;
+            std::vector<int> sizes;
+
+            DeserializationHandle cube{"Cube"};
+            cube.batchSize = 2;
+            cube.batchHandle = [&](std::span<const DeserializedNodeView> nodes) {
+                batches.push_back(nodes.size());
+                for (const DeserializedNodeView &node: nodes) {
+                    sizes.push_back(node.get<int>(size));
+                }
+            };
+
+            size_t spheres = 0;
+            DeserializationHandle sphere{"Sphere"};
+            sphere.batchHandle = [&](std::span<const DeserializedNodeView> nodes) {
+                spheres += nodes.size();
+            };
+
+            DeserializationProtocol protocol;
+            protocol.handles.push_back(cube);
+            protocol.handles.push_back(sphere);
+
+            Result<std::vector<Token>> tokens = Tokenizer::tokenize("<Cube> A\n\tsize: 1\n"
+                                                                    "<Sphere> B\n\tradius: 1\n"
+                                                                    "<Cube> C\n\tsize: 2\n"
+                                                                    "<Cube> D\n\tsize: 3\n");
+            Result<Document> syntaxTree = Parser::parse(std::get<std::vector<Token>>(tokens), schema);
+            std::shared_ptr<Document> document = std::make_shared<Document>(syntaxTree.get());
+
+            ErrorList errors = Deserializer::deserialize(Deserializer::compile(protocol, schema), document);
+
+            assertCount(0, errors);
+            assertCount(2, batches);
+            assertEquals<size_t>(2, batches[0]);
+            assertEquals<size_t>(1, batches[1]);
+            assertCount(3, sizes);
+            assertEquals<int>(1, sizes[0]);
+            assertEquals<int>(2, sizes[1]);
+            assertEquals<int>(3, sizes[2]);
+            assertEquals<size_t>(1, spheres);
+        });
+    }
+
+    /**
+     * Test deserialization on a thread pool, where per-type handles and
+     * ordered commits must still see the nodes in document order.
+     */
+    void parallel() {
+        it("Deserializes on a thread pool", [&]() {
+            CompiledSchema schema = SchemaCompiler::compile({
+                    .types = {
+                            SchemaNodeType{.name = "Cube", .properties = {{"size", DataType::Int}}},
+                            SchemaNodeType{.name = "Sphere", .properties = {{"radius", DataType::Int}}},
+                    },
+            });
+
+            PropertyKey size = schema.key("Cube", "size").value();
+            PropertyKey radius = schema.key("Sphere", "radius").value();
+
+            std::string source;
+            for (int i = 0; i < 1000; ++i) {
+                source += std::format("<Cube> C{}\n\tsize: {}\n<Sphere> S{}\n\tradius: {}\n", i, i, i, i);
+            }
+
+            std::vector<int> sizes;
+            DeserializationHandle cube{"Cube"};
+            cube.concurrency = HandleConcurrency::ThreadSafe;
+            cube.viewHandle = [&](const DeserializedNodeView &node) {
+                sizes.push_back(node.get<int>(size));
+            };
+
+            std::vector<int> radii;
+            DeserializationHandle sphere{"Sphere"};
+            sphere.concurrency = HandleConcurrency::PerType;
+            sphere.viewHandle = [&](const DeserializedNodeView &node) {
+                radii.push_back(node.get<int>(radius));
+            };
+
+            DeserializationProtocol protocol;
+            protocol.handles.push_back(cube);
+            protocol.handles.push_back(sphere);
+
+            Result<std::vector<Token>> tokens = Tokenizer::tokenize(source);
+            Result<Document> syntaxTree = Parser::parse(std::get<std::vector<Token>>(tokens), schema);
+            std::shared_ptr<Document> document = std::make_shared<Document>(syntaxTree.get());
+
+            ThreadPool pool(4);
+            ErrorList errors = Deserializer::deserialize(Deserializer::compile(protocol, schema),
+                                                         document,
+                                                         {.pool = &pool, .chunkSize = 16, .orderedCommit = true});
+
+            assertCount(0, errors);
+            assertCount(1000, sizes);
+            assertCount(1000, radii);
+            assertTrue(std::is_sorted(sizes.begin(), sizes.end()));
+            assertTrue(std::is_sorted(radii.begin(), radii.end()));
+        });
+
+        it("Re-throws exceptions from handles on the pool", [&]() {
+            DeserializationHandle cube{"Cube", [](const DeserializedNode &) {
+                                           throw std::runtime_error("Failed");
+                                       }};
+            cube.concurrency = HandleConcurrency::ThreadSafe;
+
+            DeserializationProtocol protocol;
+            protocol.handles.push_back(cube);
+
+            Result<std::vector<Token>> tokens = Tokenizer::tokenize("<Cube> A\n\tsize: 1\n");
+            Result<Document> syntaxTree = Parser::parse(std::get<std::vector<Token>>(tokens));
+            std::shared_ptr<Document> document = std::make_shared<Document>(syntaxTree.get());
+
+            ThreadPool pool(2);
+            bool thrown = false;
+            try {
+                Deserializer::deserialize(Deserializer::compile(protocol), document, {.pool = &pool});
+            } catch (const std::runtime_error &) {
+                thrown = true;
+            }
+            assertTrue(thrown);
+        });
+    }
+
+    /**
+     * Test that references arrive bound to the object returned for the
+     * referenced node, also when the referencing type is handled in batches.
+     */
+    void boundReferences() {
+        it("Binds references to the objects of referenced nodes", [&]() {
+            struct Material {
+                std::string texture;
+            };
+
+            CompiledSchema schema = SchemaCompiler::compile({
+                    .types = {
+                            SchemaNodeType{.name = "Surface", .properties = {{"material", DataType::NodeRef}}},
+                            SchemaNodeType{.name = "Material", .properties = {{"texture", DataType::String}}},
+                    },
+            });
+
+            PropertyKey material = schema.key("Surface", "material").value();
+            PropertyKey texture = schema.key("Material", "texture").value();
+
+            std::vector<std::string> textures;
+            DeserializationHandle surface{"Surface"};
+            surface.batchHandle = [&](std::span<const DeserializedNodeView> nodes) {
+                for (const DeserializedNodeView &node: nodes) {
+                    if (node.has(material)) {
+                        textures.push_back(node.get<NodeRef>(material).as<Material>()->texture);
+                    }
+                }
+            };
+
+            DeserializationHandle materialHandle{"Material"};
+            materialHandle.concurrency = HandleConcurrency::PerType;
+            materialHandle.objectHandle = [&](const DeserializedNodeView &node) {
+                return std::make_shared<Material>(Material{node.get<std::string>(texture)});
+            };
+
+            DeserializationProtocol protocol;
+            protocol.handles.push_back(surface);
+            protocol.handles.push_back(materialHandle);
+
+            Result<std::vector<Token>> tokens = Tokenizer::tokenize("<Surface> Plain\n"
+                                                                    "<Material> Grass\n\ttexture: \"grass.png\"\n"
+                                                                    "<Surface> Ground\n\tmaterial&: Grass\n");
+            Result<Document> syntaxTree = Parser::parse(std::get<std::vector<Token>>(tokens), schema);
+            std::shared_ptr<Document> document = std::make_shared<Document>(syntaxTree.get());
+            Transformer::transform(document);
+
+            ThreadPool pool(2);
+            ErrorList errors = Deserializer::deserialize(Deserializer::compile(protocol, schema),
+                                                         document,
+                                                         {.pool = &pool});
+
+            assertCount(0, errors);
+            assertCount(1, textures);
+            assertEquals<std::string>("grass.png", textures[0]);
+        });
+
+        it("Defers sequential handles referencing objects created on the pool", [&]() {
+            struct Material {
+                std::string texture;
+            };
+            struct Surface {
+                std::shared_ptr<Material> material;
+            };
+
+            CompiledSchema schema = SchemaCompiler::compile({
+                    .types = {
+                            SchemaNodeType{.name = "Wall", .properties = {{"surface", DataType::NodeRef}}},
+                            SchemaNodeType{.name = "Surface", .properties = {{"material", DataType::NodeRef}}},
+                            SchemaNodeType{.name = "Material", .properties = {{"texture", DataType::String}}},
+                    },
+            });
+
+            PropertyKey surface = schema.key("Wall", "surface").value();
+            PropertyKey material = schema.key("Surface", "material").value();
+            PropertyKey texture = schema.key("Material", "texture").value();
+
+            // Only the materials are created on the pool, the surfaces and
+            // walls are sequential, and the walls reference them indirectly
+            DeserializationHandle materialHandle{"Material"};
+            materialHandle.concurrency = HandleConcurrency::PerType;
+            materialHandle.objectHandle = [&](const DeserializedNodeView &node) {
+                return std::make_shared<Material>(Material{node.get<std::string>(texture)});
+            };
+
+            std::vector<std::string> surfaces;
+            DeserializationHandle surfaceHandle{"Surface"};
+            surfaceHandle.objectHandle = [&](const DeserializedNodeView &node) {
+                std::shared_ptr<Material> bound = node.has(material) ? node.get<NodeRef>(material).as<Material>() : nullptr;
+                surfaces.push_back(bound ? bound->texture : "none");
+                return std::make_shared<Surface>(Surface{bound});
+            };
+
+            std::vector<std::string> walls;
+            DeserializationHandle wallHandle{"Wall"};
+            wallHandle.viewHandle = [&](const DeserializedNodeView &node) {
+                std::shared_ptr<Surface> bound = node.get<NodeRef>(surface).as<Surface>();
+                walls.push_back(bound && bound->material ? bound->material->texture : "none");
+            };
+
+            DeserializationProtocol protocol;
+            protocol.handles.push_back(wallHandle);
+            protocol.handles.push_back(surfaceHandle);
+            protocol.handles.push_back(materialHandle);
+
+            Result<std::vector<Token>> tokens = Tokenizer::tokenize("<Surface> Plain\n"
+                                                                    "<Material> Grass\n\ttexture: \"grass.png\"\n"
+                                                                    "<Surface> Ground\n\tmaterial&: Grass\n"
+                                                                    "<Wall> Front\n\tsurface&: Ground\n"
+                                                                    "<Wall> Back\n\tsurface&: Plain\n");
+            Result<Document> syntaxTree = Parser::parse(std::get<std::vector<Token>>(tokens), schema);
+            std::shared_ptr<Document> document = std::make_shared<Document>(syntaxTree.get());
+            Transformer::transform(document);
+
+            ThreadPool pool(2);
+            ErrorList errors = Deserializer::deserialize(Deserializer::compile(protocol, schema),
+                                                         document,
+                                                         {.pool = &pool});
+
+            assertCount(0, errors);
+            assertCount(2, surfaces);
+            assertEquals<std::string>("none", surfaces[0]);
+            assertEquals<std::string>("grass.png", surfaces[1]);
+            assertCount(2, walls);
+            assertEquals<std::string>("none", walls[0]);
+            assertEquals<std::string>("grass.png", walls[1]);
+        });
+    }
+
+    /**
+     * Test that string values can be passed as views into the document,
+     * instead of being copied.
+     */
+    void stringViews() {
+        it("Passes string values as views into the document", [&]() {
+            CompiledSchema schema = SchemaCompiler::compile({
+                    .types = {
+                            SchemaNodeType{.name = "Entry",
+                                           .properties = {
+                                                   {"text", DataType::String},
+                                                   {"tags", DataType::String, ValueStructure::Array},
+                                           }},
+                    },
+            });
+
+            PropertyKey text = schema.key("Entry", "text").value();
+            PropertyKey tags = schema.key("Entry", "tags").value();
+
+            std::vector<std::string_view> texts;
+            std::vector<std::string_view> allTags;
+
+            DeserializationHandle entry{"Entry"};
+            entry.viewHandle = [&](const DeserializedNodeView &node) {
+                texts.push_back(node.text(text));
+                for (std::string_view tag: node.get<std::vector<std::string_view>>(tags)) {
+                    allTags.push_back(tag);
+                }
+            };
+
+            DeserializationProtocol protocol;
+            protocol.handles.push_back(entry);
+
+            Result<std::vector<Token>> tokens = Tokenizer::tokenize("<Entry> Greeting\n\ttext: \"Hello\"\n\ttags[]: { \"a\", \"b\" }\n");
+            Result<Document> syntaxTree = Parser::parse(std::get<std::vector<Token>>(tokens), schema);
+            std::shared_ptr<Document> document = std::make_shared<Document>(syntaxTree.get());
+
+            ErrorList errors = Deserializer::deserialize(Deserializer::compile(protocol, schema),
+                                                         document,
+                                                         {.stringViews = true});
+
+            auto isInDocument = [&](std::string_view view) {
+                return view.data() >= document->strings.data() &&
+                       view.data() + view.size() <= document->strings.data() + document->strings.size();
+            };
+
+            assertCount(0, errors);
+            assertCount(1, texts);
+            assertEquals<std::string>("Hello", std::string(texts[0]));
+            assertTrue(isInDocument(texts[0]));
+            assertCount(2, allTags);
+            assertEquals<std::string>("b", std::string(allTags[1]));
+            assertTrue(isInDocument(allTags[1]));
+        });
+
+        it("Delivers an array of one string as an array", [&]() {
+            Schema schema{
+                    .types = {
+                            SchemaNodeType{.name = "Entry",
+                                           .properties = {
+                                                   {"tags", DataType::String, ValueStructure::Array},
+                                           }},
+                    },
+            };
+            CompiledSchema compiledSchema = SchemaCompiler::compile(schema);
+            PropertyKey tags = compiledSchema.key("Entry", "tags").value();
+
+            Result<std::vector<Token>> tokens = Tokenizer::tokenize("<Entry> Greeting\n\ttags[]: { \"x\" }\n");
+            for (bool stringViews: {false, true}) {
+                DeserializedValue value, viewValue;
+                DeserializationHandle entry{"Entry"};
+                entry.handle = [&](const DeserializedNode &node) {
+                    value = node.properties.at("tags").value;
+                };
+                DeserializationProtocol protocol;
+                protocol.handles.push_back(entry);
+
+                DeserializationHandle viewEntry{"Entry"};
+                viewEntry.viewHandle = [&](const DeserializedNodeView &node) {
+                    viewValue = node.at(tags);
+                };
+                DeserializationProtocol viewProtocol;
+                viewProtocol.handles.push_back(viewEntry);
+
+                auto assertArray = [&](const DeserializedValue &delivered) {
+                    if (stringViews) {
+                        assertCount(1, std::get<std::vector<std::string_view>>(delivered));
+                        assertEquals<std::string>("x", std::string(std::get<std::vector<std::string_view>>(delivered)[0]));
+                    } else {
+                        assertCount(1, std::get<std::vector<std::string>>(delivered));
+                        assertEquals<std::string>("x", std::get<std::vector<std::string>>(delivered)[0]);
+                    }
+                };
+
+                // The structure is taken from the schema
+                auto document = std::make_shared<Document>(Parser::parse(std::get<std::vector<Token>>(tokens), compiledSchema).get());
+                assertCount(0, Deserializer::deserialize(Deserializer::compile(protocol), document, {.stringViews = stringViews}));
+                assertArray(value);
+                assertCount(0, Deserializer::deserialize(Deserializer::compile(viewProtocol, compiledSchema),
+                                                         document,
+                                                         {.stringViews = stringViews}));
+                assertArray(viewValue);
+
+                // Without the schema, it's taken from the syntax
+                document = std::make_shared<Document>(Parser::parse(std::get<std::vector<Token>>(tokens)).get());
+                assertCount(0, Deserializer::deserialize(Deserializer::compile(protocol), document, {.stringViews = stringViews}));
+                assertArray(value);
+            }
+        });
+    }
 };
@@ -2,6 +2,23 @@ using namespace HXL;
 
 class ParserTest : public BaseCase {
 public:
+    /**
+     * A property as it's expected to be parsed, with its values
+     * written as they appear in the source.
+     */
+    struct ExpectedProperty {
+        std::string name;
+        std::vector<std::string> values;
+        DataType dataType;
+    };
+
+    struct ExpectedNode {
+        std::string type;
+        std::string name;
+        std::vector<ExpectedProperty> properties;
+        std::optional<Inheritance> inheritance;
+    };
+
     /**
      * List of tests
      */
@@ -12,6 +29,7 @@ public:
         reference();
         inheritance();
         array();
+        schemaDirected();
 
         gen001_Empty();
         gen002_InvalidEOF();
@@ -32,7 +50,7 @@ public:
      * @param expectedNodes
      */
     void assertDocument(const Result<std::vector<Token>> &tokenizerResult,
-                        const std::vector<Node> &expectedNodes) {
+                        const std::vector<ExpectedNode> &expectedNodes) {
         assertFalse(tokenizerResult.isErr()).because("Tokenization must succeed.");
 
         // Display the error, as this is unexpected
@@ -91,7 +109,7 @@ public:
 
                     for (int h = 0; h < expectedNodes[i].properties[j].values.size(); ++h) {
                         assertEquals(expectedNodes[i].properties[j].values[h],
-                                     document.nodes[i].properties[j].values[h])
+                                     toString(document, document.nodes[i].properties[j], h))
                                 .because(std::format("Property value {} must match", expectedNodes[i].properties[j].name));
                     }
 
@@ -103,6 +121,118 @@ public:
         }
     }
 
+    /**
+     * Write a value of a parsed property the way it appears in the source.
+     *
+     * @param document
+     * @param nodeProperty
+     * @param index
+     * @return
+     */
+    static std::string toString(const Document &document, const NodeProperty &nodeProperty, size_t index) {
+        const PropertyScalar &value = nodeProperty.values[index];
+        switch (nodeProperty.dataType) {
+            case DataType::Bool:
+                return value.boolean ? "true" : "false";
+            case DataType::Int:
+                return std::to_string(value.integer);
+            case DataType::Float:
+                return std::format("{}", value.real);
+            default:
+                return std::string(document.text(value.string));
+        }
+    }
+
+    /**
+     * Check parsing directed by a compiled schema, where nodes and properties
+     * are resolved to their slots, and unknown ones are rejected right away.
+     */
+    void schemaDirected() {
+        CompiledSchema schema = SchemaCompiler::compile({
+                .types = {
+                        SchemaNodeType{
+                                .name = "Cube",
+                                .properties = {
+                                        SchemaNodeProperty{.name = "corners", .dataType = DataType::Int, .structure = ValueStructure::Array},
+                                }},
+                        SchemaNodeType{
+                                .name = "Sphere",
+                                .properties = {
+                                        SchemaNodeProperty{.name = "color", .dataType = DataType::String},
+                                        SchemaNodeProperty{.name = "radius", .dataType = DataType::Float, .required = true},
+                                }},
+                },
+        });
+
+        auto parse = [&](const std::string &source) {
+            return Parser::parse(std::get<std::vector<Token>>(Tokenizer::tokenize(source)), schema);
+        };
+
+        it("Resolves types and slots, and converts values", [&]() {
+            Result<Document> result = parse("<Sphere> A\n\tradius: 8\n\tcolor: \"red\"\n");
+            assertFalse(result.isErr());
+
+            Document document = result.get();
+            assertEquals<TypeId>(1, document.nodes[0].typeId.value());
+            assertEquals<SlotId>(1, document.nodes[0].properties[0].slot.value());
+            assertEquals<float>(8.0, std::get<float>(document.nodes[0].properties[0].value.value()));
+            assertEquals<SlotId>(0, document.nodes[0].properties[1].slot.value());
+        });
+
+        it("Rejects unknown node types and properties where they appear", [&]() {
+            assertError(ErrorCode::HXL_UNKNOWN_NODE_TYPE,
+                        "[Line 3, Col 3] Node type not declared in schema: Cone",
+                        parse("<Cube> A\n\n<Cone> B\n").error());
+            assertError(ErrorCode::HXL_UNKNOWN_PROPERTY,
+                        "[Line 2, Col 3] Node A has an unknown property: size",
+                        parse("<Cube> A\n\tsize: 8\n").error());
+        });
+
+        it("Rejects values of the wrong data type", [&]() {
+            assertError(ErrorCode::HXL_ILLEGAL_DATA_TYPE,
+                        "[Line 2, Col 3] Property radius on node A must be Float, got String",
+                        parse("<Sphere> A\n\tradius: \"8\"\n").error());
+        });
+
+        it("Checks required properties through inheritance", [&]() {
+            assertFalse(parse("<Sphere> A\n\tradius: 8\n<Sphere> B <= A\n<Sphere> C <= B\n").isErr());
+            assertError(ErrorCode::HXL_REQUIRED_PROPERTY_NOT_FOUND,
+                        "[Line 1, Col 1] Node A is missing required property: radius",
+                        parse("<Sphere> A\n\tcolor: \"red\"\n<Cube> B\n").error());
+            assertError(ErrorCode::HXL_INHERIT_DIFF_TYPES,
+                        "[Line 2, Col 16] Node B cannot inherit A of a different type.",
+                        parse("<Cube> A\n<Sphere> B <= A\n").error());
+        });
+
+        auto parseWithLimits = [&](const std::string &source, const ResourceLimits &limits) {
+            Document document;
+            NodeIndex nodeIndex;
+            return Parser::parse(std::get<std::vector<Token>>(Tokenizer::tokenize(source)), schema, document, nodeIndex, true, limits);
+        };
+
+        it("Stops at the limit of nodes", [&]() {
+            assertFalse(parseWithLimits("<Cube> A\n<Cube> B\n", {.maxNodes = 2}).has_value());
+            assertEquals(ErrorCode::HXL_TOO_MANY_NODES,
+                         parseWithLimits("<Cube> A\n<Cube> B\n<Cube> C\n", {.maxNodes = 2})->errorCode);
+        });
+
+        it("Stops at the limit of the length of arrays", [&]() {
+            assertFalse(parseWithLimits("<Cube> A\n\tcorners[]: { 1, 2, 3 }\n", {.maxArrayLength = 3}).has_value());
+            assertError(ErrorCode::HXL_ARRAY_TOO_LONG,
+                        "[Line 2, Col 3] Property corners exceeds the limit of 2 values",
+                        parseWithLimits("<Cube> A\n\tcorners[]: { 1, 2, 3 }\n", {.maxArrayLength = 2}).value());
+
+            // Large arrays of numbers are tokenized in one go
+            std::string numbers = "0";
+            for (int i = 1; i < 100; ++i) {
+                numbers += ", " + std::to_string(i);
+            }
+            assertFalse(parseWithLimits("<Cube> A\n\tcorners[]: { " + numbers + " }\n", {.maxArrayLength = 100}).has_value());
+            assertEquals(ErrorCode::HXL_ARRAY_TOO_LONG,
+                         parseWithLimits("<Cube> A\n\tcorners[]: { " + numbers + " }\n", {.maxArrayLength = 99})->errorCode);
+        });
+    }
+
     /**
      * Verify that an empty document causes an error.
      */
@@ -151,7 +281,7 @@ public:
             assertDocument(
                     Tokenizer::tokenize("<Sphere> MySphere\n\tradius: 8\n"),
                     {
-                            {"Sphere", "MySphere", {NodeProperty{"radius", {"8"}, DataType::Int}}},
+                            {"Sphere", "MySphere", {ExpectedProperty{"radius", {"8"}, DataType::Int}}},
                     });
 
             assertDocument(
@@ -159,10 +289,10 @@ public:
                     {
                             {"NodeType",
                              "A",
-                             {NodeProperty{"string", {"Hello, World!"}, DataType::String},
-                              NodeProperty{"int", {"12"}, DataType::Int},
-                              NodeProperty{"float", {"8.05"}, DataType::Float},
-                              NodeProperty{"bool", {"true"}, DataType::Bool}}},
+                             {ExpectedProperty{"string", {"Hello, World!"}, DataType::String},
+                              ExpectedProperty{"int", {"12"}, DataType::Int},
+                              ExpectedProperty{"float", {"8.05"}, DataType::Float},
+                              ExpectedProperty{"bool", {"true"}, DataType::Bool}}},
                     });
         });
     }
@@ -190,7 +320,7 @@ public:
             assertDocument(
                     Tokenizer::tokenize("<Sphere> MySphere\n\tref&: RefName\n"),
                     {
-                            {"Sphere", "MySphere", {NodeProperty{"ref", {"RefName"}, DataType::NodeRef}}},
+                            {"Sphere", "MySphere", {ExpectedProperty{"ref", {"RefName"}, DataType::NodeRef}}},
 
                     });
         });
@@ -219,7 +349,7 @@ public:
                     {
                             {"Sphere",
                              "A",
-                             {NodeProperty{"arr", {"1", "2", "3"}, DataType::Int}}},
+                             {ExpectedProperty{"arr", {"1", "2", "3"}, DataType::Int}}},
                     });
         });
 
@@ -229,7 +359,7 @@ public:
                     {
                             {"Sphere",
                              "A",
-                             {NodeProperty{"arr", {"1.5", "2.5", "-3.5"}, DataType::Float}}},
+                             {ExpectedProperty{"arr", {"1.5", "2.5", "-3.5"}, DataType::Float}}},
                     });
         });
 
@@ -239,9 +369,93 @@ public:
                     {
                             {"Sphere",
                              "A",
-                             {NodeProperty{"arr", {"a", "b", "c"}, DataType::String}}},
+                             {ExpectedProperty{"arr", {"a", "b", "c"}, DataType::String}}},
+                    });
+        });
+
+        it("Stores arrays mixing ints and floats as floats", [&]() {
+            assertDocument(
+                    Tokenizer::tokenize("<Sphere> A\n\tarr[]: { 1, 2.5, 3 }\n"),
+                    {
+                            {"Sphere",
+                             "A",
+                             {ExpectedProperty{"arr", {"1", "2.5", "3"}, DataType::Float}}},
                     });
         });
+
+        it("Rejects arrays mixing other data types", [&]() {
+            Result<Document> document = Parser::parse(Tokenizer::tokenize("<Sphere> A\n\tarr[]: { 1, \"b\" }\n").get());
+            assertTrue(document.isErr());
+            assertEquals(ErrorCode::HXL_ARRAY_MIXED_TYPES, document.error().errorCode);
+        });
+
+        it("Parses large arrays of numbers into typed buffers", [&]() {
+            std::string ints, floats;
+            for (int i = 0; i < 100; ++i) {
+                ints += std::format("{}{}", i > 0 ? ", " : "", i - 50);
+                floats += std::format("{}{}.25", i > 0 ? "," : "", i);
+            }
+
+            Result<std::vector<Token>> tokens = Tokenizer::tokenize("<Mesh> A\n\tindices[]: { " + ints + " }\n"
+                                                                    "\tvertices[]: {" + floats + "}\n");
+            Result<Document> document = Parser::parse(tokens.get());
+            assertFalse(document.isErr());
+
+            std::vector<NodeProperty> properties = document.get().nodes[0].properties;
+            assertEquals<DataType>(DataType::Int, properties[0].dataType);
+            assertCount(0, properties[0].values);
+
+            const auto &indices = std::get<std::vector<int>>(properties[0].value.value());
+            assertCount(100, indices);
+            assertEquals<int>(-50, indices[0]);
+            assertEquals<int>(49, indices[99]);
+
+            const auto &vertices = std::get<std::vector<float>>(properties[1].value.value());
+            assertEquals<DataType>(DataType::Float, properties[1].dataType);
+            assertCount(100, vertices);
+            assertEquals<float>(99.25, vertices[99]);
+        });
+
+        it("Reports errors in large arrays of numbers like in short ones", [&]() {
+            // The error of the tokenizer or of the parser, if any
+            auto parseArray = [](const std::string &contents) -> Result<Document> {
+                Result<std::vector<Token>> tokens = Tokenizer::tokenize("<Mesh> A\n\tindices[]: { " + contents + " }\n");
+                if (tokens.isErr()) {
+                    return tokens.error();
+                }
+                return Parser::parse(tokens.get());
+            };
+
+            // Valid numbers in front, so the array is taken in one go
+            std::string prefix;
+            for (int i = 0; i < 30; ++i) {
+                prefix += std::format("{}, ", i);
+            }
+
+            for (const char *contents: {"1 2", "1,,2", "1, 2,", "1, -", "1, 2.5.5"}) {
+                Result<Document> shortArray = parseArray(contents);
+                Result<Document> longArray = parseArray(prefix + contents);
+                assertTrue(shortArray.isErr());
+                assertTrue(longArray.isErr());
+                assertEquals(shortArray.error().errorCode, longArray.error().errorCode);
+            }
+
+            // Values out of range are reported at the property, so the errors are the same
+            for (const char *contents: {"99999999999", "99999999999, 1.5"}) {
+                Result<Document> shortArray = parseArray(contents);
+                Result<Document> longArray = parseArray(prefix + contents);
+                assertError(ErrorCode::HXL_ILLEGAL_DATA_TYPE,
+                            "[Line 2, Col 3] Value of property indices cannot be represented as Int",
+                            shortArray.error());
+                assertError(ErrorCode::HXL_ILLEGAL_DATA_TYPE,
+                            "[Line 2, Col 3] Value of property indices cannot be represented as Int",
+                            longArray.error());
+            }
+
+            // After a float, the numbers are converted as floats
+            assertFalse(parseArray("1.5, 99999999999").isErr());
+            assertFalse(parseArray(prefix + "1.5, 99999999999").isErr());
+        });
     }
 
     /**
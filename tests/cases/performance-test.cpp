@@ -0,0 +1,167 @@
+#include <fstream>
+
+using namespace HXL;
+using namespace HXL::Utilities;
+
+class PerformanceTest : public BaseCase {
+public:
+    /**
+     * List of tests.
+     */
+    void test() override {
+        json();
+        csv();
+        median();
+        comparison();
+    }
+
+    /**
+     * Results of a run, where parsing took ``parsingNs``.
+     */
+    static PerformanceResults run(PerformanceTime parsingNs) {
+        PerformanceResults results;
+        results.tokenization = ExecutionTime{.ms = 2, .ns = 2000, .counters = {.bytes = 1000, .tokens = 200}};
+        results.parsing = ExecutionTime{
+                .ms = parsingNs / 1000,
+                .ns = parsingNs,
+                .counters = {.bytes = 1000, .tokens = 200, .nodes = 20, .properties = 40, .arrayElements = 6, .references = 3, .inheritanceLinks = 2},
+                .allocations = AllocationCounters{.allocations = 25, .bytesAllocated = 4096, .bytesRetained = -16, .peakBytes = 2048},
+                .hardware = HardwareCounters{.cycles = 400000, .instructions = 1000000, .cacheMisses = 120, .branchMisses = 3500},
+                .probes = StageProbes{.typeLookups = 40, .slotLookups = 80, .numberConversions = 12, .stringBytes = 300},
+        };
+        return results;
+    }
+
+    /**
+     * Test exporting to, and reading from, JSON.
+     */
+    void json() {
+        it("Exports performance results as JSON, and reads them back", [&]() {
+            PerformanceResults results = run(123456);
+            std::string json = PerformanceResultsExporter::toJson(results);
+            assertTrue(json.find("\"semanticAnalysis\": null") != std::string::npos);
+            assertTrue(json.find("\"schemaValidation\": null") != std::string::npos);
+            assertTrue(json.find("\"nodesPerSecond\": ") != std::string::npos);
+
+            Result<PerformanceResults> read = PerformanceResultsExporter::fromJson(json);
+            assertFalse(read.isErr());
+
+            const PerformanceResults &imported = read.get();
+            assertFalse(imported.semanticAnalysis.has_value());
+            assertFalse(imported.tokenization->allocations.has_value());
+            assertEquals<PerformanceTime>(123456, imported.parsing->ns);
+            assertEquals<PerformanceTime>(123, imported.parsing->ms);
+            assertEquals<size_t>(20, imported.parsing->counters.nodes);
+            assertEquals<size_t>(2, imported.parsing->counters.inheritanceLinks);
+            assertEquals<size_t>(25, imported.parsing->allocations->allocations);
+            assertEquals<int64_t>(-16, imported.parsing->allocations->bytesRetained);
+            assertFalse(imported.tokenization->hardware.has_value());
+            assertEquals<uint64_t>(1000000, imported.parsing->hardware->instructions);
+            assertEquals<uint64_t>(3500, imported.parsing->hardware->branchMisses);
+            assertFalse(imported.tokenization->probes.has_value());
+            assertEquals<size_t>(80, imported.parsing->probes->slotLookups);
+            assertEquals<size_t>(300, imported.parsing->probes->stringBytes);
+        });
+
+        it("Skips unknown keys in JSON", [&]() {
+            Result<PerformanceResults> read = PerformanceResultsExporter::fromJson(
+                    "{\"version\": 2, \"parsing\": {\"ns\": 5000, \"extra\": {\"a\": 1.5e3}}}");
+            assertFalse(read.isErr());
+            assertEquals<PerformanceTime>(5000, read.get().parsing->ns);
+            assertEquals<PerformanceTime>(5, read.get().parsing->ms);
+        });
+
+        it("Reports invalid JSON", [&]() {
+            Result<PerformanceResults> read = PerformanceResultsExporter::fromJson("{\"parsing\": {\"ns\": }");
+            assertTrue(read.isErr());
+            assertEquals(ErrorCode::HXL_INVALID_PERFORMANCE_RESULTS, read.error().errorCode);
+
+            Result<PerformanceResults> missing = PerformanceResultsExporter::load("/nonexistent/baseline.json");
+            assertTrue(missing.isErr());
+            assertEquals(ErrorCode::HXL_CANNOT_READ_FILE, missing.error().errorCode);
+        });
+    }
+
+    /**
+     * Test exporting to CSV.
+     */
+    void csv() {
+        it("Exports performance results as CSV, with a row per run and stage", [&]() {
+            std::vector<PerformanceResults> runs = {run(1000), run(2000)};
+            std::string csv = PerformanceResultsExporter::toCsv(runs);
+
+            assertEquals<size_t>(5, std::count(csv.begin(), csv.end(), '\n'));
+            assertEquals<size_t>(0, csv.find("run,stage,ns,us,bytes,tokens,nodes,"));
+            assertTrue(csv.find("\n1,parsing,2000,2,1000,200,20,40,6,3,2,") != std::string::npos);
+
+            assertTrue(csv.find(",25,4096,-16,2048,0,400000,1000000,120,3500,0,0,0,40,") != std::string::npos);
+
+            // Allocations, hardware events and probes, which weren't counted, are left empty
+            assertTrue(csv.find("\n0,tokenization,2000,2,1000,200,0,0,0,0,0,500.000,0.000,,,,,,,,,,,,,,,,,\n") != std::string::npos);
+        });
+    }
+
+    /**
+     * Test the median of several runs.
+     */
+    void median() {
+        it("Takes the median of each stage over several runs", [&]() {
+            std::vector<PerformanceResults> runs = {run(5000), run(900000), run(4000), run(6000), run(5500)};
+            PerformanceResults median = PerformanceResultsComparator::median(runs);
+            assertEquals<PerformanceTime>(5500, median.parsing->ns);
+            assertEquals<PerformanceTime>(2000, median.tokenization->ns);
+            assertFalse(median.semanticAnalysis.has_value());
+
+            runs.pop_back();
+            assertEquals<PerformanceTime>(5500, PerformanceResultsComparator::median(runs).parsing->ns);
+        });
+    }
+
+    /**
+     * Test comparing runs with a baseline.
+     */
+    void comparison() {
+        PerformanceResults baseline = run(100000);
+
+        it("Reports a stage, which is slower than the baseline", [&]() {
+            std::vector<PerformanceResults> runs = {run(120000), run(121000), run(119000), run(500000)};
+            PerformanceComparison comparison = PerformanceResultsComparator::compare(baseline, runs);
+
+            assertCount(2, comparison.stages);
+            const StageComparison &parsing = comparison.stages[1];
+            assertEquals(std::string("parsing"), std::string(parsing.stage));
+            assertEquals<PerformanceTime>(120500, parsing.medianNs);
+            assertTrue(parsing.regressed);
+            assertFalse(comparison.stages[0].regressed);
+            assertTrue(comparison.regressed());
+
+            assertTrue(PerformanceResultsComparator::describe(comparison).find("parsing: 100000 ns -> 120500 ns") != std::string::npos);
+        });
+
+        it("Doesn't report differences within the noise of the runs", [&]() {
+            std::vector<PerformanceResults> runs = {run(80000), run(115000), run(150000)};
+            PerformanceComparison comparison = PerformanceResultsComparator::compare(baseline, runs);
+            assertEquals<PerformanceTime>(35000, comparison.stages[1].noiseNs);
+            assertFalse(comparison.regressed());
+        });
+
+        it("Reports a stage, which is faster than the baseline", [&]() {
+            std::vector<PerformanceResults> runs = {run(50000), run(51000), run(49000)};
+            PerformanceComparison comparison = PerformanceResultsComparator::compare(baseline, runs, {.tolerance = 0.1});
+            assertTrue(comparison.stages[1].improved);
+            assertFalse(comparison.regressed());
+        });
+
+        it("Compares with a baseline file", [&]() {
+            std::filesystem::path path = std::filesystem::temp_directory_path() / "hxl-performance-baseline.json";
+            std::ofstream(path) << PerformanceResultsExporter::toJson(baseline);
+
+            std::vector<PerformanceResults> runs = {run(200000), run(210000), run(205000)};
+            Result<PerformanceComparison> comparison = PerformanceResultsComparator::compare(path, runs);
+            std::filesystem::remove(path);
+
+            assertFalse(comparison.isErr());
+            assertTrue(comparison.get().regressed());
+        });
+    }
+};
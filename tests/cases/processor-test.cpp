@@ -0,0 +1,670 @@
+#include <atomic>
+
+// Allocations are counted through the hooks, so tests can check that
+// code doesn't allocate
+#include <hxl-lang/utilities/allocation-hooks.h>
+#include <hxl-lang/utilities/allocation-tracker.h>
+#include <hxl-lang/utilities/hardware-counters.h>
+
+using namespace HXL;
+
+class ProcessorTest : public BaseCase {
+public:
+    /**
+     * List of tests.
+     */
+    void test() override {
+        reusableInstance();
+        steadyStateAllocations();
+        batch();
+        pipelined();
+        async();
+        validationLevels();
+        metrics();
+        allocationTracking();
+        hardwareCounting();
+        instrumentation();
+    }
+
+    Schema schema{
+            .types = {
+                    SchemaNodeType{.name = "Message",
+                                   .properties = {
+                                           {"id", DataType::Int},
+                                           {"text", DataType::String},
+                                           {"to", DataType::NodeRef},
+                                           {"tags", DataType::Int, ValueStructure::Array},
+                                   }},
+            },
+    };
+
+    /**
+     * A processor with a protocol, which sums up the IDs and the lengths
+     * of the texts.
+     */
+    template<typename Instrumentation = StageInstrumentation>
+    struct SummingProcessor : BasicProcessor<Instrumentation> {
+        int ids = 0;
+        size_t textLength = 0;
+
+        explicit SummingProcessor(const Schema &schema, const ProcessorOptions &options = {})
+            : BasicProcessor<Instrumentation>(schema, protocol(schema, ids, textLength), options) {
+        }
+
+        // The protocol refers to the sums of this instance
+        SummingProcessor(const SummingProcessor &) = delete;
+
+        static DeserializationProtocol protocol(const Schema &schema, int &ids, size_t &textLength) {
+            PropertyKey id = SchemaCompiler::compile(schema).key("Message", "id").value();
+            PropertyKey text = SchemaCompiler::compile(schema).key("Message", "text").value();
+
+            DeserializationHandle message{"Message"};
+            message.viewHandle = [&ids, &textLength, id, text](const DeserializedNodeView &node) {
+                ids += node.get<int>(id);
+                if (node.has(text)) {
+                    textLength += node.text(text).size();
+                }
+            };
+
+            DeserializationProtocol protocol;
+            protocol.handles.push_back(message);
+            return protocol;
+        }
+    };
+
+    /**
+     * Test that an instance processes source after source.
+     */
+    void reusableInstance() {
+        it("Processes several sources with the same instance", [&]() {
+            SummingProcessor<> processor(schema);
+
+            ProcessResult first = processor.process("<Message> A\n\tid: 1\n\ttext: \"Hello\"\n<Message> B <= A\n\tid: 2\n");
+            assertCount(0, first.errors);
+            assertEquals<int>(3, processor.ids);
+            assertEquals<size_t>(10, processor.textLength);
+
+            ProcessResult second = processor.process("<Message> C\n\tid: 4\n");
+            assertCount(0, second.errors);
+            assertEquals<int>(7, processor.ids);
+
+            // The first result still holds on to its document
+            assertCount(2, first.document->nodes);
+            assertCount(1, second.document->nodes);
+
+            ProcessResult failed = processor.process("<Message> D\n\tid: \"x\"\n");
+            assertCount(1, failed.errors);
+            assertEquals(ErrorCode::HXL_ILLEGAL_DATA_TYPE, failed.errors[0].errorCode);
+        });
+    }
+
+    /**
+     * Test that processing a source similar to the previous one doesn't
+     * allocate, as all buffers are kept by the instance.
+     */
+    void steadyStateAllocations() {
+        it("Doesn't allocate when processing similar sources again", [&]() {
+            SummingProcessor<> processor(schema);
+
+            const std::string source = "<Message> A\n\tid: 1\n\ttext: \"Hello\"\n"
+                                       "<Message> B <= A\n\tid: 2\n\tto&: A\n"
+                                       "<Message> C\n\tid: 3\n\ttext: \"A text beyond any small string buffer\"\n";
+
+            auto run = [&]() {
+                ProcessResult result = processor.process(source, {.stringViews = true});
+                return result.errors.empty();
+            };
+
+            // The first run allocates the buffers
+            assertTrue(run());
+
+            AllocationTracker::Snapshot snapshot = AllocationTracker::start();
+            bool succeeded = true;
+            for (int i = 0; i < 10; ++i) {
+                succeeded = run() && succeeded;
+            }
+            size_t allocations = AllocationTracker::stop(snapshot).allocations;
+
+            assertTrue(succeeded);
+            assertEquals<size_t>(0, allocations);
+            assertEquals<int>(66, processor.ids);
+        });
+    }
+
+    /**
+     * Test that a batch of sources is processed in parallel, with a
+     * result per source.
+     */
+    void batch() {
+        it("Processes a batch of sources in parallel", [&]() {
+            std::atomic<int> ids = 0;
+            PropertyKey id = SchemaCompiler::compile(schema).key("Message", "id").value();
+
+            // Called from several threads at once
+            DeserializationHandle message{"Message"};
+            message.viewHandle = [&ids, id](const DeserializedNodeView &node) {
+                ids += node.get<int>(id);
+            };
+            DeserializationProtocol protocol;
+            protocol.handles.push_back(message);
+
+            std::vector<std::string> sources;
+            int expected = 0;
+            for (int i = 0; i < 200; ++i) {
+                if (i % 50 == 7) {
+                    sources.push_back(std::format("<Message> M{}\n\tid: \"x\"\n", i));
+                    continue;
+                }
+                sources.push_back(std::format("<Message> M{}\n\tid: {}\n<Message> N{} <= M{}\n", i, i, i, i));
+                expected += i * 2;
+            }
+
+            ThreadPool pool(4);
+            BatchProcessResult result = Processor::processBatch(sources, schema, protocol, pool);
+
+            assertCount(200, result.results);
+            assertEquals<size_t>(4, result.failed);
+            assertEquals<int>(expected, ids.load());
+
+            assertCount(1, result.results[7].errors);
+            assertEquals(ErrorCode::HXL_ILLEGAL_DATA_TYPE, result.results[7].errors[0].errorCode);
+            assertCount(0, result.results[8].errors);
+            assertEquals<std::string>("M8", result.results[8].document->nodes[0].name);
+            assertTrue(result.performanceResults.parsing.has_value());
+        });
+    }
+
+    /**
+     * Test that a source processed in a pipeline gives the same result
+     * as when it's processed stage by stage.
+     */
+    void pipelined() {
+        auto source = [](int count, const std::string &broken) {
+            std::string source = "# Messages\n<Message> M0\n\tid: 0\n\ttext: \"First\"\n\n";
+            for (int i = 1; i < count; ++i) {
+                source += std::format("<Message> M{} <= M0\n\tid: {}\n\tto&: M{}\n", i, i, i / 2);
+            }
+            return source + broken;
+        };
+
+        it("Processes a source in a pipeline", [&]() {
+            SummingProcessor<> processor(schema);
+            SummingProcessor<> pipelinedProcessor(schema);
+
+            ProcessResult expected = processor.process(source(500, ""));
+            ProcessResult result = pipelinedProcessor.processPipelined(source(500, ""), {}, {.batchSize = 7, .queueDepth = 2});
+
+            assertCount(0, result.errors);
+            assertEquals<int>(processor.ids, pipelinedProcessor.ids);
+            assertEquals<size_t>(processor.textLength, pipelinedProcessor.textLength);
+            assertEquals<size_t>(500 * 5, pipelinedProcessor.textLength);
+            assertCount(500, result.document->nodes);
+
+            // Inherited from the first node, from an earlier batch
+            const Node &last = result.document->nodes[499];
+            assertCount(3, last.properties);
+            assertEquals<size_t>(249, std::get<NodeRef>(last.properties[1].value.value()).index.value());
+
+            // The instance can be used again
+            result = pipelinedProcessor.processPipelined(source(3, ""));
+            assertCount(0, result.errors);
+            assertCount(3, result.document->nodes);
+        });
+
+        it("Reports errors found in a pipeline", [&]() {
+            SummingProcessor<> processor(schema);
+
+            for (const char *broken: {"<Message> X\n\tid: \"x\"\n",
+                                             "<Message> X <= Y\n\tid: 1\n",
+                                             "<Message> X\n\tid: 1\n\tid: 2\n",
+                                             "<Message> X\n\tid: 1",
+                                             "<Message> X\n\t@\n"}) {
+                ProcessResult expected = processor.process(source(100, broken));
+                ProcessResult result = processor.processPipelined(source(100, broken), {}, {.batchSize = 3});
+
+                assertCount(1, expected.errors);
+                assertCount(1, result.errors);
+                assertEquals(expected.errors[0].errorCode, result.errors[0].errorCode);
+                assertEquals(expected.errors[0].message, result.errors[0].message);
+            }
+
+            assertEquals(ErrorCode::HXL_EMPTY, processor.processPipelined("").errors[0].errorCode);
+        });
+    }
+
+    /**
+     * Test processing asynchronously, with progress and cancellation.
+     */
+    void async() {
+        std::string source;
+        for (int i = 0; i < 100; ++i) {
+            source += std::format("<Message> M{}\n\tid: 1\n", i);
+        }
+
+        it("Processes a source asynchronously", [&]() {
+            SummingProcessor<> processor(schema);
+
+            std::vector<ProcessProgress> reports;
+            std::future<ProcessResult> future = processor.processAsync(source, {
+                    .progress = [&](const ProcessProgress &progress) { reports.push_back(progress); },
+                    .batchSize = 30,
+            });
+            ProcessResult result = future.get();
+
+            assertCount(0, result.errors);
+            assertEquals<int>(100, processor.ids);
+
+            // Four batches while parsing, and four while deserializing
+            assertCount(8, reports);
+            assertEquals<size_t>(source.size(), reports[3].bytesTokenized);
+            assertEquals<size_t>(100, reports[3].nodesParsed);
+            assertEquals<size_t>(30, reports[4].nodesDeserialized);
+            assertEquals<size_t>(100, reports[7].nodesDeserialized);
+        });
+
+        it("Processes a source asynchronously on an executor", [&]() {
+            SummingProcessor<> processor(schema);
+            ThreadPool pool(2);
+
+            ProcessResult result = processor.processAsync(source, {
+                    .executor = [&pool](std::function<void()> task) { pool.submit(std::move(task)); },
+            }).get();
+
+            assertCount(0, result.errors);
+            assertEquals<int>(100, processor.ids);
+        });
+
+        it("Stops processing, when a stop is requested", [&]() {
+            std::stop_source stop;
+            int calls = 0;
+
+            DeserializationHandle message{"Message"};
+            message.viewHandle = [&](const DeserializedNodeView &) {
+                if (++calls == 5) {
+                    stop.request_stop();
+                }
+            };
+            DeserializationProtocol protocol;
+            protocol.handles.push_back(message);
+            Processor processor(schema, protocol);
+
+            ProcessResult result = processor.processAsync(source, {.stopToken = stop.get_token(), .batchSize = 20}).get();
+
+            assertCount(1, result.errors);
+            assertEquals(ErrorCode::HXL_CANCELLED, result.errors[0].errorCode);
+
+            // No handles are called after the stop, not even in the same batch
+            assertEquals<int>(5, calls);
+        });
+
+        it("Stops partway through a single large source", [&]() {
+            std::string large;
+            for (int i = 0; i < 10000; ++i) {
+                large += std::format("<Message> M{}\n\tid: 1\n", i);
+            }
+
+            // The whole source is a single batch
+            std::stop_source stop;
+            std::vector<ProcessProgress> reports;
+            int calls = 0;
+            DeserializationHandle message{"Message"};
+            message.viewHandle = [&](const DeserializedNodeView &) {
+                if (++calls == 100) {
+                    stop.request_stop();
+                }
+            };
+            DeserializationProtocol protocol;
+            protocol.handles.push_back(message);
+            Processor processor(schema, protocol);
+
+            ProcessResult result = processor.processAsync(large, {
+                    .progress = [&](const ProcessProgress &progress) { reports.push_back(progress); },
+                    .stopToken = stop.get_token(),
+                    .batchSize = 10000,
+            }).get();
+
+            assertCount(1, result.errors);
+            assertEquals(ErrorCode::HXL_CANCELLED, result.errors[0].errorCode);
+            assertEquals<int>(100, calls);
+
+            // Parsed in one go, but not deserialized
+            assertCount(1, reports);
+            assertEquals<size_t>(10000, reports[0].nodesParsed);
+        });
+
+        it("Stops tokenizing and parsing at the end of a line", [&]() {
+            std::stop_source stop;
+            stop.request_stop();
+
+            std::vector<Token> tokens;
+            std::optional<Error> error = Tokenizer::tokenize("<Message> A\n\tid: 1\n", tokens, 1, {.stopToken = stop.get_token()});
+            assertTrue(error.has_value());
+            assertEquals(ErrorCode::HXL_CANCELLED, error->errorCode);
+
+            assertFalse(Tokenizer::tokenize("<Message> A\n\tid: 1\n", tokens, 1).has_value());
+            CompiledSchema compiledSchema = SchemaCompiler::compile(schema);
+            Document document;
+            NodeIndex nodeIndex;
+            NoProbes probes;
+            error = Parser::parsePart(tokens, compiledSchema, document, nodeIndex, true, true, {}, probes, stop.get_token());
+            assertTrue(error.has_value());
+            assertEquals(ErrorCode::HXL_CANCELLED, error->errorCode);
+            assertCount(1, document.nodes);
+        });
+    }
+
+    /**
+     * Test that the validation levels skip the checks they're meant to,
+     * and keep the rest.
+     */
+    void validationLevels() {
+        Schema required{
+                .types = {
+                        SchemaNodeType{.name = "Message",
+                                       .properties = {
+                                               {"id", DataType::Int, ValueStructure::Single, true},
+                                               {"to", DataType::NodeRef},
+                                       }},
+                },
+        };
+
+        // Sums up the IDs, which may be missing, when they aren't required
+        auto lenientProtocol = [&](int &ids) {
+            PropertyKey id = SchemaCompiler::compile(required).key("Message", "id").value();
+            DeserializationHandle message{"Message"};
+            message.viewHandle = [&ids, id](const DeserializedNodeView &node) {
+                ids += node.has(id) ? node.get<int>(id) : 0;
+            };
+
+            DeserializationProtocol protocol;
+            protocol.handles.push_back(message);
+            return protocol;
+        };
+
+        auto processWith = [&](ValidationLevel validation, const std::string &source, int &ids) {
+            Processor processor(required, lenientProtocol(ids), {.validation = validation});
+            return processor.process(source);
+        };
+
+        it("Skips the semantic analysis at the structural level", [&]() {
+            const std::string source = "<Message> A\n\tid: 1\n\tto&: B\n<Message> A\n\tid: 2\n";
+
+            int ids = 0;
+            assertCount(2, processWith(ValidationLevel::Full, source, ids).errors);
+            assertEquals<int>(0, ids);
+
+            ProcessResult result = processWith(ValidationLevel::Structural, source, ids);
+            assertCount(0, result.errors);
+            assertEquals<int>(3, ids);
+
+            // The reference can't be resolved, as B doesn't exist
+            const NodeProperty &to = result.document->nodes[0].properties[1];
+            assertFalse(std::get<NodeRef>(to.value.value()).index.has_value());
+        });
+
+        it("Skips required properties, when trusted", [&]() {
+            const std::string source = "<Message> A\n\tto&: A\n";
+
+            int ids = 0;
+            ProcessResult result = processWith(ValidationLevel::Structural, source, ids);
+            assertCount(1, result.errors);
+            assertEquals(ErrorCode::HXL_REQUIRED_PROPERTY_NOT_FOUND, result.errors[0].errorCode);
+
+            assertCount(0, processWith(ValidationLevel::Trusted, source, ids).errors);
+        });
+
+        it("Keeps checking data types, when trusted", [&]() {
+            int ids = 0;
+            ProcessResult result = processWith(ValidationLevel::Trusted, "<Message> A\n\tid: \"x\"\n", ids);
+            assertCount(1, result.errors);
+            assertEquals(ErrorCode::HXL_ILLEGAL_DATA_TYPE, result.errors[0].errorCode);
+        });
+
+        it("Runs processors with different indentation at the same time", [&]() {
+            SummingProcessor<> two(schema, {.tokenizer = {.indentSize = 2}});
+            SummingProcessor<> four(schema, {.tokenizer = {.indentSize = 4}});
+
+            ProcessResult twoResult, fourResult;
+            std::thread thread([&]() {
+                for (int i = 0; i < 50; ++i) {
+                    twoResult = two.process("<Message> A\n  id: 1\n");
+                }
+            });
+            for (int i = 0; i < 50; ++i) {
+                fourResult = four.process("<Message> A\n    id: 1\n");
+            }
+            thread.join();
+
+            assertCount(0, twoResult.errors);
+            assertCount(0, fourResult.errors);
+            assertEquals<int>(50, two.ids);
+            assertEquals<int>(50, four.ids);
+        });
+
+        it("Applies the validation level in a pipeline", [&]() {
+            int ids = 0;
+            Processor processor(required, lenientProtocol(ids), {.validation = ValidationLevel::Trusted});
+            ProcessResult result = processor.processPipelined("<Message> A\n\tto&: B\n<Message> B\n\tid: 2\n", {}, {.batchSize = 1});
+            assertCount(0, result.errors);
+            assertEquals<int>(2, ids);
+        });
+
+        it("Applies the limit of tokens to the whole source, when processed in parts", [&]() {
+            std::string source;
+            for (int i = 0; i < 10; ++i) {
+                source += std::format("<Message> M{}\n\tid: {}\n", i, i);
+            }
+
+            int ids = 0;
+            Processor processor(required, lenientProtocol(ids), {.limits = {.maxTokens = 100}});
+            for (const ProcessResult &result: {processor.process(source),
+                                               processor.processPipelined(source, {}, {.batchSize = 1}),
+                                               processor.processAsync(source, {.batchSize = 1}).get()}) {
+                assertCount(1, result.errors);
+                assertEquals(ErrorCode::HXL_TOO_MANY_TOKENS, result.errors[0].errorCode);
+            }
+        });
+    }
+
+    /**
+     * Test the counters reported with the time of each stage.
+     */
+    void metrics() {
+        const std::string source = "<Message> A\n\tid: 1\n\ttext: \"Hello\"\n\ttags[]: { 1, 2, 3 }\n"
+                                   "<Message> B <= A\n\tid: 2\n\tto&: A\n";
+
+        it("Counts the work of each stage", [&]() {
+            SummingProcessor<> processor(schema);
+            ProcessResult result = processor.process(source);
+            assertCount(0, result.errors);
+
+            const PerformanceResults &results = result.performanceResults;
+            assertEquals<size_t>(source.size(), results.tokenization->counters.bytes);
+            assertTrue(results.tokenization->counters.tokens > 0);
+            assertEquals<size_t>(results.tokenization->counters.tokens, results.parsing->counters.tokens);
+
+            const StageCounters &parsed = results.parsing->counters;
+            assertEquals<size_t>(2, parsed.nodes);
+            assertEquals<size_t>(5, parsed.properties);
+            assertEquals<size_t>(3, parsed.arrayElements);
+            assertEquals<size_t>(1, parsed.references);
+            assertEquals<size_t>(1, parsed.inheritanceLinks);
+
+            // The inherited properties are counted, once transformed
+            assertEquals<size_t>(7, results.transformer->counters.properties);
+            assertEquals<size_t>(6, results.deserialization->counters.arrayElements);
+
+            ExecutionTime total = results.getTotal();
+            assertEquals<size_t>(source.size(), total.counters.bytes);
+            assertEquals<size_t>(2, total.counters.nodes);
+            assertTrue(total.ns >= total.ms * 1000);
+        });
+
+        it("Counts the same work, when processed in parts", [&]() {
+            SummingProcessor<> processor(schema);
+            ProcessResult expected = processor.process(source);
+
+            for (const ProcessResult &result: {processor.processPipelined(source, {}, {.batchSize = 1}),
+                                               processor.processAsync(source, {.batchSize = 1}).get()}) {
+                assertCount(0, result.errors);
+                for (auto stage: {&PerformanceResults::tokenization,
+                                  &PerformanceResults::parsing,
+                                  &PerformanceResults::semanticAnalysis,
+                                  &PerformanceResults::transformer,
+                                  &PerformanceResults::deserialization}) {
+                    const StageCounters &counters = (result.performanceResults.*stage)->counters;
+                    const StageCounters &expectedCounters = (expected.performanceResults.*stage)->counters;
+                    assertEquals<size_t>(expectedCounters.bytes, counters.bytes);
+                    assertEquals<size_t>(expectedCounters.tokens, counters.tokens);
+                    assertEquals<size_t>(expectedCounters.nodes, counters.nodes);
+                    assertEquals<size_t>(expectedCounters.properties, counters.properties);
+                    assertEquals<size_t>(expectedCounters.arrayElements, counters.arrayElements);
+                    assertEquals<size_t>(expectedCounters.references, counters.references);
+                    assertEquals<size_t>(expectedCounters.inheritanceLinks, counters.inheritanceLinks);
+                }
+            }
+        });
+    }
+
+    /**
+     * Test counting the allocations of each stage.
+     */
+    void allocationTracking() {
+        const std::string source = "<Message> A\n\tid: 1\n\ttext: \"A text beyond any small string buffer\"\n"
+                                   "<Message> B <= A\n\tid: 2\n\tto&: A\n";
+
+        it("Tracks the allocations of each stage, when enabled", [&]() {
+            SummingProcessor<> processor(schema, {.trackAllocations = true});
+
+            // The first run allocates the buffers, which are kept by the instance
+            ProcessResult first = processor.process(source);
+            assertCount(0, first.errors);
+            const AllocationCounters &parsing = first.performanceResults.parsing->allocations.value();
+            assertTrue(parsing.allocations > 0);
+            assertTrue(parsing.bytesAllocated > 0);
+            assertTrue(parsing.bytesRetained > 0);
+            assertTrue(parsing.peakBytes >= static_cast<size_t>(parsing.bytesRetained));
+
+            first = {};
+            ProcessResult second = processor.process(source, {.stringViews = true});
+            assertCount(0, second.errors);
+            for (const auto &stage: {second.performanceResults.tokenization,
+                                     second.performanceResults.parsing,
+                                     second.performanceResults.semanticAnalysis,
+                                     second.performanceResults.transformer}) {
+                assertEquals<size_t>(0, stage->allocations->allocations);
+                assertEquals<int64_t>(0, stage->allocations->bytesRetained);
+            }
+        });
+
+        it("Doesn't track allocations by default", [&]() {
+            SummingProcessor<> processor(schema);
+            ProcessResult result = processor.process(source);
+            assertCount(0, result.errors);
+            assertFalse(result.performanceResults.parsing->allocations.has_value());
+        });
+
+        it("Tracks the allocations of each stage in a pipeline", [&]() {
+            SummingProcessor<> processor(schema, {.trackAllocations = true});
+            ProcessResult result = processor.processPipelined(source, {}, {.batchSize = 1});
+            assertCount(0, result.errors);
+            assertTrue(result.performanceResults.tokenization->allocations->allocations > 0);
+            assertTrue(result.performanceResults.parsing->allocations->allocations > 0);
+        });
+    }
+
+    /**
+     * Test counting the hardware events of each stage.
+     */
+    void hardwareCounting() {
+        const std::string source = "<Message> A\n\tid: 1\n\ttags[]: { 1, 2, 3 }\n<Message> B <= A\n\tid: 2\n\tto&: A\n";
+
+        it("Counts the hardware events of each stage, where they're available", [&]() {
+            SummingProcessor<> processor(schema, {.trackAllocations = true, .countHardwareEvents = true});
+            ProcessResult result = processor.process(source);
+            assertCount(0, result.errors);
+
+            // Without the counters, the stages are still measured
+            const ExecutionTime &parsing = result.performanceResults.parsing.value();
+            assertTrue(parsing.allocations.has_value());
+            assertEquals(HardwareCounterReader::available(), parsing.hardware.has_value());
+            if (parsing.hardware.has_value()) {
+                assertTrue(parsing.hardware->instructions > 0);
+                assertTrue(parsing.hardware->cycles > 0);
+                assertTrue(result.performanceResults.getTotal().hardware->instructions >= parsing.hardware->instructions);
+            }
+        });
+
+        it("Doesn't count hardware events by default", [&]() {
+            SummingProcessor<> processor(schema);
+            ProcessResult result = processor.process(source);
+            assertCount(0, result.errors);
+            assertFalse(result.performanceResults.parsing->hardware.has_value());
+            assertFalse(result.performanceResults.getTotal().hardware.has_value());
+        });
+
+        it("Adds up the hardware events of the parts of a stage", [&]() {
+            ExecutionTime stage{.ms = 1, .ns = 1000};
+            stage += ExecutionTime{.ms = 1, .ns = 1000, .hardware = HardwareCounters{.cycles = 100, .instructions = 300, .branchMisses = 2}};
+            stage += ExecutionTime{.ms = 1, .ns = 1000, .hardware = HardwareCounters{.cycles = 100, .instructions = 100, .cacheMisses = 5}};
+            assertEquals<uint64_t>(200, stage.hardware->cycles);
+            assertEquals<uint64_t>(5, stage.hardware->cacheMisses);
+            assertEquals<uint64_t>(2, stage.hardware->branchMisses);
+            assertEquals(2.0, stage.hardware->instructionsPerCycle());
+        });
+    }
+
+    /**
+     * Test the instrumentation policies.
+     */
+    void instrumentation() {
+        const std::string source = "<Message> A\n\tid: 1\n\ttext: \"Hello\"\n\ttags[]: { 1, 2, 3 }\n"
+                                   "<Message> B <= A\n\tid: 2\n\tto&: A\n";
+
+        it("Measures nothing without instrumentation", [&]() {
+            SummingProcessor<NoInstrumentation> processor(schema);
+
+            for (const ProcessResult &result: {processor.process(source),
+                                               processor.processPipelined(source, {}, {.batchSize = 1}),
+                                               processor.processAsync(source).get()}) {
+                assertCount(0, result.errors);
+                for (const PerformanceResults::Stage &stage: PerformanceResults::stages()) {
+                    assertFalse((result.performanceResults.*stage.result).has_value());
+                }
+            }
+            assertEquals<int>(9, processor.ids);
+            assertEquals<size_t>(30, processor.textLength);
+        });
+
+        it("Takes probes inside the tokenizer and parser with full instrumentation", [&]() {
+            SummingProcessor<FullInstrumentation> processor(schema);
+
+            for (const ProcessResult &result: {processor.process(source),
+                                               processor.processPipelined(source, {}, {.batchSize = 1}),
+                                               processor.processAsync(source, {.batchSize = 1}).get()}) {
+                assertCount(0, result.errors);
+                const StageProbes &tokenizer = result.performanceResults.tokenization->probes.value();
+                assertEquals<size_t>(5, tokenizer.literalBytes);
+
+                const StageProbes &parser = result.performanceResults.parsing->probes.value();
+                assertEquals<size_t>(2, parser.typeLookups);
+                assertEquals<size_t>(5, parser.slotLookups);
+                assertEquals<size_t>(1, parser.nodeLookups);
+                assertEquals<size_t>(5, parser.numberConversions);
+                assertEquals<size_t>(6, parser.stringBytes);
+
+                assertFalse(result.performanceResults.transformer->probes.has_value());
+                assertEquals<size_t>(2, result.performanceResults.parsing->counters.nodes);
+            }
+        });
+
+        it("Doesn't take probes by default", [&]() {
+            SummingProcessor<> processor(schema);
+            ProcessResult result = processor.process(source);
+            assertCount(0, result.errors);
+            assertTrue(result.performanceResults.tokenization.has_value());
+            assertFalse(result.performanceResults.tokenization->probes.has_value());
+            assertFalse(result.performanceResults.parsing->probes.has_value());
+        });
+    }
+};
@@ -0,0 +1,179 @@
+using namespace HXL;
+
+class ProjectTest : public BaseCase {
+public:
+    /**
+     * List of tests.
+     */
+    void test() override {
+        crossFileLinking();
+        caching();
+        errors();
+        parallel();
+    }
+
+    Schema schema{
+            .types = {
+                    SchemaNodeType{.name = "Message",
+                                   .properties = {
+                                           {"id", DataType::Int, ValueStructure::Single, true},
+                                           {"text", DataType::String},
+                                           {"to", DataType::NodeRef},
+                                   }},
+            },
+    };
+
+    /**
+     * A project with a protocol, which records the names of the nodes, and
+     * sums up their IDs.
+     */
+    struct RecordingProject : Project {
+        std::vector<std::string> names;
+        int ids = 0;
+
+        explicit RecordingProject(const Schema &schema)
+            : Project(schema, protocol(names, ids)) {
+        }
+
+        // The protocol refers to the records of this instance
+        RecordingProject(const RecordingProject &) = delete;
+
+        static DeserializationProtocol protocol(std::vector<std::string> &names, int &ids) {
+            DeserializationHandle message{"Message"};
+            message.handle = [&names, &ids](const DeserializedNode &node) {
+                names.push_back(node.name);
+                ids += std::get<int>(node.properties.at("id").value);
+            };
+
+            DeserializationProtocol protocol;
+            protocol.handles.push_back(message);
+            return protocol;
+        }
+    };
+
+    /**
+     * Test that nodes reference and inherit nodes of other files.
+     */
+    void crossFileLinking() {
+        it("Links references and inheritance across files", [&]() {
+            RecordingProject project(schema);
+            project.setFile("a.hxl", "<Message> A <= B\n\tto&: C\n");
+            project.setFile("b.hxl", "<Message> B\n\tid: 2\n\ttext: \"Hi\"\n<Message> C\n\tid: 3\n");
+
+            ProcessResult result = project.process();
+            assertCount(0, result.errors);
+
+            // A comes after the nodes it depends on, and inherits its ID from B
+            assertEquals<std::string>("B,C,A", project.names[0] + "," + project.names[1] + "," + project.names[2]);
+            assertEquals<int>(7, project.ids);
+        });
+    }
+
+    /**
+     * Test that only new and changed files are parsed.
+     */
+    void caching() {
+        it("Only parses the files which have changed", [&]() {
+            RecordingProject project(schema);
+            project.setFile("a.hxl", "<Message> A\n\tid: 1\n\tto&: B\n");
+            project.setFile("b.hxl", "<Message> B\n\tid: 2\n");
+
+            assertCount(0, project.process().errors);
+            assertEquals<size_t>(2, project.parseCount());
+
+            assertCount(0, project.process().errors);
+            assertEquals<size_t>(2, project.parseCount());
+
+            // Same content
+            project.setFile("b.hxl", "<Message> B\n\tid: 2\n");
+            assertCount(0, project.process().errors);
+            assertEquals<size_t>(2, project.parseCount());
+
+            project.setFile("b.hxl", "<Message> B\n\tid: 5\n");
+            assertCount(0, project.process().errors);
+            assertEquals<size_t>(3, project.parseCount());
+            assertEquals<int>(3 + 3 + 3 + 6, project.ids);
+
+            // Same length, but different content
+            project.setFile("b.hxl", "<Message> B\n\tid: 6\n");
+            assertCount(0, project.process().errors);
+            assertEquals<size_t>(4, project.parseCount());
+
+            project.removeFile("a.hxl");
+            project.names.clear();
+            assertCount(0, project.process().errors);
+            assertCount(1, project.names);
+        });
+    }
+
+    /**
+     * Test errors, which are found in a file or when linking.
+     */
+    void errors() {
+        it("Prefixes errors in a file with its name", [&]() {
+            RecordingProject project(schema);
+            project.setFile("a.hxl", "<Message> A\n\tid: 1\n");
+            project.setFile("b.hxl", "<Message> B\n\tid: \"x\"\n");
+
+            ProcessResult result = project.process();
+            assertCount(1, result.errors);
+            assertEquals(ErrorCode::HXL_ILLEGAL_DATA_TYPE, result.errors[0].errorCode);
+            assertTrue(result.errors[0].message.starts_with("b.hxl: [Line 2"));
+            assertCount(0, project.names);
+        });
+
+        it("Rejects nodes which depend on each other across files", [&]() {
+            RecordingProject project(schema);
+            project.setFile("a.hxl", "<Message> A <= B\n\tid: 1\n");
+            project.setFile("b.hxl", "<Message> B\n\tid: 2\n\tto&: A\n");
+
+            ProcessResult result = project.process();
+            assertCount(1, result.errors);
+            assertEquals(ErrorCode::HXL_CIRCULAR_NODE_REFERENCE, result.errors[0].errorCode);
+        });
+
+        it("Reports nodes declared in several files", [&]() {
+            RecordingProject project(schema);
+            project.setFile("a.hxl", "<Message> A\n\tid: 1\n");
+            project.setFile("b.hxl", "<Message> A\n\tid: 2\n");
+
+            ProcessResult result = project.process();
+            assertCount(1, result.errors);
+            assertEquals(ErrorCode::HXL_NON_UNIQUE_NODE, result.errors[0].errorCode);
+        });
+
+        it("Reports missing required properties, after inheriting across files", [&]() {
+            RecordingProject project(schema);
+            project.setFile("a.hxl", "<Message> A <= B\n\ttext: \"x\"\n<Message> C\n\ttext: \"y\"\n");
+            project.setFile("b.hxl", "<Message> B\n\tid: 2\n");
+
+            ProcessResult result = project.process();
+            assertCount(1, result.errors);
+            assertEquals(ErrorCode::HXL_REQUIRED_PROPERTY_NOT_FOUND, result.errors[0].errorCode);
+            assertTrue(result.errors[0].message.find("Node C") != std::string::npos);
+        });
+    }
+
+    /**
+     * Test that files are parsed in parallel on a pool.
+     */
+    void parallel() {
+        it("Parses files in parallel", [&]() {
+            RecordingProject project(schema);
+            for (int i = 0; i < 20; ++i) {
+                std::string source = std::format("<Message> M{}\n\tid: {}\n", i, i);
+                if (i + 1 < 20) {
+                    source += std::format("\tto&: M{}\n", i + 1);
+                }
+                project.setFile(std::format("{}.hxl", i), source);
+            }
+
+            ThreadPool pool(4);
+            ProcessResult result = project.process(&pool);
+            assertCount(0, result.errors);
+            assertCount(20, project.names);
+            assertEquals<int>(190, project.ids);
+            assertEquals<std::string>("M19", project.names[0]);
+        });
+    }
+};
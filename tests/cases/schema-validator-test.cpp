@@ -7,6 +7,8 @@ public:
         schema500_InvalidNodeType();
         schema520_RequiredProperty();
         schema522_UnknownProperty();
+        schema530_IllegalDataType();
+        convertsValues();
     }
 
     /**
@@ -114,4 +116,43 @@ public:
                              "Node A has an unknown property: unknown");
         });
     }
+
+    /**
+     * SCHEMA.530: Data type doesn't match the schema
+     */
+    void schema530_IllegalDataType() {
+        it("Checks that the data type of a property matches the schema.", [&]() {
+            assertSchemaRule("<Sphere> A\n\trequired: \"10\"\n",
+                             ErrorCode::HXL_ILLEGAL_DATA_TYPE,
+                             "[Line 2, Col 3] Property required on node A must be Int, got String");
+        });
+    }
+
+    /**
+     * Check that properties which pass validation are converted to
+     * their final value, and that integers are accepted as floats.
+     */
+    void convertsValues() {
+        it("Converts validated properties to their final value", [&]() {
+            Schema schema{
+                    .types = {
+                            SchemaNodeType{
+                                    .name = "A",
+                                    .properties = {
+                                            SchemaNodeProperty{.name = "size", .dataType = DataType::Float},
+                                            SchemaNodeProperty{.name = "pos", .dataType = DataType::Int, .structure = ValueStructure::Array},
+                                    }},
+                    },
+            };
+
+            Result<std::vector<Token>> tokens = Tokenizer::tokenize("<A> A\n\tsize: 8\n\tpos[]: { 4 }\n");
+            Result<Document> syntaxTree = Parser::parse(std::get<std::vector<Token>>(tokens));
+            std::shared_ptr<Document> document = std::make_shared<Document>(syntaxTree.get());
+            std::vector<Error> errors = SchemaValidator::validate(schema, document);
+
+            assertCount(0, errors);
+            assertEquals<float>(8.0, std::get<float>(document->nodes[0].properties[0].value.value()));
+            assertCount(1, std::get<std::vector<int>>(document->nodes[0].properties[1].value.value()));
+        });
+    }
 };
@@ -26,6 +26,9 @@ public:
         str004_LineBreakWithinStringLiteral();
         cmt003_EmptyComment();
         cmt004_WhitespaceCommentsStandAlone();
+
+        limits();
+        probes();
     }
 
     /**
@@ -217,6 +220,28 @@ public:
                             {TokenType::T_NEWLINE},
                     });
         });
+
+        it("Tokenizes a large array of numbers as a whole", [&]() {
+            std::string numbers;
+            for (int i = 0; i < 40; ++i) {
+                numbers += std::format("{}{}.5", i > 0 ? ", " : " ", i);
+            }
+            numbers += " ";
+
+            assertTokenResult(
+                    Tokenizer::tokenize("\tkey[]: {" + numbers + "}\n"),
+                    {
+                            {TokenType::T_TAB},
+                            {TokenType::T_IDENTIFIER, "key"},
+                            {TokenType::T_DELIMITER, "[]"},
+                            {TokenType::T_DELIMITER, ":"},
+                            {TokenType::T_WHITESPACE},
+                            {TokenType::T_PUNCTUATOR, "{"},
+                            {TokenType::T_NUMERIC_ARRAY, numbers},
+                            {TokenType::T_PUNCTUATOR, "}"},
+                            {TokenType::T_NEWLINE},
+                    });
+        });
     }
 
     /**
@@ -264,6 +289,25 @@ public:
                             {TokenType::T_NEWLINE},
                     });
         });
+
+        it("Converts a configured number of white space characters to tabs", [&]() {
+            assertTokenResult(
+                    Tokenizer::tokenize("<NodeType> A\n  key: 5\n", {.indentSize = 2}),
+                    {
+                            {TokenType::T_DELIMITER, "<"},
+                            {TokenType::T_IDENTIFIER, "NodeType"},
+                            {TokenType::T_DELIMITER, ">"},
+                            {TokenType::T_WHITESPACE},
+                            {TokenType::T_IDENTIFIER, "A"},
+                            {TokenType::T_NEWLINE},
+                            {TokenType::T_TAB},
+                            {TokenType::T_IDENTIFIER, "key"},
+                            {TokenType::T_DELIMITER, ":"},
+                            {TokenType::T_WHITESPACE},
+                            {TokenType::T_INT, "5"},
+                            {TokenType::T_NEWLINE},
+                    });
+        });
     }
 
     /**
@@ -391,4 +435,40 @@ public:
                         result.error());
         });
     }
+    /**
+     * Resource limits
+     */
+    void limits() {
+        it("Stops at the limit of tokens", [&]() {
+            assertFalse(Tokenizer::tokenize("<A> B\n", {}, {.maxTokens = 6}).isErr());
+            assertError(ErrorCode::HXL_TOO_MANY_TOKENS,
+                        "[Line 2] Source exceeds the limit of tokens",
+                        std::get<Error>(Tokenizer::tokenize("<A> B\n<A> C\n", {}, {.maxTokens = 8})));
+        });
+
+        it("Stops at the limit of the length of strings", [&]() {
+            assertFalse(Tokenizer::tokenize("\tkey: \"Hello\"\n", {}, {.maxStringLength = 5}).isErr());
+            assertEquals(ErrorCode::HXL_STRING_TOO_LONG,
+                         std::get<Error>(Tokenizer::tokenize("\tkey: \"Hello\"\n", {}, {.maxStringLength = 4})).errorCode);
+            assertEquals(ErrorCode::HXL_STRING_TOO_LONG,
+                         std::get<Error>(Tokenizer::tokenize("<NodeType> A\n", {}, {.maxStringLength = 4})).errorCode);
+        });
+    }
+
+    /**
+     * Probes of the tokenizer
+     */
+    void probes() {
+        it("Records the bytes, which are taken in bulk", [&]() {
+            std::string numbers = "1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23";
+            std::string source = "# A comment\n<A> B\n\tkey: \"Hello\"\n\tvalues[]: {" + numbers + "}\n";
+            std::vector<Token> tokens;
+            StageProbes probes;
+            assertFalse(Tokenizer::tokenize(source, tokens, 1, {}, {}, probes).has_value());
+            assertEquals<size_t>(5, probes.literalBytes);
+            assertEquals<size_t>(11, probes.commentBytes);
+            assertEquals<size_t>(numbers.size(), probes.numericArrayBytes);
+            assertEquals<size_t>(0, probes.typeLookups);
+        });
+    }
 };
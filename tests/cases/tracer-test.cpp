@@ -0,0 +1,117 @@
+#include <map>
+#include <set>
+#include <thread>
+
+using namespace HXL;
+
+class TracerTest : public BaseCase {
+public:
+    /**
+     * List of tests.
+     */
+    void test() override {
+        spans();
+        json();
+        processing();
+    }
+
+    /**
+     * Test recording spans.
+     */
+    void spans() {
+        it("Records spans with the active tracer, per thread", [&]() {
+            Tracer tracer;
+            tracer.begin();
+            {
+                TraceSpan outer("outer", "stage");
+                std::thread([]() {
+                    TraceSpan inner("inner", "prepare");
+                }).join();
+            }
+            tracer.end();
+
+            std::vector<TraceEvent> events = tracer.events();
+            assertCount(2, events);
+            assertEquals(std::string("inner"), events[0].name);
+            assertEquals(std::string("prepare"), events[0].category);
+            assertEquals(std::string("outer"), events[1].name);
+            assertTrue(events[0].threadId != events[1].threadId);
+            assertTrue(events[1].startNs <= events[0].startNs);
+            assertTrue(events[1].durationNs >= events[0].durationNs);
+        });
+
+        it("Doesn't record spans without an active tracer", [&]() {
+            Tracer tracer;
+            {
+                TraceSpan before("before", "stage");
+            }
+            tracer.begin();
+            tracer.end();
+            {
+                TraceSpan after("after", "stage");
+            }
+            assertCount(0, tracer.events());
+            assertTrue(Tracer::active() == nullptr);
+        });
+    }
+
+    /**
+     * Test writing Chrome trace events.
+     */
+    void json() {
+        it("Writes the spans as Chrome trace events", [&]() {
+            Tracer tracer;
+            tracer.begin();
+            {
+                TraceSpan span("Say \"Hi\"", "handle");
+            }
+            tracer.end();
+
+            std::string json = tracer.toJson();
+            assertEquals<size_t>(0, json.find("{\"traceEvents\": [\n  {\"name\": \"Say \\\"Hi\\\"\", \"cat\": \"handle\", \"ph\": \"X\", \"ts\": "));
+            assertTrue(json.find("\"tid\": " + std::to_string(Tracer::threadId()) + "}") != std::string::npos);
+        });
+    }
+
+    /**
+     * Test the spans recorded while processing, when tracing is compiled in.
+     */
+    void processing() {
+#if defined(HXL_TRACING)
+        it("Traces the stages of a pipeline on their threads", [&]() {
+            Schema schema{.types = {SchemaNodeType{.name = "Message", .properties = {{"id", DataType::Int}}}}};
+            DeserializationHandle message{"Message"};
+            message.batchHandle = [](std::span<const DeserializedNodeView>) {};
+            message.batchSize = 4;
+            DeserializationProtocol protocol;
+            protocol.handles.push_back(message);
+
+            std::string source;
+            for (int i = 0; i < 10; ++i) {
+                source += std::format("<Message> M{}\n\tid: {}\n", i, i);
+            }
+
+            Tracer tracer;
+            tracer.begin();
+            Processor processor(schema, protocol);
+            ProcessResult result = processor.processPipelined(source, {}, {.batchSize = 5});
+            tracer.end();
+            assertCount(0, result.errors);
+
+            std::map<std::string, std::set<uint32_t>> threads;
+            for (const TraceEvent &event: tracer.events()) {
+                threads[event.name].insert(event.threadId);
+            }
+            assertCount(1, threads["tokenization"]);
+            assertCount(1, threads["parsing"]);
+            assertTrue(threads["tokenization"] != threads["parsing"]);
+
+            // A span per batch of nodes passed to the handle
+            std::vector<TraceEvent> events = tracer.events();
+            assertEquals<long>(3, std::count_if(events.begin(), events.end(), [](const TraceEvent &event) {
+                return event.name == "Message" && event.category == "handle";
+            }));
+        });
+#endif
+    }
+};
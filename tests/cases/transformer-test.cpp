@@ -7,6 +7,7 @@ public:
      */
     void test() override {
         inheritance();
+        references();
     }
 
     /**
@@ -29,10 +30,10 @@ public:
             assertCount(2, document->nodes);
             assertEquals<std::string>("A", document->nodes[n].name);
             assertEquals<std::string>("a", document->nodes[n].properties[0].name);
-            assertEquals<std::string>("10", document->nodes[n].properties[0].values[0]);
+            assertEquals<int>(10, document->nodes[n].properties[0].values[0].integer);
             assertEquals<DataType>(DataType::Int, document->nodes[n].properties[0].dataType);
             assertEquals<std::string>("b", document->nodes[n].properties[1].name);
-            assertEquals<std::string>("20", document->nodes[n].properties[1].values[0]);
+            assertEquals<int>(20, document->nodes[n].properties[1].values[0].integer);
             assertEquals((int) DataType::Int, (int) document->nodes[n].properties[1].dataType);
 
             ++n;
@@ -40,13 +41,59 @@ public:
 
             // Value explicitly set by "B", which must NOT be overridden
             assertEquals<std::string>("a", document->nodes[n].properties[0].name);
-            assertEquals<std::string>("15", document->nodes[n].properties[0].values[0]);
+            assertEquals<int>(15, document->nodes[n].properties[0].values[0].integer);
             assertEquals<DataType>(DataType::Int, document->nodes[n].properties[0].dataType);
 
             // Value ignored by "B", and which must be inherited from "A"
             assertEquals<std::string>("b", document->nodes[n].properties[1].name);
-            assertEquals<std::string>("20", document->nodes[n].properties[1].values[0]);
+            assertEquals<int>(20, document->nodes[n].properties[1].values[0].integer);
             assertEquals<DataType>(DataType::Int, document->nodes[n].properties[1].dataType);
         });
+
+        it("Inherits only the properties the parent declares itself", [&]() {
+            Result<std::vector<Token>> tokens = Tokenizer::tokenize("<Type> A\n\ta: 10\n\tb: 1\n<Type> B <= A\n\ta: 20\n<Type> C <= B\n");
+            Result<Document> syntaxTree = Parser::parse(std::get<std::vector<Token>>(tokens));
+            std::shared_ptr<Document> document = std::make_shared<Document>(syntaxTree.get());
+
+            Transformer::transform(document);
+
+            // "b" is only inherited by "B", so it's not passed on to "C"
+            const Node &node = document->nodes[2];
+            assertCount(1, node.properties);
+            assertEquals<std::string>("a", node.properties[0].name);
+            assertEquals<int>(20, node.properties[0].values[0].integer);
+        });
+
+        it("Stops at the limit of the depth of inheritance", [&]() {
+            Result<std::vector<Token>> tokens = Tokenizer::tokenize("<Type> A\n\ta: 10\n<Type> B <= A\n<Type> C <= B\n");
+            Result<Document> syntaxTree = Parser::parse(std::get<std::vector<Token>>(tokens));
+            std::shared_ptr<Document> document = std::make_shared<Document>(syntaxTree.get());
+
+            NodeIndex nodeIndex;
+            assertFalse(Transformer::transform(document, nodeIndex, {.maxInheritanceDepth = 2}).has_value());
+            assertEquals<uint32_t>(2, document->nodes[2].inheritanceDepth);
+
+            std::optional<Error> error = Transformer::transform(document, nodeIndex, {.maxInheritanceDepth = 1});
+            assertTrue(error.has_value());
+            assertEquals(ErrorCode::HXL_INHERITANCE_TOO_DEEP, error->errorCode);
+        });
+    }
+
+    /**
+     * Check that references are resolved to the index of the referenced node.
+     */
+    void references() {
+        it("Resolves references to node indices", [&]() {
+            Result<std::vector<Token>> tokens = Tokenizer::tokenize("<Type> A\n\n<Type> B\n\tref&: A\n");
+            Result<Document> syntaxTree = Parser::parse(std::get<std::vector<Token>>(tokens));
+            std::shared_ptr<Document> document = std::make_shared<Document>(syntaxTree.get());
+
+            Transformer::transform(document);
+
+            const NodeProperty &ref = document->nodes[1].properties[0];
+            assertTrue(ref.value.has_value());
+            assertEquals<std::string>("A", std::get<NodeRef>(ref.value.value()).references);
+            assertEquals<size_t>(0, std::get<NodeRef>(ref.value.value()).index.value());
+        });
     }
 };
@@ -0,0 +1,162 @@
+#include <fstream>
+#include <random>
+
+using namespace HXL;
+
+class WatcherTest : public BaseCase {
+public:
+    /**
+     * List of tests.
+     */
+    void test() override {
+        changes();
+        watching();
+    }
+
+    Schema schema{
+            .types = {
+                    SchemaNodeType{.name = "Message",
+                                   .properties = {
+                                           {"id", DataType::Int},
+                                           {"to", DataType::NodeRef},
+                                   }},
+            },
+    };
+
+    /**
+     * The names passed to each handle, since they were last cleared.
+     */
+    struct Changes {
+        std::vector<std::string> added, changed, removed;
+
+        void clear() {
+            added.clear();
+            changed.clear();
+            removed.clear();
+        }
+    };
+
+    /**
+     * A directory of its own, so tests running at the same time don't share
+     * it, removed with its files when the test ends (even if it fails).
+     */
+    struct TemporaryDirectory {
+        std::filesystem::path path = std::filesystem::temp_directory_path() /
+                                     ("hxl-watcher-test-" + std::to_string(std::random_device()()));
+
+        TemporaryDirectory() {
+            std::filesystem::create_directories(path);
+        }
+
+        ~TemporaryDirectory() {
+            std::error_code error;
+            std::filesystem::remove_all(path, error);
+        }
+    };
+
+    /**
+     * A project, and a watcher which records the names passed to each
+     * of its handles.
+     */
+    struct WatchedProject {
+        Project project;
+        Changes changes;
+        Watcher watcher;
+
+        explicit WatchedProject(const Schema &schema)
+            : project(schema, {}),
+              watcher(project,
+                      {
+                              .added = [this](const DeserializedNode &node) { changes.added.push_back(node.name); },
+                              .changed = [this](const DeserializedNode &node) { changes.changed.push_back(node.name); },
+                              .removed = [this](const std::string &name) { changes.removed.push_back(name); },
+                      }) {
+        }
+
+        // The handles refer to the changes of this instance
+        WatchedProject(const WatchedProject &) = delete;
+    };
+
+    static std::string join(const std::vector<std::string> &names) {
+        std::string result;
+        for (const std::string &name: names) {
+            result += (result.empty() ? "" : ",") + name;
+        }
+        return result;
+    }
+
+    /**
+     * Test which nodes are reported, when the files of the project change.
+     */
+    void changes() {
+        it("Reports only the nodes affected by a change", [&]() {
+            WatchedProject watched(schema);
+
+            watched.project.setFile("a.hxl", "<Message> A\n\tid: 1\n<Message> B <= A\n<Message> C\n\tto&: B\n<Message> D\n\tid: 4\n");
+            assertCount(0, watched.watcher.update());
+            assertEquals<std::string>("A,B,C,D", join(watched.changes.added));
+            assertCount(0, watched.changes.changed);
+
+            // Nothing has changed
+            watched.changes.clear();
+            assertCount(0, watched.watcher.update());
+            assertCount(0, watched.changes.added);
+            assertCount(0, watched.changes.changed);
+
+            // B inherits A, and C references B
+            watched.changes.clear();
+            watched.project.setFile("a.hxl", "<Message> A\n\tid: 2\n<Message> B <= A\n<Message> C\n\tto&: B\n<Message> D\n\tid: 4\n");
+            assertCount(0, watched.watcher.update());
+            assertCount(0, watched.changes.added);
+            assertEquals<std::string>("A,B,C", join(watched.changes.changed));
+
+            watched.changes.clear();
+            watched.project.setFile("a.hxl", "<Message> A\n\tid: 2\n<Message> B <= A\n<Message> C\n\tto&: B\n<Message> E\n\tid: 5\n");
+            assertCount(0, watched.watcher.update());
+            assertEquals<std::string>("E", join(watched.changes.added));
+            assertCount(0, watched.changes.changed);
+            assertEquals<std::string>("D", join(watched.changes.removed));
+        });
+
+        it("Keeps the previous document, when a change has errors", [&]() {
+            WatchedProject watched(schema);
+
+            watched.project.setFile("a.hxl", "<Message> A\n\tid: 1\n");
+            assertCount(0, watched.watcher.update());
+
+            watched.changes.clear();
+            watched.project.setFile("a.hxl", "<Message> A\n\tid: \"x\"\n");
+            assertCount(1, watched.watcher.update());
+            assertCount(0, watched.changes.added);
+            assertCount(0, watched.changes.changed);
+            assertCount(0, watched.changes.removed);
+
+            watched.project.setFile("a.hxl", "<Message> A\n\tid: 3\n");
+            assertCount(0, watched.watcher.update());
+            assertEquals<std::string>("A", join(watched.changes.changed));
+        });
+    }
+
+    /**
+     * Test that files are reloaded, when they change on disk.
+     */
+    void watching() {
+#if defined(__linux__)
+        it("Reloads watched files, when they change", [&]() {
+            TemporaryDirectory directory;
+            std::filesystem::path path = directory.path / "a.hxl";
+            std::ofstream(path) << "<Message> A\n\tid: 1\n<Message> B\n\tid: 2\n";
+
+            WatchedProject watched(schema);
+            assertFalse(watched.watcher.watch(path).has_value());
+            assertCount(0, watched.watcher.update());
+            assertCount(2, watched.changes.added);
+
+            watched.changes.clear();
+            std::ofstream(path) << "<Message> A\n\tid: 1\n<Message> B\n\tid: 3\n";
+            assertCount(0, watched.watcher.poll(std::chrono::seconds(5)));
+            assertEquals<std::string>("B", join(watched.changes.changed));
+        });
+#endif
+    }
+};
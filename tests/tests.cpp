@@ -2,14 +2,25 @@
 #include <bbunit/utilities/printer.hpp>
 
 #include <hxl-lang/hxl-lang.h>
+#include <hxl-lang/utilities/binding.h>
+#include <hxl-lang/utilities/prfr-comparator.h>
+#include <hxl-lang/utilities/prfr-exporter.h>
+#include <hxl-lang/utilities/thread-pool.h>
+#include <hxl-lang/utilities/tracer.h>
 
 #include "cases/base-case.cpp"
+#include "cases/binding-test.cpp"
 #include "cases/deserializer-test.cpp"
 #include "cases/parser-test.cpp"
+#include "cases/performance-test.cpp"
+#include "cases/processor-test.cpp"
+#include "cases/project-test.cpp"
 #include "cases/schema-validator-test.cpp"
 #include "cases/semantic-analyzer-test.cpp"
 #include "cases/transformer-test.cpp"
 #include "cases/tokenizer-test.cpp"
+#include "cases/tracer-test.cpp"
+#include "cases/watcher-test.cpp"
 
 int main() {
     BBUnit::TestResults results = BBUnit::TestRunner::run({
@@ -19,6 +30,12 @@ int main() {
             std::make_shared<DeserializerTest>(DeserializerTest()),
             std::make_shared<SchemaValidatorTest>(SchemaValidatorTest()),
             std::make_shared<TransformerTest>(TransformerTest()),
+            std::make_shared<BindingTest>(BindingTest()),
+            std::make_shared<ProcessorTest>(ProcessorTest()),
+            std::make_shared<ProjectTest>(ProjectTest()),
+            std::make_shared<WatcherTest>(WatcherTest()),
+            std::make_shared<PerformanceTest>(PerformanceTest()),
+            std::make_shared<TracerTest>(TracerTest()),
     });
 
     BBUnit::Utilities::Printer::print(results, {});